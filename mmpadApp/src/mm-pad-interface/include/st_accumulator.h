@@ -0,0 +1,307 @@
+//*******************************************************************
+/// @file st_accumulator.h
+/// Sydor X-PAD multi-frame accumulation engine
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// StFrameAccumulator sums N frames into wide accumulators and emits
+/// the finished sum or mean once N frames have been added. This is the
+/// usual way of extending the effective exposure of an MM-PAD beyond
+/// a single frame.
+///
+/// Accumulators are int64 (exact for integer pixels), float or
+/// double. Integer sources may use any accumulator type; floating
+/// point sources require a floating point accumulator. The add loop
+/// is a straight vectorizable pass and may be split across a
+/// STUTIL::WorkPool.
+///
+//*******************************************************************
+#ifndef ST_ACCUMULATOR_H
+#define ST_ACCUMULATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+#include "stutil_workpool.hpp"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_ACCUM_TILE_PIXELS (64*1024)  ///< Pixels per parallel tile
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Accumulator storage type
+enum StAccumType
+{
+    ST_ACCUM_INT64  = 0,    ///< 64-bit integer (integer sources only)
+    ST_ACCUM_FLOAT  = 1,    ///< 32-bit float
+    ST_ACCUM_DOUBLE = 2     ///< 64-bit float
+};
+
+/// Accumulator result
+enum StAccumOutput
+{
+    ST_ACCUM_OUT_SUM  = 0,  ///< Sum of the N frames
+    ST_ACCUM_OUT_MEAN = 1   ///< Mean of the N frames
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// N-frame accumulator
+class StFrameAccumulator
+{
+private:
+    StAccumType   mType;            ///< Accumulator type
+    StAccumOutput mOutput;          ///< Sum or mean
+    uint32_t mPixels;               ///< Pixels per frame
+    uint32_t mFrameCount;           ///< Frames per result (N)
+    uint32_t mAdded;                ///< Frames added to the current result
+    std::vector<int64_t> mSumI;     ///< INT64 accumulators
+    std::vector<float>   mSumF;     ///< FLOAT accumulators
+    std::vector<double>  mSumD;     ///< DOUBLE accumulators
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StFrameAccumulator()
+        : mType(ST_ACCUM_INT64), mOutput(ST_ACCUM_OUT_SUM), mPixels(0), mFrameCount(0), mAdded(0)
+    {
+    }
+
+    //----------------------------------------------
+    /// Configure the accumulator and clear any partial result
+    ///
+    /// @param[in] pixels       pixels per frame
+    /// @param[in] frameCount   frames per result (N)
+    /// @param[in] type         accumulator type
+    /// @param[in] output       sum or mean
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t init(uint32_t pixels, uint32_t frameCount,
+                 StAccumType type = ST_ACCUM_INT64,
+                 StAccumOutput output = ST_ACCUM_OUT_SUM)
+    {
+        if ((0 == pixels) || (0 == frameCount))
+        {
+            return ST_ERR_PARAM;
+        }
+        mType = type;
+        mOutput = output;
+        mPixels = pixels;
+        mFrameCount = frameCount;
+        mSumI.clear();
+        mSumF.clear();
+        mSumD.clear();
+        switch (type)
+        {
+            case ST_ACCUM_INT64:  mSumI.resize(pixels); break;
+            case ST_ACCUM_FLOAT:  mSumF.resize(pixels); break;
+            case ST_ACCUM_DOUBLE: mSumD.resize(pixels); break;
+            default: return ST_ERR_PARAM;
+        }
+        reset();
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Discard the current partial result
+    void reset()
+    {
+        mAdded = 0;
+        std::fill(mSumI.begin(), mSumI.end(), 0);
+        std::fill(mSumF.begin(), mSumF.end(), 0.0f);
+        std::fill(mSumD.begin(), mSumD.end(), 0.0);
+    }
+
+    bool isInitialized() const { return mPixels > 0; }          ///< init() succeeded
+    bool isComplete() const { return (mPixels > 0) && (mAdded >= mFrameCount); } ///< N frames added
+    uint32_t getPixels() const { return mPixels; }              ///< Pixels per frame
+    uint32_t getFrameCount() const { return mFrameCount; }      ///< Frames per result
+    uint32_t getAddedCount() const { return mAdded; }           ///< Frames added so far
+    StAccumType getType() const { return mType; }               ///< Accumulator type
+    StAccumOutput getOutput() const { return mOutput; }         ///< Sum or mean
+
+    //----------------------------------------------
+    /// Add one frame of typed pixels
+    ///
+    /// @param[in] pPixels  getPixels() pixels
+    /// @param[in] pPool    optional worker pool
+    ///
+    /// @return 0 if ok, ST_ERR_BUSY if the result is complete and has
+    ///         not been read, else negative error code
+    ///
+    template<typename T>
+    int32_t addPixels(const T* pPixels, STUTIL::WorkPool* pPool = nullptr)
+    {
+        if (nullptr == pPixels)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if (0 == mPixels)
+        {
+            return ST_ERR_STATE;
+        }
+        if (mAdded >= mFrameCount)
+        {
+            return ST_ERR_BUSY;
+        }
+        int32_t rtn;
+        switch (mType)
+        {
+            case ST_ACCUM_INT64:
+                if (!std::numeric_limits<T>::is_integer)
+                {
+                    return ST_ERR_DATA_TYPE;
+                }
+                rtn = runAdd(pPixels, mSumI.data(), pPool);
+                break;
+            case ST_ACCUM_FLOAT:
+                rtn = runAdd(pPixels, mSumF.data(), pPool);
+                break;
+            default:
+                rtn = runAdd(pPixels, mSumD.data(), pPool);
+                break;
+        }
+        if (0 == rtn)
+        {
+            mAdded++;
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Add one frame
+    ///
+    /// @param[in] frame    frame with getPixels() image pixels
+    /// @param[in] pPool    optional worker pool
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t addFrame(StFrameBuffer& frame, STUTIL::WorkPool* pPool = nullptr)
+    {
+        if (frame.getImagePixelCount() != mPixels)
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        AddOp op = { this, frame.getImagePtr(), pPool };
+        return dispatchPixelType(frame.getPixelType(), op);
+    }
+
+    //----------------------------------------------
+    /// Read the completed sum or mean and start a new result
+    ///
+    /// @param[out] pOut    getPixels() output pixels
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_AVAILABLE if fewer than N frames
+    ///         have been added, else negative error code
+    ///
+    template<typename D>
+    int32_t getResult(D* pOut)
+    {
+        if (nullptr == pOut)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if (!isComplete())
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        const double scale = (ST_ACCUM_OUT_MEAN == mOutput) ? (1.0 / mAdded) : 1.0;
+        switch (mType)
+        {
+            case ST_ACCUM_INT64:  emit(mSumI.data(), pOut, scale); break;
+            case ST_ACCUM_FLOAT:  emit(mSumF.data(), pOut, scale); break;
+            default:              emit(mSumD.data(), pOut, scale); break;
+        }
+        reset();
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Read the completed result into a frame (any numeric pixel type)
+    int32_t getResultFrame(StFrameBuffer& fOut)
+    {
+        if (fOut.getImagePixelCount() != mPixels)
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        ResultOp op = { this, fOut.getImagePtr() };
+        return dispatchPixelType(fOut.getPixelType(), op);
+    }
+
+private:
+    //----------------------------------------------
+    /// Run the add kernel, optionally tiled across a pool
+    template<typename T, typename A>
+    int32_t runAdd(const T* pPixels, A* pSum, STUTIL::WorkPool* pPool)
+    {
+        if (nullptr == pPool)
+        {
+            accumulateKernel(pPixels, pSum, mPixels);
+        }
+        else
+        {
+            pPool->parallelFor(mPixels, ST_ACCUM_TILE_PIXELS, [pPixels, pSum](size_t begin, size_t end)
+                { accumulateKernel(pPixels + begin, pSum + begin, end - begin); });
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Convert accumulators to the output type
+    template<typename A, typename D>
+    void emit(const A* ST_RESTRICT pSum, D* ST_RESTRICT pOut, double scale)
+    {
+        if (1.0 == scale)
+        {
+            convertKernel(pSum, pOut, mPixels);
+            return;
+        }
+        for (size_t i = 0; i < mPixels; i++)
+        {
+            pOut[i] = static_cast<D>(static_cast<double>(pSum[i]) * scale);
+        }
+    }
+
+    //----------------------------------------------
+    // Dispatch functors
+    struct AddOp
+    {
+        StFrameAccumulator* pAcc;
+        const void* pPixels;
+        STUTIL::WorkPool* pPool;
+        template<typename T> int32_t run() { return pAcc->addPixels(static_cast<const T*>(pPixels), pPool); }
+    };
+    struct ResultOp
+    {
+        StFrameAccumulator* pAcc;
+        void* pOut;
+        template<typename D> int32_t run() { return pAcc->getResult(static_cast<D*>(pOut)); }
+    };
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_ACCUMULATOR_H
@@ -0,0 +1,499 @@
+//*******************************************************************
+/// @file st_async_job.h
+/// Sydor Server Interface asynchronous jobs
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// Background, flatfield, batch correction and correction reload can
+/// run for much longer than a message timeout. StAsyncJobManager runs
+/// such work on its own worker pool. Each job gets an ID, and the
+/// owner of the manager can then (see
+/// StSimResponseHandler::startCalcBackground()):
+///
+/// - poll the job status (state, frames done / total, frames per second)
+/// - wait for completion instead of polling. One wait is limited to
+///   ST_ASYNC_JOB_MAX_WAIT_MSEC, so a caller that serves other work
+///   between waits is never blocked for long.
+/// - cancel the job. A queued job is cancelled at once. A running job
+///   is cancelled at its next progress check.
+///
+/// The server message set has no job commands: ServerInterface and its
+/// message dispatch are in the prebuilt library, so jobs are started
+/// and queried through the owner's API.
+///
+/// @note Only the simulated server runs jobs here. On the production
+/// server calcBackground, calcFlatfield, batchCorrectRun and reloadCorr
+/// are still synchronous messages with fixed client timeouts.
+///
+/// Job functions report progress and check for cancellation through
+/// the StAsyncJobProgress they are given. Finished jobs are kept for
+/// status queries until ST_ASYNC_JOB_HISTORY newer jobs have finished.
+///
+//*******************************************************************
+#ifndef ST_ASYNC_JOB_H
+#define ST_ASYNC_JOB_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <atomic>
+#include "st_errors.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_ASYNC_JOB_DEFAULT_WORKERS = 2;        ///< Default worker thread count
+const uint32_t ST_ASYNC_JOB_MAX_WORKERS     = 16;       ///< Max worker thread count
+const uint32_t ST_ASYNC_JOB_HISTORY         = 64;       ///< Finished jobs kept for status queries
+const uint32_t ST_ASYNC_JOB_MAX_WAIT_MSEC   = 1000;     ///< Max wait for one wait request
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Job type
+enum StAsyncJobType
+{
+    ST_JOB_CALC_BACKGROUND  = 0,    ///< calcBackground
+    ST_JOB_CALC_FLATFIELD   = 1,    ///< calcFlatfield
+    ST_JOB_BATCH_CORRECT    = 2,    ///< batchCorrectRun
+    ST_JOB_RELOAD_CORR      = 3     ///< reloadCorr
+};
+
+/// Job state
+enum StAsyncJobState
+{
+    ST_JOB_QUEUED       = 0,        ///< Waiting for a worker
+    ST_JOB_RUNNING      = 1,        ///< Running
+    ST_JOB_DONE         = 2,        ///< Finished successfully
+    ST_JOB_FAILED       = 3,        ///< Finished with an error (see result)
+    ST_JOB_CANCELLED    = 4         ///< Cancelled
+};
+
+//----------------------------------------------
+/// Job status snapshot
+struct StAsyncJobStatus
+{
+    uint32_t jobId;                 ///< Job ID (0 = none)
+    StAsyncJobType type;            ///< Job type
+    StAsyncJobState state;          ///< Job state
+    int32_t result;                 ///< Job return code (when finished)
+    std::string setName;            ///< Set the job works on
+    std::string runName;            ///< Run the job works on
+    uint32_t framesDone;            ///< Frames processed
+    uint32_t framesTotal;           ///< Frames to process (0 if unknown)
+    double framesPerSec;            ///< Throughput since the job started
+    uint32_t elapsedMSec;           ///< Time since the job started (or run time if finished)
+
+    StAsyncJobStatus()
+        : jobId(0), type(ST_JOB_CALC_BACKGROUND), state(ST_JOB_QUEUED), result(ST_ERR_OK),
+          framesDone(0), framesTotal(0), framesPerSec(0.0), elapsedMSec(0)
+    {
+    }
+
+    /// True once the job can no longer change
+    bool isFinished(void) const { return state >= ST_JOB_DONE; }
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Progress and cancellation interface passed to job functions
+class StAsyncJobProgress
+{
+private:
+    std::atomic<uint32_t> mDone;        ///< Frames processed
+    std::atomic<uint32_t> mTotal;       ///< Frames to process
+    std::atomic<bool> mCancel;          ///< Cancellation requested
+
+public:
+    StAsyncJobProgress() : mDone(0), mTotal(0), mCancel(false) {}
+
+    //----------------------------------------------
+    /// Report progress
+    ///
+    /// @return true if the job should keep going, false if it
+    ///         has been cancelled and should return ST_ERR_JOB_CANCELLED
+    ///
+    bool update(uint32_t framesDone, uint32_t framesTotal)
+    {
+        mDone = framesDone;
+        mTotal = framesTotal;
+        return !mCancel;
+    }
+
+    bool isCancelled(void) const { return mCancel; }    ///< Cancellation requested
+    void cancel(void) { mCancel = true; }               ///< Request cancellation
+    uint32_t getDone(void) const { return mDone; }      ///< Frames processed
+    uint32_t getTotal(void) const { return mTotal; }    ///< Frames to process
+};
+
+/// Job function. Returns 0 if ok, else negative error code.
+typedef std::function<int32_t(StAsyncJobProgress& progress)> StAsyncJobFunc;
+
+//----------------------------------------------
+/// Job queue and worker pool
+class StAsyncJobManager
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    //----------------------------------------------
+    /// One job
+    struct Job
+    {
+        StAsyncJobStatus status;        ///< Status (progress fields updated on query)
+        StAsyncJobFunc func;            ///< Work
+        StAsyncJobProgress progress;    ///< Progress shared with the work
+        Clock::time_point started;      ///< Start time
+        Clock::time_point finished;     ///< End time
+    };
+    typedef std::shared_ptr<Job> JobPtr;
+
+    std::mutex mMutex;                          ///< Protects everything below
+    std::condition_variable mQueueCond;         ///< Wakes workers
+    std::condition_variable mDoneCond;          ///< Signals job completion
+    std::vector<std::thread> mWorkers;          ///< Worker threads
+    std::deque<JobPtr> mQueue;                  ///< Queued jobs
+    std::map<uint32_t, JobPtr> mJobs;           ///< Known jobs by ID
+    std::deque<uint32_t> mFinished;             ///< Finished job IDs, oldest first
+    uint32_t mNextId;                           ///< Next job ID
+    bool mStop;                                 ///< Worker stop request
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StAsyncJobManager()
+        : mNextId(1)
+        , mStop(false)
+    {
+    }
+
+    //----------------------------------------------
+    /// Destructor - cancels running jobs and stops the workers
+    ~StAsyncJobManager()
+    {
+        stop();
+    }
+
+    StAsyncJobManager(const StAsyncJobManager&) = delete;
+    StAsyncJobManager& operator=(const StAsyncJobManager&) = delete;
+
+    //----------------------------------------------
+    /// Start the worker pool
+    ///
+    /// @param[in] workers      worker thread count
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t start(uint32_t workers = ST_ASYNC_JOB_DEFAULT_WORKERS)
+    {
+        if ((0 == workers) || (workers > ST_ASYNC_JOB_MAX_WORKERS))
+        {
+            return ST_ERR_PARAM;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mWorkers.empty())
+        {
+            return ST_ERR_STATE;
+        }
+        mStop = false;
+        try
+        {
+            for (uint32_t i = 0; i < workers; i++)
+            {
+                mWorkers.push_back(std::thread(&StAsyncJobManager::workerMain, this));
+            }
+        }
+        catch (...)
+        {
+            mStop = true;
+            mQueueCond.notify_all();
+            for (std::thread& t : mWorkers)
+            {
+                t.join();
+            }
+            mWorkers.clear();
+            return ST_ERR_THREAD_CREATE;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Cancel all jobs and stop the worker pool
+    void stop(void)
+    {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+            while (!mQueue.empty())
+            {
+                finish(mQueue.front(), ST_JOB_CANCELLED, ST_ERR_JOB_CANCELLED);
+                mQueue.pop_front();
+            }
+            for (auto& entry : mJobs)
+            {
+                entry.second->progress.cancel();
+            }
+            workers.swap(mWorkers);
+        }
+        mQueueCond.notify_all();
+        for (std::thread& t : workers)
+        {
+            t.join();
+        }
+        mDoneCond.notify_all();
+    }
+
+    //----------------------------------------------
+    /// True if the worker pool is running
+    bool isRunning(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return !mWorkers.empty();
+    }
+
+    //----------------------------------------------
+    /// Queue a job
+    ///
+    /// @param[in]  type        job type
+    /// @param[in]  setName     set the job works on
+    /// @param[in]  runName     run the job works on
+    /// @param[in]  func        work
+    /// @param[out] jobId       ID of the new job
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t submit(StAsyncJobType type, const std::string& setName, const std::string& runName,
+                   const StAsyncJobFunc& func, uint32_t& jobId)
+    {
+        if (!func)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        JobPtr pJob = std::make_shared<Job>();
+        pJob->status.type = type;
+        pJob->status.setName = setName;
+        pJob->status.runName = runName;
+        pJob->func = func;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mWorkers.empty())
+            {
+                return ST_ERR_STATE;
+            }
+            pJob->status.jobId = mNextId++;
+            if (0 == mNextId)
+            {
+                mNextId = 1;
+            }
+            mJobs[pJob->status.jobId] = pJob;
+            mQueue.push_back(pJob);
+            jobId = pJob->status.jobId;
+        }
+        mQueueCond.notify_one();
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Cancel a job
+    ///
+    /// @return 0 if ok (or already finished), ST_ERR_JOB_ID if unknown
+    ///
+    int32_t cancel(uint32_t jobId)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        std::map<uint32_t, JobPtr>::iterator it = mJobs.find(jobId);
+        if (mJobs.end() == it)
+        {
+            return ST_ERR_JOB_ID;
+        }
+        JobPtr pJob = it->second;
+        if (ST_JOB_QUEUED == pJob->status.state)
+        {
+            for (std::deque<JobPtr>::iterator q = mQueue.begin(); q != mQueue.end(); ++q)
+            {
+                if (*q == pJob)
+                {
+                    mQueue.erase(q);
+                    break;
+                }
+            }
+            finish(pJob, ST_JOB_CANCELLED, ST_ERR_JOB_CANCELLED);
+            mDoneCond.notify_all();
+        }
+        else if (ST_JOB_RUNNING == pJob->status.state)
+        {
+            pJob->progress.cancel();
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Get the status of a job
+    ///
+    /// @return 0 if ok, ST_ERR_JOB_ID if unknown (or forgotten)
+    ///
+    int32_t getStatus(uint32_t jobId, StAsyncJobStatus& status)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return snapshot(jobId, status);
+    }
+
+    //----------------------------------------------
+    /// Wait for a job to finish
+    ///
+    /// @param[in]  jobId       job ID
+    /// @param[out] status      job status when the wait ended
+    /// @param[in]  timeoutMSec max wait (limited to ST_ASYNC_JOB_MAX_WAIT_MSEC)
+    ///
+    /// @return 0 if the job finished, ST_ERR_TIMEOUT if it is still
+    ///         queued or running, ST_ERR_JOB_ID if unknown
+    ///
+    int32_t wait(uint32_t jobId, StAsyncJobStatus& status, uint32_t timeoutMSec)
+    {
+        if (timeoutMSec > ST_ASYNC_JOB_MAX_WAIT_MSEC)
+        {
+            timeoutMSec = ST_ASYNC_JOB_MAX_WAIT_MSEC;
+        }
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMSec);
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;)
+        {
+            int32_t rtn = snapshot(jobId, status);
+            if ((0 != rtn) || status.isFinished())
+            {
+                return rtn;
+            }
+            if (std::cv_status::timeout == mDoneCond.wait_until(lock, deadline))
+            {
+                rtn = snapshot(jobId, status);
+                return ((0 == rtn) && !status.isFinished()) ? ST_ERR_TIMEOUT : rtn;
+            }
+        }
+    }
+
+    //----------------------------------------------
+    /// Get the status of all known jobs, oldest first
+    void getAll(std::vector<StAsyncJobStatus>& jobs)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        jobs.clear();
+        for (auto& entry : mJobs)
+        {
+            StAsyncJobStatus status;
+            snapshot(entry.first, status);
+            jobs.push_back(status);
+        }
+    }
+
+private:
+    //----------------------------------------------
+    // Worker thread
+    void workerMain(void)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;)
+        {
+            mQueueCond.wait(lock, [this] { return mStop || !mQueue.empty(); });
+            if (mStop)
+            {
+                return;
+            }
+            JobPtr pJob = mQueue.front();
+            mQueue.pop_front();
+            pJob->status.state = ST_JOB_RUNNING;
+            pJob->started = Clock::now();
+            lock.unlock();
+
+            int32_t rtn;
+            try
+            {
+                rtn = pJob->func(pJob->progress);
+            }
+            catch (...)
+            {
+                rtn = ST_ERR_JOB_EXCEPTION;
+            }
+
+            lock.lock();
+            if (pJob->progress.isCancelled())
+            {
+                finish(pJob, ST_JOB_CANCELLED, ST_ERR_JOB_CANCELLED);
+            }
+            else
+            {
+                finish(pJob, (0 == rtn) ? ST_JOB_DONE : ST_JOB_FAILED, rtn);
+            }
+            pJob->func = StAsyncJobFunc();      // release captured state
+            mDoneCond.notify_all();
+        }
+    }
+
+    //----------------------------------------------
+    // Mark a job finished and forget the oldest finished jobs
+    // (caller holds mMutex)
+    void finish(const JobPtr& pJob, StAsyncJobState state, int32_t result)
+    {
+        pJob->status.state = state;
+        pJob->status.result = result;
+        pJob->finished = Clock::now();
+        if (pJob->started == Clock::time_point())
+        {
+            pJob->started = pJob->finished;
+        }
+        mFinished.push_back(pJob->status.jobId);
+        while (mFinished.size() > ST_ASYNC_JOB_HISTORY)
+        {
+            mJobs.erase(mFinished.front());
+            mFinished.pop_front();
+        }
+    }
+
+    //----------------------------------------------
+    // Fill in a status snapshot (caller holds mMutex)
+    int32_t snapshot(uint32_t jobId, StAsyncJobStatus& status)
+    {
+        std::map<uint32_t, JobPtr>::const_iterator it = mJobs.find(jobId);
+        if (mJobs.end() == it)
+        {
+            return ST_ERR_JOB_ID;
+        }
+        const Job& job = *it->second;
+        status = job.status;
+        status.framesDone = job.progress.getDone();
+        status.framesTotal = job.progress.getTotal();
+        if (ST_JOB_QUEUED != status.state)
+        {
+            Clock::time_point end = status.isFinished() ? job.finished : Clock::now();
+            double seconds = std::chrono::duration<double>(end - job.started).count();
+            status.elapsedMSec = static_cast<uint32_t>(seconds * 1000.0);
+            status.framesPerSec = (seconds > 0.0) ? (status.framesDone / seconds) : 0.0;
+        }
+        return ST_ERR_OK;
+    }
+};  // class StAsyncJobManager
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_ASYNC_JOB_H
@@ -0,0 +1,418 @@
+//*******************************************************************
+/// @file st_background_model.h
+/// Sydor X-PAD streaming background estimator
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// StBackgroundModel maintains a running background (dark) image that
+/// is updated from frames as they arrive, instead of only from a
+/// separate background run.
+///
+/// Two estimators are available:
+///     ST_BG_MODEL_EMA     exponential moving average,
+///                         bg += alpha * (frame - bg)
+///     ST_BG_MODEL_WINDOW  mean of the last N frames
+///
+/// Updates are straight-line per-pixel loops the compiler can
+/// vectorize. After every 'publishInterval' updates the current
+/// estimate is copied to an immutable snapshot, which is published by
+/// an atomic shared_ptr swap. Readers (the subtraction path) take a
+/// snapshot with getSnapshot() and are never blocked by, or see a
+/// partial result from, an update in progress.
+///
+/// Snapshot buffers come from a small pool: a buffer is rewritten once
+/// no reader holds it any more, so publishing does not allocate a new
+/// image in steady state.
+///
+/// The window method keeps its frames as float and updates the window
+/// sum incrementally. The sum is recomputed from the window frames
+/// every time the window wraps, so rounding in the incremental update
+/// does not accumulate.
+///
+//*******************************************************************
+#ifndef ST_BACKGROUND_MODEL_H
+#define ST_BACKGROUND_MODEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_BG_MODEL_DEFAULT_ALPHA   0.01    ///< Default EMA weight of a new frame
+#define ST_BG_MODEL_MAX_WINDOW      1024    ///< Maximum windowed mean length
+#define ST_BG_MODEL_SNAPSHOT_POOL   4       ///< Snapshot buffers kept for reuse
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Background estimator method
+enum StBgModelMethod
+{
+    ST_BG_MODEL_EMA = 0,        ///< Exponential moving average
+    ST_BG_MODEL_WINDOW          ///< Windowed mean of the last N frames
+};
+
+/// Immutable published background image
+typedef std::shared_ptr<const std::vector<double>> StBgSnapshot;
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Streaming background estimator
+class StBackgroundModel
+{
+private:
+    std::mutex mLock;                   ///< Serializes init/update
+    StBgModelMethod mMethod;            ///< Estimator method
+    double   mAlpha;                    ///< EMA weight of a new frame
+    uint32_t mWindow;                   ///< Window length (frames)
+    uint32_t mPublishInterval;          ///< Updates between snapshots
+    uint32_t mWidth;                    ///< Image width
+    uint32_t mHeight;                   ///< Image height
+    uint64_t mUpdateCount;              ///< Frames added since init
+    uint32_t mSincePublish;             ///< Updates since last snapshot
+    std::vector<double> mEstimate;      ///< EMA estimate / window sum
+    std::vector<std::vector<float>> mRing; ///< Window frames (window method)
+    uint32_t mRingHead;                 ///< Next ring slot to overwrite
+    StBgSnapshot mSnapshot;             ///< Published background (atomic access only)
+    std::vector<std::shared_ptr<std::vector<double>>> mSnapPool; ///< Snapshot buffers for reuse
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StBackgroundModel()
+        : mMethod(ST_BG_MODEL_EMA), mAlpha(ST_BG_MODEL_DEFAULT_ALPHA), mWindow(1),
+          mPublishInterval(1), mWidth(0), mHeight(0), mUpdateCount(0),
+          mSincePublish(0), mRingHead(0)
+    {
+    }
+
+    //----------------------------------------------
+    /// (Re)initialize the estimator and discard any published background
+    ///
+    /// @param[in] width            image width in pixels
+    /// @param[in] height           image height in pixels
+    /// @param[in] method           estimator method
+    /// @param[in] alpha            EMA weight of a new frame (0 < alpha <= 1)
+    /// @param[in] window           window length in frames (window method)
+    /// @param[in] publishInterval  frames between published snapshots
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t init(uint32_t width, uint32_t height,
+                 StBgModelMethod method = ST_BG_MODEL_EMA,
+                 double alpha = ST_BG_MODEL_DEFAULT_ALPHA,
+                 uint32_t window = 16,
+                 uint32_t publishInterval = 1)
+    {
+        if ((0 == width) || (0 == height))
+        {
+            return ST_ERR_DIMENSION;
+        }
+        if ((ST_BG_MODEL_EMA == method) && !((alpha > 0.0) && (alpha <= 1.0)))
+        {
+            return ST_ERR_PARAM;
+        }
+        if ((ST_BG_MODEL_WINDOW == method) && ((0 == window) || (window > ST_BG_MODEL_MAX_WINDOW)))
+        {
+            return ST_ERR_PARAM;
+        }
+
+        std::lock_guard<std::mutex> lock(mLock);
+        mMethod = method;
+        mAlpha = alpha;
+        mWindow = window;
+        mPublishInterval = (publishInterval > 0) ? publishInterval : 1;
+        mWidth = width;
+        mHeight = height;
+        mUpdateCount = 0;
+        mSincePublish = 0;
+        mRingHead = 0;
+        mEstimate.assign(static_cast<size_t>(width) * height, 0.0);
+        mRing.clear();
+        mSnapPool.clear();
+        std::atomic_store(&mSnapshot, StBgSnapshot());
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Feed one frame into the estimator
+    ///
+    /// @param[in] frame    frame with image matching the init() size
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t addFrame(StFrameBuffer& frame)
+    {
+        AddOp op = { this, frame.getImagePtr() };
+        if (nullptr == op.pPixels)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        // Check the size under the lock so a concurrent init() cannot change it
+        std::lock_guard<std::mutex> lock(mLock);
+        if ((frame.getImageWidth() != mWidth) || (frame.getImageHeight() != mHeight))
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        return dispatchPixelType(frame.getPixelType(), op);
+    }
+
+    //----------------------------------------------
+    /// Feed one image (typed pixels) into the estimator
+    ///
+    /// @param[in] pPixels  width * height pixels, for the size given to init()
+    ///
+    template<typename T>
+    void addPixels(const T* pPixels)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        addPixelsLocked(pPixels);
+    }
+
+    //----------------------------------------------
+    /// Return the current published background, or nullptr if none
+    ///
+    /// The snapshot is immutable and remains valid for as long as the
+    /// caller holds it, regardless of later updates.
+    ///
+    StBgSnapshot getSnapshot() const
+    {
+        return std::atomic_load(&mSnapshot);
+    }
+
+    //----------------------------------------------
+    /// Subtract the published background from a frame
+    ///
+    /// @param[in]  fFg     foreground frame
+    /// @param[out] fDest   result frame (same pixel type as fFg, may be fFg)
+    ///
+    /// @return 0 if ok, ST_ERR_NO_BACKGROUND if nothing published yet,
+    ///         else negative error code
+    ///
+    int32_t subtract(StFrameBuffer& fFg, StFrameBuffer& fDest)
+    {
+        StBgSnapshot bg = getSnapshot();
+        if (!bg)
+        {
+            return ST_ERR_NO_BACKGROUND;
+        }
+        uint32_t count = fFg.getImagePixelCount();
+        if ((count != bg->size()) || (count != fDest.getImagePixelCount()))
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        if (fFg.getPixelType() != fDest.getPixelType())
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+        StSubtractOp op = { fFg.getImagePtr(), bg->data(), fDest.getImagePtr(), count };
+        if ((nullptr == op.pFg) || (nullptr == op.pDest))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return dispatchPixelTypes(fFg.getPixelType(), DT_DOUBLE, op);
+    }
+
+    //----------------------------------------------
+    /// Return the number of frames added since init()
+    uint64_t getUpdateCount()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mUpdateCount;
+    }
+
+    //----------------------------------------------
+    /// Return the estimator method
+    StBgModelMethod getMethod()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mMethod;
+    }
+
+    //----------------------------------------------
+    /// Return the EMA weight of a new frame
+    double getAlpha()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mAlpha;
+    }
+
+    //----------------------------------------------
+    /// Return the window length
+    uint32_t getWindow()
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        return mWindow;
+    }
+
+private:
+    //----------------------------------------------
+    /// Feed one image into the estimator (mLock held)
+    template<typename T>
+    void addPixelsLocked(const T* pPixels)
+    {
+        if (mEstimate.empty())
+        {
+            return;     // Not initialized
+        }
+        const size_t count = mEstimate.size();
+        double* ST_RESTRICT pEst = mEstimate.data();
+
+        if (ST_BG_MODEL_EMA == mMethod)
+        {
+            if (0 == mUpdateCount)
+            {
+                for (size_t i = 0; i < count; i++)
+                {
+                    pEst[i] = static_cast<double>(pPixels[i]);
+                }
+            }
+            else
+            {
+                const double alpha = mAlpha;
+                for (size_t i = 0; i < count; i++)
+                {
+                    pEst[i] += alpha * (static_cast<double>(pPixels[i]) - pEst[i]);
+                }
+            }
+        }
+        else
+        {
+            // Window: pEst holds the running sum of the frames in mRing
+            if (mRing.size() < mWindow)
+            {
+                mRing.push_back(std::vector<float>(count));
+                mRingHead = static_cast<uint32_t>(mRing.size() - 1);
+                float* ST_RESTRICT pNew = mRing[mRingHead].data();
+                for (size_t i = 0; i < count; i++)
+                {
+                    pNew[i] = static_cast<float>(pPixels[i]);
+                    pEst[i] += pNew[i];
+                }
+            }
+            else
+            {
+                float* ST_RESTRICT pOld = mRing[mRingHead].data();
+                for (size_t i = 0; i < count; i++)
+                {
+                    float v = static_cast<float>(pPixels[i]);
+                    pEst[i] += static_cast<double>(v) - pOld[i];
+                    pOld[i] = v;
+                }
+            }
+            mRingHead = (mRingHead + 1) % mWindow;
+            if ((0 == mRingHead) && (mRing.size() == mWindow))
+            {
+                resumWindow();
+            }
+        }
+
+        mUpdateCount++;
+        if (++mSincePublish >= mPublishInterval)
+        {
+            publish();
+        }
+    }
+
+    //----------------------------------------------
+    /// Recompute the window sum from the window frames (mLock held)
+    void resumWindow()
+    {
+        const size_t count = mEstimate.size();
+        double* ST_RESTRICT pEst = mEstimate.data();
+        const float* ST_RESTRICT pFirst = mRing[0].data();
+        for (size_t i = 0; i < count; i++)
+        {
+            pEst[i] = pFirst[i];
+        }
+        for (size_t f = 1; f < mRing.size(); f++)
+        {
+            const float* ST_RESTRICT pFrame = mRing[f].data();
+            for (size_t i = 0; i < count; i++)
+            {
+                pEst[i] += pFrame[i];
+            }
+        }
+    }
+
+    //----------------------------------------------
+    /// Return a snapshot buffer no reader holds (mLock held)
+    std::shared_ptr<std::vector<double>> getSnapshotBuffer()
+    {
+        for (auto& buf : mSnapPool)
+        {
+            // Only the pool holds it: the published snapshot is held by
+            // mSnapshot as well, and a retired one cannot be acquired again
+            if (1 == buf.use_count())
+            {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return buf;
+            }
+        }
+        std::shared_ptr<std::vector<double>> buf = std::make_shared<std::vector<double>>(mEstimate.size());
+        if (mSnapPool.size() < ST_BG_MODEL_SNAPSHOT_POOL)
+        {
+            mSnapPool.push_back(buf);
+        }
+        return buf;
+    }
+
+    //----------------------------------------------
+    /// Copy the estimate to a snapshot buffer and publish it (mLock held)
+    void publish()
+    {
+        mSincePublish = 0;
+        std::shared_ptr<std::vector<double>> snap = getSnapshotBuffer();
+        snap->assign(mEstimate.begin(), mEstimate.end());
+        if (ST_BG_MODEL_WINDOW == mMethod)
+        {
+            const double scale = 1.0 / static_cast<double>(mRing.size());
+            double* ST_RESTRICT pSnap = snap->data();
+            const size_t count = snap->size();
+            for (size_t i = 0; i < count; i++)
+            {
+                pSnap[i] *= scale;
+            }
+        }
+        std::atomic_store(&mSnapshot, StBgSnapshot(snap));
+    }
+
+    //----------------------------------------------
+    // Dispatch functor for addFrame() (mLock held)
+    struct AddOp
+    {
+        StBackgroundModel* pModel;
+        const void* pPixels;
+        template<typename T> int32_t run()
+        {
+            pModel->addPixelsLocked(static_cast<const T*>(pPixels));
+            return ST_ERR_OK;
+        }
+    };
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_BACKGROUND_MODEL_H
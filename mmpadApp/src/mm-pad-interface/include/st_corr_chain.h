@@ -0,0 +1,262 @@
+//*******************************************************************
+/// @file st_corr_chain.h
+/// Sydor X-PAD fused correction chains
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// Running geocorrection, background subtraction and debounce as
+/// separate passes reads and writes the whole corrected image once per
+/// step. A correction chain does all enabled steps in a single pass:
+///
+///     out[o] = debounce( geocorr(src)[o] ) - bg[o]
+///
+/// This is the order the prebuilt StCorrections::applyCorrections()
+/// runs the separate passes in.
+///
+/// Every combination of enabled steps is a separate instantiation of
+/// corrChainRows<GEO, DEB, BG, S, D>(). Disabled steps compile away and
+/// enabled ones are inlined into the geocorrection gather (or into a
+/// plain copy loop when geocorrection is off). selectCorrChain() turns
+/// the runtime flags and pixel types into a function pointer once per
+/// frame, so the inner loop contains no flag tests.
+///
+/// Only per-pixel debounce methods (STEP, CLAMP) can be fused. The
+/// NEIGHBOR method reads neighboring output pixels and still needs its
+/// own pass.
+///
+/// Source pixel types are limited to the raw and corrected types the
+/// detectors produce (INT32, UINT32, INT16, UINT16, FLOAT, DOUBLE), and
+/// output is DOUBLE or FLOAT, to bound the number of instantiations.
+///
+/// The source and output images must not overlap: the row functions
+/// access them through restrict qualified pointers.
+///
+//*******************************************************************
+#ifndef ST_CORR_CHAIN_H
+#define ST_CORR_CHAIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_pixel_kernels.h"
+#include "st_remap_table.h"
+#include "st_debounce.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Fused debounce step
+enum StChainDebounce
+{
+    ST_CHAIN_DEBOUNCE_NONE  = 0,    ///< No debounce
+    ST_CHAIN_DEBOUNCE_STEP  = 1,    ///< ST_DEBOUNCE_STEP
+    ST_CHAIN_DEBOUNCE_CLAMP = 2,    ///< ST_DEBOUNCE_CLAMP
+    ST_CHAIN_DEBOUNCE_COUNT         ///< Number of modes (not a mode)
+};
+
+/// Fused background subtraction step
+enum StChainBg
+{
+    ST_CHAIN_BG_NONE   = 0,         ///< No background subtraction
+    ST_CHAIN_BG_FLOAT  = 1,         ///< Subtract a float background
+    ST_CHAIN_BG_DOUBLE = 2,         ///< Subtract a double background
+    ST_CHAIN_BG_COUNT               ///< Number of modes (not a mode)
+};
+
+//----------------------------------------------
+/// Per-frame chain arguments
+struct StCorrChainArgs
+{
+    const void* pSrc;               ///< Source image
+    void* pDest;                    ///< Output image
+    uint32_t width;                 ///< Output image width
+    const StRemapTable* pRemap;     ///< Geocorrection table (GEO chains)
+    const float* pBgF;              ///< Background, output geometry (ST_CHAIN_BG_FLOAT)
+    const double* pBgD;             ///< Background, output geometry (ST_CHAIN_BG_DOUBLE)
+    StDebounceParams debounce;      ///< Debounce parameters
+};
+
+/// Chain row function: process output rows [rowBegin, rowEnd)
+typedef void (*StCorrChainFunc)(const StCorrChainArgs& args, size_t rowBegin, size_t rowEnd);
+
+//******************************************************************
+// Kernels
+//******************************************************************
+
+//----------------------------------------------
+/// Per-pixel steps applied after the (optional) geocorrection:
+/// debounce, then background subtraction
+template<int DEB, int BG, typename D>
+struct StCorrChainPost
+{
+    typedef typename StPixelCalcType<float, D>::type CalcT;
+
+    CalcT step;             ///< Debounce step
+    CalcT limit;            ///< Debounce STEP fold limit
+    CalcT floorValue;       ///< Debounce CLAMP floor
+    const float* pBgF;      ///< Float background
+    const double* pBgD;     ///< Double background
+
+    explicit StCorrChainPost(const StCorrChainArgs& args)
+        : step(static_cast<CalcT>(args.debounce.stepAdu)),
+          limit(-static_cast<CalcT>(args.debounce.stepAdu) / 2),
+          floorValue(static_cast<CalcT>(args.debounce.floor)),
+          pBgF(args.pBgF), pBgD(args.pBgD)
+    {
+    }
+
+    template<typename T>
+    CalcT operator()(size_t o, T value) const
+    {
+        CalcT v = static_cast<CalcT>(value);
+        if (ST_CHAIN_DEBOUNCE_STEP == DEB)
+        {
+            v = (v < limit) ? (v + step) : v;
+        }
+        else if (ST_CHAIN_DEBOUNCE_CLAMP == DEB)
+        {
+            v = (v < floorValue) ? floorValue : v;
+        }
+        if (ST_CHAIN_BG_FLOAT == BG)
+        {
+            v -= static_cast<CalcT>(pBgF[o]);
+        }
+        else if (ST_CHAIN_BG_DOUBLE == BG)
+        {
+            v -= static_cast<CalcT>(pBgD[o]);
+        }
+        return v;
+    }
+};
+
+//------------------------------------------------------------------
+/// Run one fused chain over a range of output rows
+///
+/// args.pSrc and args.pDest must not overlap.
+///
+template<bool GEO, int DEB, int BG, typename S, typename D>
+void corrChainRows(const StCorrChainArgs& args, size_t rowBegin, size_t rowEnd)
+{
+    const StCorrChainPost<DEB, BG, D> post(args);
+    const S* ST_RESTRICT pSrc = static_cast<const S*>(args.pSrc);
+    D* ST_RESTRICT pDest = static_cast<D*>(args.pDest);
+
+    if (GEO)
+    {
+        args.pRemap->gatherRows(pSrc, pDest, rowBegin, rowEnd, post);
+    }
+    else
+    {
+        size_t oEnd = rowEnd * args.width;
+        for (size_t o = rowBegin * args.width; o < oEnd; o++)
+        {
+            pDest[o] = static_cast<D>(post(o, pSrc[o]));
+        }
+    }
+}
+
+//******************************************************************
+// Chain selection
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Select the chain for fixed pixel types
+template<typename S, typename D>
+inline StCorrChainFunc selectCorrChain(bool geo, StChainDebounce deb, StChainBg bg)
+{
+    static const StCorrChainFunc table[2][ST_CHAIN_DEBOUNCE_COUNT][ST_CHAIN_BG_COUNT] =
+    {
+        {
+            { &corrChainRows<false, 0, 0, S, D>, &corrChainRows<false, 0, 1, S, D>, &corrChainRows<false, 0, 2, S, D> },
+            { &corrChainRows<false, 1, 0, S, D>, &corrChainRows<false, 1, 1, S, D>, &corrChainRows<false, 1, 2, S, D> },
+            { &corrChainRows<false, 2, 0, S, D>, &corrChainRows<false, 2, 1, S, D>, &corrChainRows<false, 2, 2, S, D> },
+        },
+        {
+            { &corrChainRows<true, 0, 0, S, D>, &corrChainRows<true, 0, 1, S, D>, &corrChainRows<true, 0, 2, S, D> },
+            { &corrChainRows<true, 1, 0, S, D>, &corrChainRows<true, 1, 1, S, D>, &corrChainRows<true, 1, 2, S, D> },
+            { &corrChainRows<true, 2, 0, S, D>, &corrChainRows<true, 2, 1, S, D>, &corrChainRows<true, 2, 2, S, D> },
+        },
+    };
+    if ((deb >= ST_CHAIN_DEBOUNCE_COUNT) || (bg >= ST_CHAIN_BG_COUNT))
+    {
+        return nullptr;
+    }
+    return table[geo ? 1 : 0][deb][bg];
+}
+
+//------------------------------------------------------------------
+/// Select the chain for an output pixel type
+template<typename D>
+inline StCorrChainFunc selectCorrChainSrc(STDataType srcType, bool geo, StChainDebounce deb, StChainBg bg)
+{
+    switch (srcType)
+    {
+        case DT_INT32:  return selectCorrChain<int32_t,  D>(geo, deb, bg);
+        case DT_UINT32: return selectCorrChain<uint32_t, D>(geo, deb, bg);
+        case DT_INT16:  return selectCorrChain<int16_t,  D>(geo, deb, bg);
+        case DT_UINT16: return selectCorrChain<uint16_t, D>(geo, deb, bg);
+        case DT_FLOAT:  return selectCorrChain<float,    D>(geo, deb, bg);
+        case DT_DOUBLE: return selectCorrChain<double,   D>(geo, deb, bg);
+        default:        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------
+/// Select the fused chain for the enabled steps and pixel types
+///
+/// @param[in] srcType  source pixel type
+/// @param[in] destType output pixel type (DT_DOUBLE or DT_FLOAT)
+/// @param[in] geo      geocorrection enabled
+/// @param[in] deb      fused debounce step
+/// @param[in] bg       fused background step
+///
+/// @return chain row function, or nullptr if the types are not supported
+///
+inline StCorrChainFunc selectCorrChain(STDataType srcType, STDataType destType,
+                                       bool geo, StChainDebounce deb, StChainBg bg)
+{
+    switch (destType)
+    {
+        case DT_DOUBLE: return selectCorrChainSrc<double>(srcType, geo, deb, bg);
+        case DT_FLOAT:  return selectCorrChainSrc<float>(srcType, geo, deb, bg);
+        default:        return nullptr;
+    }
+}
+
+//------------------------------------------------------------------
+/// Map the debounce settings to a fused debounce step
+///
+/// @param[in]  enabled     debounce enabled
+/// @param[in]  method      debounce method
+/// @param[out] deb         fused step
+///
+/// @return true if the method can be fused
+///
+inline bool getChainDebounce(bool enabled, StDebounceMethod method, StChainDebounce& deb)
+{
+    if (!enabled)
+    {
+        deb = ST_CHAIN_DEBOUNCE_NONE;
+        return true;
+    }
+    switch (method)
+    {
+        case ST_DEBOUNCE_STEP:  deb = ST_CHAIN_DEBOUNCE_STEP;  return true;
+        case ST_DEBOUNCE_CLAMP: deb = ST_CHAIN_DEBOUNCE_CLAMP; return true;
+        default:                return false;
+    }
+}
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_CORR_CHAIN_H
@@ -0,0 +1,587 @@
+//*******************************************************************
+/// @file st_corr_engine.h
+/// Sydor X-PAD per-instance correction engine
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// StCorrections lives in the prebuilt library and is reached through
+/// its process-wide GetInstance() singleton, so its layout and
+/// constructor cannot change. StCorrEngine holds everything the
+/// header-only correction kernels need instead: flags, debounce
+/// method and parameters, streaming background model, accumulator,
+/// cap selection and a worker pool.
+///
+/// Engines are ordinary objects. Create one per detector, or one per
+/// correction thread; the owner (normally the driver) decides their
+/// lifetime. Engines share read-only calibration data through
+/// StCorrCalibrationPtr, which may be replaced while frames are
+/// processed on other threads.
+///
+/// A new engine runs everything on the calling thread. Worker threads
+/// are only started by setWorkerThreads().
+///
+//*******************************************************************
+#ifndef ST_CORR_ENGINE_H
+#define ST_CORR_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+#include "st_remap_table.h"
+#include "st_background_model.h"
+#include "st_debounce.h"
+#include "st_keck_capstack.h"
+#include "st_corr_precision.h"
+#include "st_accumulator.h"
+#include "st_mm_decode.h"
+#include "st_corr_chain.h"
+#include "stutil_workpool.hpp"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_CORR_TILE_BYTES (256*1024)   ///< Default tile working set, sized to fit in L2
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Read-only calibration shared by the correction engines of one
+/// detector. On calibration reload build a new instance and install it
+/// in each engine with setCalibration(); engines keep the old one until
+/// then, so the frame path needs no locks.
+struct StCorrCalibration
+{
+    StRemapTable geo_remap;         ///< Compiled geocorrection (CSR gather table), built by the caller
+    std::vector<float> bg_img_f;    ///< Background for float precision mode
+    std::vector<double> bg_img_d;   ///< Background for double precision mode
+    StKeckCapStack kk_stack;        ///< Interleaved per-cap calibration for KeckPAD stacks
+    StMmDecode mm_decode;           ///< MM-PAD digital/analog decode tables (file mapped)
+
+    //----------------------------------------------
+    /// Fill bg_img_f from a background frame of any pixel type
+    /// (double backgrounds are clamped with corrToFloat())
+    int32_t setBgFloat(StFrameBuffer& bg)
+    {
+        bg_img_f.resize(bg.getImagePixelCount());
+        if (DT_DOUBLE == bg.getPixelType())
+        {
+            const double* pSrc = reinterpret_cast<const double*>(bg.getImagePtr());
+            if (nullptr == pSrc)
+            {
+                return ST_ERR_NULL_PTR;
+            }
+            corrToFloatPixels(pSrc, bg_img_f.data(), bg_img_f.size());
+            return ST_ERR_OK;
+        }
+        return convertPixels(bg.getImagePtr(), bg.getPixelType(), bg_img_f.data(), DT_FLOAT, bg_img_f.size());
+    }
+
+    //----------------------------------------------
+    /// Fill bg_img_d from a background frame of any pixel type
+    int32_t setBgDouble(StFrameBuffer& bg)
+    {
+        bg_img_d.resize(bg.getImagePixelCount());
+        return convertPixels(bg.getImagePtr(), bg.getPixelType(), bg_img_d.data(), DT_DOUBLE, bg_img_d.size());
+    }
+};
+typedef std::shared_ptr<const StCorrCalibration> StCorrCalibrationPtr;
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Correction engine
+class StCorrEngine
+{
+private:
+    bool mGeocorr;                      ///< Geocorrection enabled
+    bool mDebounce;                     ///< Debounce enabled
+    bool mBgSub;                        ///< Background subtraction enabled
+    bool mBgStream;                     ///< Use the streaming background model
+    StDebounceMethod mDebounceMethod;   ///< Selected debounce method
+    StCorrPrecision mPrecision;         ///< Pipeline precision
+    uint32_t mTileRows;                 ///< Rows per correction tile, 0 = automatic
+    std::vector<int> mCapSelect;        ///< Stack index of each selected KeckPAD cap
+    StDebounce mDebouncer;              ///< Debounce kernels and per-method cost counters
+    StBackgroundModel mBgModel;         ///< Streaming background estimator
+    StFrameAccumulator mAccumulator;    ///< Multi-frame summing engine
+    StCorrCalibrationPtr mCalib;        ///< Shared read-only calibration (atomic access only)
+    STUTIL::WorkPool mPool;             ///< Correction worker threads
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    ///
+    /// @param[in] calibration  shared calibration, may be set later
+    ///
+    explicit StCorrEngine(StCorrCalibrationPtr calibration = StCorrCalibrationPtr())
+        : mGeocorr(false), mDebounce(false), mBgSub(false), mBgStream(false),
+          mDebounceMethod(ST_DEBOUNCE_STEP), mPrecision(ST_CORR_PRECISION_DOUBLE),
+          mTileRows(0), mCalib(calibration)
+    {
+    }
+
+    StCorrEngine(const StCorrEngine&) = delete;
+    StCorrEngine& operator=(const StCorrEngine&) = delete;
+
+    //----------------------------------------------
+    /// Set/get the shared calibration. May be replaced while frames are
+    /// processed on other threads.
+    void setCalibration(StCorrCalibrationPtr calibration) { std::atomic_store(&mCalib, calibration); }
+    StCorrCalibrationPtr getCalibration() const { return std::atomic_load(&mCalib); }
+
+    //----------------------------------------------
+    /// Correction step flags
+    bool isGeocorr() const { return mGeocorr; }
+    bool isDebounce() const { return mDebounce; }
+    bool isBgSub() const { return mBgSub; }
+    void setGeocorr(bool enable) { mGeocorr = enable; }
+    void setDebounce(bool enable) { mDebounce = enable; }
+    void setBgSub(bool enable) { mBgSub = enable; }
+
+    //----------------------------------------------
+    /// Select the debounce method (see st_debounce.h for the registry)
+    ///
+    /// @return 0 if ok, ST_ERR_PARAM if method is not a registered method
+    ///
+    int32_t setDebounceMethod(uint32_t method)
+    {
+        if (method >= ST_DEBOUNCE_METHOD_COUNT)
+        {
+            return ST_ERR_PARAM;
+        }
+        mDebounceMethod = static_cast<StDebounceMethod>(method);
+        return ST_ERR_OK;
+    }
+    StDebounceMethod getDebounceMethod() const { return mDebounceMethod; }
+    StDebounce& getDebouncer() { return mDebouncer; }
+
+    //----------------------------------------------
+    /// Pipeline precision: selects the background and output pixel
+    /// type. See st_corr_precision.h for the float error bound against
+    /// the double path.
+    void setPrecision(StCorrPrecision precision) { mPrecision = precision; }
+    StCorrPrecision getPrecision() const { return mPrecision; }
+    STDataType getOutputPixelType() const { return getCorrPixelType(mPrecision); }
+
+    //----------------------------------------------
+    /// Streaming background: dark frames are fed with
+    /// addBackgroundFrame(). When enabled, subtractBackground() and
+    /// correct() use the latest published model snapshot instead of the
+    /// calibration background.
+    bool isBgStream() const { return mBgStream; }
+    void setBgStream(bool enable) { mBgStream = enable; }
+    StBackgroundModel& getBgModel() { return mBgModel; }
+
+    //----------------------------------------------
+    /// Feed a dark frame to the streaming background model. With
+    /// geocorrection enabled the frame is geocorrected into frameWork
+    /// first, so the model has the geometry the subtraction uses.
+    ///
+    /// @param[in]  frameSrc    dark frame
+    /// @param[out] frameWork   output geometry frame with
+    ///                         getOutputPixelType() (used when geocorrecting)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t addBackgroundFrame(StFrameBuffer& frameSrc, StFrameBuffer& frameWork)
+    {
+        if (!mGeocorr)
+        {
+            return mBgModel.addFrame(frameSrc);
+        }
+        int32_t rtn = runChain(frameSrc, frameWork, ST_CHAIN_DEBOUNCE_NONE, false);
+        if (ST_ERR_OK != rtn)
+        {
+            return rtn;
+        }
+        return mBgModel.addFrame(frameWork);
+    }
+
+    //----------------------------------------------
+    /// N-frame summing into int64/float accumulators. Add frames with
+    /// getAccumulator().addFrame(frame, getWorkerPool()).
+    StFrameAccumulator& getAccumulator() { return mAccumulator; }
+
+    //----------------------------------------------
+    /// Configure the worker pool
+    ///
+    /// @param[in] threadCount  total threads including the calling thread,
+    ///                         0 selects one per core (see WorkPool::init())
+    /// @param[in] cpuList      cores to pin workers to, round-robin
+    ///                         (empty = no pinning)
+    ///
+    /// @return 0 if ok, else negative error code. The engine keeps
+    ///         running on the calling thread on error.
+    ///
+    int32_t setWorkerThreads(uint32_t threadCount, const std::vector<int>& cpuList = std::vector<int>())
+    {
+        return mPool.init(threadCount, cpuList);
+    }
+    uint32_t getWorkerThreads() { return mPool.getThreadCount(); }
+    std::vector<int> getWorkerCpuList() { return mPool.getCpuList(); }
+    STUTIL::WorkPool* getWorkerPool() { return &mPool; }
+
+    //----------------------------------------------
+    /// Set rows per tile; 0 sizes tiles from ST_CORR_TILE_BYTES
+    void setTileRows(uint32_t rows) { mTileRows = rows; }
+
+    //----------------------------------------------
+    /// Return rows per tile for a row size in bytes
+    uint32_t getTileRows(uint32_t rowBytes) const
+    {
+        if (mTileRows > 0)
+        {
+            return mTileRows;
+        }
+        if ((0 == rowBytes) || (rowBytes >= ST_CORR_TILE_BYTES))
+        {
+            return 1;
+        }
+        return ST_CORR_TILE_BYTES / rowBytes;
+    }
+
+    //----------------------------------------------
+    /// Call func(rowBegin, rowEnd) for every row tile of an image on
+    /// the worker pool. Blocks until all tiles are done. func must only
+    /// touch rows in its own range.
+    void forEachRowTile(uint32_t rows, uint32_t rowBytes, const STUTIL::WorkPoolFunc& func)
+    {
+        mPool.parallelFor(rows, getTileRows(rowBytes), func);
+    }
+
+    //----------------------------------------------
+    /// Compute fDest = fFg - calibration bg_img_f
+    ///
+    /// @param[in]  fFg     foreground frame
+    /// @param[out] fDest   result, same pixel type as fFg, may be fFg
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t subtractBgFloat(StFrameBuffer& fFg, StFrameBuffer& fDest)
+    {
+        StCorrCalibrationPtr cal = getCalibration();
+        if (!cal || cal->bg_img_f.empty())
+        {
+            return ST_ERR_NO_BACKGROUND;
+        }
+        return subtractBgPixels(fFg, fDest, cal->bg_img_f.data(), DT_FLOAT, cal->bg_img_f.size());
+    }
+
+    //----------------------------------------------
+    /// Compute fDest = fFg - background: the background model snapshot
+    /// when streaming, otherwise the calibration bg_img_f (float
+    /// precision) or bg_img_d.
+    ///
+    /// @param[in]  fFg     foreground frame
+    /// @param[out] fDest   result, same pixel type as fFg, may be fFg
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t subtractBackground(StFrameBuffer& fFg, StFrameBuffer& fDest)
+    {
+        if (mBgStream)
+        {
+            return mBgModel.subtract(fFg, fDest);
+        }
+        if (ST_CORR_PRECISION_FLOAT == mPrecision)
+        {
+            return subtractBgFloat(fFg, fDest);
+        }
+        StCorrCalibrationPtr cal = getCalibration();
+        if (!cal || cal->bg_img_d.empty())
+        {
+            return ST_ERR_NO_BACKGROUND;
+        }
+        return subtractBgPixels(fFg, fDest, cal->bg_img_d.data(), DT_DOUBLE, cal->bg_img_d.size());
+    }
+
+    //----------------------------------------------
+    /// Run the enabled corrections as one fused pass in row tiles on
+    /// the worker pool (see st_corr_chain.h)
+    ///
+    /// @param[in]  frameSrc    source frame
+    /// @param[out] frameDest   output frame sized for the output geometry,
+    ///                         with getOutputPixelType(). Must not share
+    ///                         memory with frameSrc.
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_IMPL if the combination cannot be
+    ///         fused (NEIGHBOR debounce), else negative error code
+    ///
+    /// @note With debounce enabled the time of the whole fused pass is
+    /// added to the debounce method's cost counter, as the debounce
+    /// cannot be timed on its own there.
+    ///
+    int32_t applyCorrectionChain(StFrameBuffer& frameSrc, StFrameBuffer& frameDest)
+    {
+        StChainDebounce deb;
+        if (!getChainDebounce(mDebounce, mDebounceMethod, deb))
+        {
+            return ST_ERR_NOT_IMPL;
+        }
+        auto start = std::chrono::steady_clock::now();
+        int32_t rtn = runChain(frameSrc, frameDest, deb, mBgSub);
+        if ((ST_ERR_OK == rtn) && (ST_CHAIN_DEBOUNCE_NONE != deb))
+        {
+            mDebouncer.addCost(mDebounceMethod, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count()));
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Run the enabled corrections in the order geocorrection,
+    /// debounce, background subtraction. Uses one fused pass when
+    /// possible; with NEIGHBOR debounce the geocorrection is fused with
+    /// the copy and debounce and background subtraction follow as
+    /// separate passes.
+    ///
+    /// @param[in]  frameSrc    source frame
+    /// @param[out] frameDest   output frame, see applyCorrectionChain()
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t correct(StFrameBuffer& frameSrc, StFrameBuffer& frameDest)
+    {
+        int32_t rtn = applyCorrectionChain(frameSrc, frameDest);
+        if (ST_ERR_NOT_IMPL != rtn)
+        {
+            return rtn;
+        }
+        rtn = runChain(frameSrc, frameDest, ST_CHAIN_DEBOUNCE_NONE, false);
+        if (ST_ERR_OK != rtn)
+        {
+            return rtn;
+        }
+        rtn = mDebouncer.apply(mDebounceMethod, frameDest);
+        if ((ST_ERR_OK != rtn) || !mBgSub)
+        {
+            return rtn;
+        }
+        return subtractBackground(frameDest, frameDest);
+    }
+
+    //----------------------------------------------
+    /// Decode raw MM-PAD digital/analog pixels with the calibration
+    /// mm_decode tables
+    ///
+    /// @param[in]  fRaw    raw frame
+    /// @param[out] fDest   DT_DOUBLE or DT_FLOAT frame, raw geometry
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t decodeImage(StFrameBuffer& fRaw, StFrameBuffer& fDest)
+    {
+        StCorrCalibrationPtr cal = getCalibration();
+        if (!cal)
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        return cal->mm_decode.decode(fRaw, fDest, &mPool);
+    }
+
+    //----------------------------------------------
+    /// Select the KeckPAD caps to correct
+    ///
+    /// @param[in] capSelect    stack index of each cap, in cap order.
+    ///                         Callers using the library cap registers
+    ///                         pass StCorrections getCapReg()/getCapCnt().
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t setCapSelect(const std::vector<int>& capSelect)
+    {
+        if (capSelect.size() > KK_MAX_CAPACITOR_COUNT)
+        {
+            return ST_ERR_CAP_COUNT;
+        }
+        mCapSelect = capSelect;
+        return ST_ERR_OK;
+    }
+    const std::vector<int>& getCapSelect() const { return mCapSelect; }
+
+    //----------------------------------------------
+    /// Correct the selected caps of a KeckPAD stack in one pass with the
+    /// calibration kk_stack (per-cap background and gain)
+    ///
+    /// @param[in]  stack       every frame of the stack
+    /// @param[out] outFrames   one DT_FLOAT or DT_DOUBLE frame per selected cap
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t correctCapStack(std::vector<StFrameBuffer*>& stack, std::vector<StFrameBuffer*>& outFrames)
+    {
+        StCorrCalibrationPtr cal = getCalibration();
+        if (!cal)
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        if (mCapSelect.empty() || (mCapSelect.size() != cal->kk_stack.getCapCount()))
+        {
+            return ST_ERR_CAP_COUNT;
+        }
+        std::vector<StFrameBuffer*> caps(mCapSelect.size());
+        for (size_t c = 0; c < mCapSelect.size(); c++)
+        {
+            if ((mCapSelect[c] < 0) || (static_cast<size_t>(mCapSelect[c]) >= stack.size()))
+            {
+                return ST_ERR_INDEX;
+            }
+            caps[c] = stack[mCapSelect[c]];
+            if (nullptr == caps[c])
+            {
+                return ST_ERR_NULL_PTR;
+            }
+        }
+        return cal->kk_stack.processFrames(caps, outFrames, &mPool);
+    }
+
+private:
+    //----------------------------------------------
+    /// Subtract a background array of the given type
+    int32_t subtractBgPixels(StFrameBuffer& fFg, StFrameBuffer& fDest,
+                             const void* pBg, STDataType bgType, size_t bgCount)
+    {
+        uint32_t count = fFg.getImagePixelCount();
+        if ((bgCount != count) || (fDest.getImagePixelCount() != count))
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        if (fFg.getPixelType() != fDest.getPixelType())
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+        StSubtractOp op = { fFg.getImagePtr(), pBg, fDest.getImagePtr(), count };
+        if ((nullptr == op.pFg) || (nullptr == op.pDest))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return dispatchPixelTypes(fFg.getPixelType(), bgType, op);
+    }
+
+    //----------------------------------------------
+    /// Select and run one fused chain
+    int32_t runChain(StFrameBuffer& frameSrc, StFrameBuffer& frameDest, StChainDebounce deb, bool bgSub)
+    {
+        StCorrCalibrationPtr cal = getCalibration();
+        StCorrChainArgs args = {};
+        args.pSrc = frameSrc.getImagePtr();
+        args.pDest = frameDest.getImagePtr();
+        args.width = frameDest.getImageWidth();
+        args.debounce = mDebouncer.getParams();
+        if ((nullptr == args.pSrc) || (nullptr == args.pDest))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if (frameDest.getPixelType() != getOutputPixelType())
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+        uint32_t count = frameDest.getImagePixelCount();
+        const uint8_t* pSrcBytes = static_cast<const uint8_t*>(args.pSrc);
+        const uint8_t* pDestBytes = static_cast<const uint8_t*>(args.pDest);
+        if ((pSrcBytes < pDestBytes + static_cast<size_t>(count) * frameDest.getPixelBytes()) &&
+            (pDestBytes < pSrcBytes + static_cast<size_t>(frameSrc.getImagePixelCount()) * frameSrc.getPixelBytes()))
+        {
+            return ST_ERR_PARAM;    // The chains cannot run in place
+        }
+
+        if (mGeocorr)
+        {
+            if (!cal || !cal->geo_remap.isValid())
+            {
+                return ST_ERR_NOT_AVAILABLE;
+            }
+            const StRemapTable& remap = cal->geo_remap;
+            if ((frameSrc.getImageWidth() != remap.getSrcWidth()) ||
+                (frameSrc.getImageHeight() != remap.getSrcHeight()) ||
+                (frameDest.getImageWidth() != remap.getOutWidth()) ||
+                (frameDest.getImageHeight() != remap.getOutHeight()))
+            {
+                return ST_ERR_IMAGE_SIZE;
+            }
+            args.pRemap = &remap;
+        }
+        else if (frameSrc.getImagePixelCount() != count)
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+
+        StChainBg bg = ST_CHAIN_BG_NONE;
+        StBgSnapshot bgSnap;    // Keeps the streaming background alive for the pass
+        if (bgSub && mBgStream)
+        {
+            bgSnap = mBgModel.getSnapshot();
+            if (!bgSnap)
+            {
+                return ST_ERR_NO_BACKGROUND;
+            }
+            if (bgSnap->size() != count)
+            {
+                return ST_ERR_IMAGE_SIZE;
+            }
+            args.pBgD = bgSnap->data();
+            bg = ST_CHAIN_BG_DOUBLE;
+        }
+        else if (bgSub && (ST_CORR_PRECISION_FLOAT == mPrecision))
+        {
+            if (!cal || cal->bg_img_f.empty())
+            {
+                return ST_ERR_NO_BACKGROUND;
+            }
+            if (cal->bg_img_f.size() != count)
+            {
+                return ST_ERR_IMAGE_SIZE;
+            }
+            args.pBgF = cal->bg_img_f.data();
+            bg = ST_CHAIN_BG_FLOAT;
+        }
+        else if (bgSub)
+        {
+            if (!cal || cal->bg_img_d.empty())
+            {
+                return ST_ERR_NO_BACKGROUND;
+            }
+            if (cal->bg_img_d.size() != count)
+            {
+                return ST_ERR_IMAGE_SIZE;
+            }
+            args.pBgD = cal->bg_img_d.data();
+            bg = ST_CHAIN_BG_DOUBLE;
+        }
+
+        StCorrChainFunc chain = selectCorrChain(frameSrc.getPixelType(), frameDest.getPixelType(),
+                                                mGeocorr, deb, bg);
+        if (nullptr == chain)
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+        uint32_t rowBytes = args.width * frameDest.getPixelBytes();
+        forEachRowTile(frameDest.getImageHeight(), rowBytes,
+                       [chain, &args](size_t begin, size_t end) { chain(args, begin, end); });
+        return ST_ERR_OK;
+    }
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_CORR_ENGINE_H
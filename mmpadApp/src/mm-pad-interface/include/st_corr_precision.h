@@ -0,0 +1,189 @@
+//*******************************************************************
+/// @file st_corr_precision.h
+/// Sydor X-PAD correction pipeline precision selection
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// The corrections pipeline (background, gain, geocorrection buffers
+/// and the corrected output) can run in double (the historical
+/// MMGCRawPixel type) or float precision. Float halves the bytes moved
+/// per pixel, which is what limits correction throughput.
+///
+/// Error bound of the float path against the double path
+/// ------------------------------------------------------
+/// Let u = 2^-24 (float unit roundoff, ~5.96e-8). For one output
+/// pixel produced from K geocorrection terms w_k * x_k, followed by
+/// background subtraction and a gain multiply,
+///
+///     out = (sum_k(w_k * x_k) - bg) * gain
+///
+/// each float operation contributes at most one rounding of relative
+/// size u, and the inputs are rounded to float once. The standard
+/// summation bound (gamma_n = n*u / (1 - n*u)) then gives
+///
+///     |out_float - out_double| <= gamma_(K+4) * (sum_k|w_k * x_k| + |bg|) * |gain|
+///
+/// For the MM-PAD geocorrection (K <= 4) this is about 4.8e-7 of the
+/// pixel magnitude, i.e. < 1 ADU for pixel values below ~2,000,000 ADU.
+/// Raw integer pixel values below 2^24 are represented exactly.
+/// corrFloatErrorBound() evaluates the bound. compareCorrPrecision()
+/// measures the actual deviation between a double and a float result.
+///
+/// Double values are narrowed to float with corrToFloat(), which clamps
+/// to the finite float range (+/-FLT_MAX) instead of producing inf, so
+/// a saturated double pixel stays the largest float pixel.
+///
+//*******************************************************************
+#ifndef ST_CORR_PRECISION_H
+#define ST_CORR_PRECISION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cmath>
+#include <cfloat>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const double ST_CORR_FLOAT_UNIT_ROUNDOFF = 5.9604644775390625e-8;  ///< 2^-24
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Correction pipeline precision
+enum StCorrPrecision
+{
+    ST_CORR_PRECISION_DOUBLE = 0,   ///< 8 byte pixels (default, MMGCRawPixel)
+    ST_CORR_PRECISION_FLOAT  = 1    ///< 4 byte pixels
+};
+
+//******************************************************************
+// Functions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Return the corrected pixel type for a precision
+inline STDataType getCorrPixelType(StCorrPrecision precision)
+{
+    return (ST_CORR_PRECISION_FLOAT == precision) ? DT_FLOAT : DT_DOUBLE;
+}
+
+//------------------------------------------------------------------
+/// Evaluate the documented float path error bound for one pixel
+///
+/// @param[in] magnitude    sum_k|w_k * x_k| + |bg|, times |gain|
+/// @param[in] terms        geocorrection terms K for the pixel (0 if no geocorrection)
+///
+/// @return maximum absolute deviation of the float result from the double result
+///
+inline double corrFloatErrorBound(double magnitude, uint32_t terms)
+{
+    double nu = static_cast<double>(terms + 4) * ST_CORR_FLOAT_UNIT_ROUNDOFF;
+    return (nu / (1.0 - nu)) * std::fabs(magnitude);
+}
+
+//------------------------------------------------------------------
+/// Narrow a double pixel to float, clamped to +/-FLT_MAX (NaN is kept)
+inline float corrToFloat(double value)
+{
+    if (value > static_cast<double>(FLT_MAX))
+    {
+        return FLT_MAX;
+    }
+    if (value < -static_cast<double>(FLT_MAX))
+    {
+        return -FLT_MAX;
+    }
+    return static_cast<float>(value);
+}
+
+//------------------------------------------------------------------
+/// Narrow a run of double pixels to float with corrToFloat()
+inline void corrToFloatPixels(const double* pSrc, float* pDest, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        pDest[i] = corrToFloat(pSrc[i]);
+    }
+}
+
+//------------------------------------------------------------------
+/// Measure the deviation of float pixels from double pixels
+///
+/// @param[in]  pDouble     reference pixels
+/// @param[in]  pFloat      float pixels
+/// @param[in]  count       pixels to compare
+/// @param[out] maxAbsErr   largest absolute difference
+/// @param[out] maxRelErr   largest difference relative to |reference|
+///                         (pixels with a zero reference are skipped)
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t compareCorrPixels(const double* pDouble, const float* pFloat, size_t count,
+                                 double& maxAbsErr, double& maxRelErr)
+{
+    if ((nullptr == pDouble) || (nullptr == pFloat))
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    maxAbsErr = 0.0;
+    maxRelErr = 0.0;
+    for (size_t i = 0; i < count; i++)
+    {
+        double err = std::fabs(static_cast<double>(pFloat[i]) - pDouble[i]);
+        if (err > maxAbsErr)
+        {
+            maxAbsErr = err;
+        }
+        if ((pDouble[i] != 0.0) && ((err / std::fabs(pDouble[i])) > maxRelErr))
+        {
+            maxRelErr = err / std::fabs(pDouble[i]);
+        }
+    }
+    return ST_ERR_OK;
+}
+
+//------------------------------------------------------------------
+/// Measure the deviation of a float corrected frame from a double one
+///
+/// @param[in]  fDouble     reference frame (DT_DOUBLE)
+/// @param[in]  fFloat      float frame (DT_FLOAT), same geometry
+/// @param[out] maxAbsErr   largest absolute difference
+/// @param[out] maxRelErr   largest difference relative to |reference|
+///                         (pixels with a zero reference are skipped)
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t compareCorrPrecision(StFrameBuffer& fDouble, StFrameBuffer& fFloat,
+                                    double& maxAbsErr, double& maxRelErr)
+{
+    if ((DT_DOUBLE != fDouble.getPixelType()) || (DT_FLOAT != fFloat.getPixelType()))
+    {
+        return ST_ERR_DATA_TYPE;
+    }
+    uint32_t count = fDouble.getImagePixelCount();
+    if (count != fFloat.getImagePixelCount())
+    {
+        return ST_ERR_IMAGE_SIZE;
+    }
+    return compareCorrPixels(reinterpret_cast<const double*>(fDouble.getImagePtr()),
+                             reinterpret_cast<const float*>(fFloat.getImagePtr()),
+                             count, maxAbsErr, maxRelErr);
+}
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_CORR_PRECISION_H
@@ -47,9 +47,15 @@
 #include <vector>
 #include <mutex>
 #include <istream>
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#include <functional>
 #include "nlohmann_json_fwd.hpp"
 #include "st_parameter.h"
 #include "st_alias.h"
+#include "st_dict_cache.h"
+#include "stutil_mapfile.hpp"
 
 //******************************************************************
 /// @name Forward Declarations
@@ -524,6 +530,202 @@ public:
     ///
     void toJson(nlohmann::json& j) const;
 
+    //----------------------------------------------
+    /// Save the parsed data dictionary to a binary cache snapshot
+    ///
+    /// Writes the dictionary metadata, JSON text, aliases, parameters
+    /// and telemetry parameters (see st_dict_cache.h). The file is
+    /// written under a temporary name and renamed into place, so a
+    /// reader never maps a partly written snapshot.
+    ///
+    /// @param[in] path         snapshot file path (makeDictCachePath())
+    ///
+    /// @return 0 if ok, negative error code on any error
+    ///
+    int32_t saveBinary(const std::string& path)
+    {
+        if (path.empty() || mParameters.empty())
+        {
+            return ST_ERR_PARAM;
+        }
+
+        StDictWriter w;
+        w.reserve(mDictionary.size() + 256 * (mParameters.size() + mTelemParams.size()));
+        w.put<uint32_t>(mDictVersion);
+        w.putStr(mDictDate);
+        w.put<uint32_t>(mMinHfpgaVersion);
+        w.put<uint32_t>(mMaxHfpgaVersion);
+        w.put<uint32_t>(mMinSfpgaVersion);
+        w.put<uint32_t>(mMaxSfpgaVersion);
+        w.put<uint32_t>(mMinRtSupVersion);
+        w.put<uint32_t>(mMaxRtSupVersion);
+        w.putStr(mDictionary);
+        for (auto it = mAliases.begin(); it != mAliases.end(); ++it)
+        {
+            w.putStr(it->first);
+            w.putStr(it->second.getDefinition());
+            w.put<uint8_t>(it->second.isProtected());
+        }
+        for (auto it = mParameters.begin(); it != mParameters.end(); ++it)
+        {
+            it->second.toBinary(w);
+        }
+        for (const StParameter& param : mTelemParams)
+        {
+            param.toBinary(w);
+        }
+
+        const std::string& payload = w.getBuffer();
+        StDictCacheHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        hdr.magic = ST_DICT_CACHE_MAGIC;
+        hdr.format = ST_DICT_CACHE_FORMAT;
+        hdr.headerBytes = sizeof(StDictCacheHeader);
+        hdr.dictVersion = mDictVersion;
+        hdr.payloadBytes = payload.size();
+        hdr.checksum = stDictChecksum(payload.data(), payload.size());
+        hdr.paramCount = static_cast<uint32_t>(mParameters.size());
+        hdr.aliasCount = static_cast<uint32_t>(mAliases.size());
+        hdr.telemCount = static_cast<uint32_t>(mTelemParams.size());
+
+        // Unique temporary name - several clients may save the same snapshot
+        size_t tag = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                     static_cast<size_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        std::string tmpPath = path + ".tmp" + std::to_string(tag);
+        FILE* fp = fopen(tmpPath.c_str(), "wb");
+        if (nullptr == fp)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        bool ok = (1 == fwrite(&hdr, sizeof(hdr), 1, fp)) &&
+                  (1 == fwrite(payload.data(), payload.size(), 1, fp));
+        ok = (0 == fclose(fp)) && ok;
+        if (ok && (0 != rename(tmpPath.c_str(), path.c_str())))
+        {
+            // Windows does not rename over an existing file
+            remove(path.c_str());
+            ok = (0 == rename(tmpPath.c_str(), path.c_str()));
+        }
+        if (!ok)
+        {
+            remove(tmpPath.c_str());
+            return ST_ERR_FILE_WRITE;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Load the data dictionary from a binary cache snapshot
+    ///
+    /// The snapshot is mapped, checked (header, size, checksum, version
+    /// and date) and decoded into temporaries. The data store is only
+    /// replaced when the whole snapshot is good. All cached values
+    /// start out not valid.
+    ///
+    /// @param[in] path         snapshot file path (makeDictCachePath())
+    /// @param[in] version      expected dictionary version
+    /// @param[in] date         expected dictionary date
+    ///
+    /// @return 0 if ok, ST_ERR_FILE_OPEN if there is no snapshot,
+    ///         ST_ERR_NOT_AVAILABLE if it is for another dictionary,
+    ///         ST_ERR_FILE_FORMAT if it is damaged, else negative error code
+    ///
+    int32_t loadBinary(const std::string& path, uint32_t version, const std::string& date)
+    {
+        STUTIL::MapFile file;
+        int32_t rtn = file.open(path);
+        if (0 != rtn)
+        {
+            return rtn;
+        }
+        StDictCacheHeader hdr;
+        if (file.size() < sizeof(hdr))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        memcpy(&hdr, file.data(), sizeof(hdr));
+        if ((ST_DICT_CACHE_MAGIC != hdr.magic) || (ST_DICT_CACHE_FORMAT != hdr.format) ||
+            (sizeof(hdr) != hdr.headerBytes) || (hdr.payloadBytes != (file.size() - sizeof(hdr))))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        if (version != hdr.dictVersion)
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        file.prefetch();
+        const uint8_t* pPayload = file.data() + sizeof(hdr);
+        size_t payloadBytes = static_cast<size_t>(hdr.payloadBytes);
+        if (hdr.checksum != stDictChecksum(pPayload, payloadBytes))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+
+        StDictReader r(pPayload, payloadBytes);
+        uint32_t dictVersion = r.get<uint32_t>();
+        std::string dictDate = r.getStr();
+        if ((version != dictVersion) || (date != dictDate))
+        {
+            return r.isOk() ? ST_ERR_NOT_AVAILABLE : ST_ERR_FILE_FORMAT;
+        }
+        uint32_t versions[6];
+        for (uint32_t& v : versions)
+        {
+            v = r.get<uint32_t>();
+        }
+        std::string dictionary = r.getStr();
+
+        std::map<std::string, StAlias> aliases;
+        for (uint32_t i = 0; r.isOk() && (i < hdr.aliasCount); i++)
+        {
+            std::string id = r.getStr();
+            std::string def = r.getStr();
+            bool isProtected = (0 != r.get<uint8_t>());
+            aliases.insert(std::make_pair(id, StAlias(id, def, isProtected)));
+        }
+
+        // Parameters were saved in id order, so each insert goes at the end
+        std::map<std::string, StParameter> params;
+        for (uint32_t i = 0; r.isOk() && (i < hdr.paramCount); i++)
+        {
+            StParameter param;
+            if (0 != param.fromBinary(r))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+            params.emplace_hint(params.end(), param.getId(), param);
+        }
+
+        std::vector<StParameter> telemParams;
+        telemParams.reserve(r.isOk() ? hdr.telemCount : 0);
+        for (uint32_t i = 0; r.isOk() && (i < hdr.telemCount); i++)
+        {
+            telemParams.push_back(StParameter());
+            if (0 != telemParams.back().fromBinary(r))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+        }
+        if (!r.atEnd() || (params.size() != hdr.paramCount) || (aliases.size() != hdr.aliasCount))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+
+        mDictVersion = dictVersion;
+        mDictDate = dictDate;
+        mMinHfpgaVersion = versions[0];
+        mMaxHfpgaVersion = versions[1];
+        mMinSfpgaVersion = versions[2];
+        mMaxSfpgaVersion = versions[3];
+        mMinRtSupVersion = versions[4];
+        mMaxRtSupVersion = versions[5];
+        mDictionary.swap(dictionary);
+        mAliases.swap(aliases);
+        mParameters.swap(params);
+        mTelemParams.swap(telemParams);
+        return ST_ERR_OK;
+    }
+
     //----------------------------------------------
     /// get a config parameter JSON string
     ///
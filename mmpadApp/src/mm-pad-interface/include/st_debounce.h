@@ -0,0 +1,380 @@
+//*******************************************************************
+/// @file st_debounce.h
+/// Sydor X-PAD debounce methods, kernels and cost accounting
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// Debouncing corrects corrected-image pixels whose value "bounced" by
+/// a charge removal step, or fell below the noise floor, at readout.
+/// Several methods with different cost/quality trade-offs are
+/// available. Each is registered by number (the value written to the
+/// Debounce_Method parameter / ST_ADDR_DEBOUNCE_METHOD register, and
+/// given to StCorrEngine::setDebounceMethod()) and by name.
+///
+/// Kernels operate in place on DT_DOUBLE or DT_FLOAT images. The
+/// per-pixel methods are branch-free select loops the compiler can
+/// vectorize.
+///
+/// StDebounce runs the selected method and keeps a per-method cost
+/// counter (frames processed, total and last processing time) so the
+/// cheapest method meeting data quality at a given frame rate can be
+/// chosen from measurements. Passes that run a method fused with other
+/// steps (st_corr_chain.h) add their time with addCost().
+///
+//*******************************************************************
+#ifndef ST_DEBOUNCE_H
+#define ST_DEBOUNCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Debounce methods. Values must match the Debounce_Method parameter.
+enum StDebounceMethod
+{
+    ST_DEBOUNCE_STEP     = 0,   ///< Fold values below -step/2 up by one removal step (default)
+    ST_DEBOUNCE_CLAMP    = 1,   ///< Clamp values below the noise floor to the floor
+    ST_DEBOUNCE_NEIGHBOR = 2,   ///< Replace isolated step outliers with the 4-neighbor mean
+    ST_DEBOUNCE_METHOD_COUNT    ///< Number of methods (not a method)
+};
+
+//----------------------------------------------
+/// Debounce tuning parameters, normally derived from calibration
+struct StDebounceParams
+{
+    double stepAdu;         ///< ADU per charge removal step (STEP, NEIGHBOR)
+    double floor;           ///< Noise floor (CLAMP)
+    double threshold;       ///< Outlier threshold in ADU (NEIGHBOR)
+
+    StDebounceParams() : stepAdu(0.0), floor(0.0), threshold(0.0) {}
+};
+
+//----------------------------------------------
+/// Snapshot of a method's cost counter
+struct StDebounceCost
+{
+    uint64_t frames;        ///< Frames processed
+    uint64_t totalNsec;     ///< Total processing time
+    uint64_t lastNsec;      ///< Processing time of the last frame
+    double   avgUsec;       ///< Average processing time per frame
+};
+
+/// Kernel signatures. scratch is caller owned and may be resized by the kernel.
+typedef void (*StDebounceKernelD)(double* pImg, uint32_t width, uint32_t height,
+                                  const StDebounceParams& params, std::vector<uint8_t>& scratch);
+typedef void (*StDebounceKernelF)(float* pImg, uint32_t width, uint32_t height,
+                                  const StDebounceParams& params, std::vector<uint8_t>& scratch);
+
+//----------------------------------------------
+/// Method registry entry
+struct StDebounceMethodInfo
+{
+    StDebounceMethod  method;       ///< Method number
+    const char*       name;         ///< Method name (EPICS menu string)
+    const char*       description;  ///< One line description
+    StDebounceKernelD kernelD;      ///< double image kernel
+    StDebounceKernelF kernelF;      ///< float image kernel
+};
+
+//******************************************************************
+// Kernels
+//******************************************************************
+
+//------------------------------------------------------------------
+/// STEP: v < -step/2  ->  v + step
+template<typename T>
+inline void debounceStepKernel(T* pImg, uint32_t width, uint32_t height,
+                               const StDebounceParams& params, std::vector<uint8_t>&)
+{
+    const T step = static_cast<T>(params.stepAdu);
+    const T limit = -step / 2;
+    const size_t count = static_cast<size_t>(width) * height;
+    T* ST_RESTRICT p = pImg;
+    for (size_t i = 0; i < count; i++)
+    {
+        p[i] = (p[i] < limit) ? (p[i] + step) : p[i];
+    }
+}
+
+//------------------------------------------------------------------
+/// CLAMP: v < floor  ->  floor
+template<typename T>
+inline void debounceClampKernel(T* pImg, uint32_t width, uint32_t height,
+                                const StDebounceParams& params, std::vector<uint8_t>&)
+{
+    const T floorValue = static_cast<T>(params.floor);
+    const size_t count = static_cast<size_t>(width) * height;
+    T* ST_RESTRICT p = pImg;
+    for (size_t i = 0; i < count; i++)
+    {
+        p[i] = (p[i] < floorValue) ? floorValue : p[i];
+    }
+}
+
+//------------------------------------------------------------------
+/// NEIGHBOR: an interior pixel differing from the mean of its four
+/// neighbors by more than threshold AND by about one step
+/// (|d - step| < step/2) is replaced by that mean. Edge pixels are
+/// unchanged.
+template<typename T>
+inline void debounceNeighborKernel(T* pImg, uint32_t width, uint32_t height,
+                                   const StDebounceParams& params, std::vector<uint8_t>& scratch)
+{
+    if ((width < 3) || (height < 3))
+    {
+        return;
+    }
+
+    // Keep an unmodified copy of the previous and current rows
+    scratch.resize(2 * width * sizeof(T));
+    T* pPrev = reinterpret_cast<T*>(scratch.data());
+    T* pCur  = pPrev + width;
+    const T threshold = static_cast<T>(params.threshold);
+    const T step = static_cast<T>(params.stepAdu);
+    const T halfStep = step / 2;
+
+    std::memcpy(pPrev, pImg, width * sizeof(T));
+    for (uint32_t row = 1; row < height - 1; row++)
+    {
+        T* ST_RESTRICT pRow = pImg + static_cast<size_t>(row) * width;
+        const T* ST_RESTRICT pNext = pRow + width;
+        std::memcpy(pCur, pRow, width * sizeof(T));
+        for (uint32_t col = 1; col < width - 1; col++)
+        {
+            T mean = (pPrev[col] + pNext[col] + pCur[col - 1] + pCur[col + 1]) / 4;
+            T d = std::fabs(pCur[col] - mean);
+            bool outlier = (d > threshold) && (std::fabs(d - step) < halfStep);
+            pRow[col] = outlier ? mean : pCur[col];
+        }
+        T* pSwap = pPrev;
+        pPrev = pCur;
+        pCur = pSwap;
+    }
+}
+
+//******************************************************************
+// Registry
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Return the method registry table, indexed by StDebounceMethod
+///
+/// @param[out] pCount  number of entries (ST_DEBOUNCE_METHOD_COUNT)
+///
+inline const StDebounceMethodInfo* getDebounceMethodTable(uint32_t* pCount = nullptr)
+{
+    static const StDebounceMethodInfo table[ST_DEBOUNCE_METHOD_COUNT] =
+    {
+        { ST_DEBOUNCE_STEP, "Step", "Fold values below -step/2 up by one step",
+          &debounceStepKernel<double>, &debounceStepKernel<float> },
+        { ST_DEBOUNCE_CLAMP, "Clamp", "Clamp values below the noise floor",
+          &debounceClampKernel<double>, &debounceClampKernel<float> },
+        { ST_DEBOUNCE_NEIGHBOR, "Neighbor", "Replace one-step outliers with the 4-neighbor mean",
+          &debounceNeighborKernel<double>, &debounceNeighborKernel<float> },
+    };
+    if (nullptr != pCount)
+    {
+        *pCount = ST_DEBOUNCE_METHOD_COUNT;
+    }
+    return table;
+}
+
+//------------------------------------------------------------------
+/// Look up a method registry entry by number
+///
+/// @return pointer to the entry, or nullptr if method is invalid
+///
+inline const StDebounceMethodInfo* findDebounceMethod(uint32_t method)
+{
+    if (method >= ST_DEBOUNCE_METHOD_COUNT)
+    {
+        return nullptr;
+    }
+    return &getDebounceMethodTable()[method];
+}
+
+//------------------------------------------------------------------
+/// Look up a method registry entry by name (case sensitive)
+///
+/// @return pointer to the entry, or nullptr if not found
+///
+inline const StDebounceMethodInfo* findDebounceMethod(const char* name)
+{
+    if (nullptr == name)
+    {
+        return nullptr;
+    }
+    const StDebounceMethodInfo* pTable = getDebounceMethodTable();
+    for (uint32_t i = 0; i < ST_DEBOUNCE_METHOD_COUNT; i++)
+    {
+        if (0 == std::strcmp(pTable[i].name, name))
+        {
+            return &pTable[i];
+        }
+    }
+    return nullptr;
+}
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Debounce engine with per-method cost counters
+class StDebounce
+{
+private:
+    /// Per-method counters (atomic so they can be read while a frame is processed)
+    struct Counter
+    {
+        std::atomic<uint64_t> frames;
+        std::atomic<uint64_t> totalNsec;
+        std::atomic<uint64_t> lastNsec;
+    };
+
+    std::mutex mParamLock;                          ///< Protects mParams
+    StDebounceParams mParams;                       ///< Tuning parameters
+    Counter mCost[ST_DEBOUNCE_METHOD_COUNT];        ///< Cost counters
+    std::vector<uint8_t> mScratch;                  ///< Kernel scratch buffer
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StDebounce()
+    {
+        resetCost();
+    }
+
+    //----------------------------------------------
+    /// Set/get tuning parameters (may be set while frames are processed)
+    void setParams(const StDebounceParams& params)
+    {
+        std::lock_guard<std::mutex> lock(mParamLock);
+        mParams = params;
+    }
+    StDebounceParams getParams()
+    {
+        std::lock_guard<std::mutex> lock(mParamLock);
+        return mParams;
+    }
+
+    //----------------------------------------------
+    /// Debounce a frame image in place
+    ///
+    /// @param[in]     method   debounce method
+    /// @param[in,out] frame    frame with DT_DOUBLE or DT_FLOAT image
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t apply(uint32_t method, StFrameBuffer& frame)
+    {
+        const StDebounceMethodInfo* pInfo = findDebounceMethod(method);
+        if (nullptr == pInfo)
+        {
+            return ST_ERR_PARAM;
+        }
+        void* pImg = frame.getImagePtr();
+        if (nullptr == pImg)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+
+        StDebounceParams params = getParams();
+        auto start = std::chrono::steady_clock::now();
+        switch (frame.getPixelType())
+        {
+            case DT_DOUBLE:
+                pInfo->kernelD(static_cast<double*>(pImg), frame.getImageWidth(),
+                               frame.getImageHeight(), params, mScratch);
+                break;
+            case DT_FLOAT:
+                pInfo->kernelF(static_cast<float*>(pImg), frame.getImageWidth(),
+                               frame.getImageHeight(), params, mScratch);
+                break;
+            default:
+                return ST_ERR_DATA_TYPE;
+        }
+        addCost(method, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start).count()));
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Count one processed frame against a method
+    ///
+    /// @param[in] method   debounce method
+    /// @param[in] nsec     processing time of the frame
+    ///
+    void addCost(uint32_t method, uint64_t nsec)
+    {
+        if (method >= ST_DEBOUNCE_METHOD_COUNT)
+        {
+            return;
+        }
+        Counter& c = mCost[method];
+        c.frames++;
+        c.totalNsec += nsec;
+        c.lastNsec = nsec;
+    }
+
+    //----------------------------------------------
+    /// Return the cost counter for a method
+    ///
+    /// @param[in]  method  debounce method
+    /// @param[out] cost    cost snapshot
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t getCost(uint32_t method, StDebounceCost& cost)
+    {
+        if (method >= ST_DEBOUNCE_METHOD_COUNT)
+        {
+            return ST_ERR_PARAM;
+        }
+        Counter& c = mCost[method];
+        cost.frames = c.frames;
+        cost.totalNsec = c.totalNsec;
+        cost.lastNsec = c.lastNsec;
+        cost.avgUsec = (cost.frames > 0) ?
+            (static_cast<double>(cost.totalNsec) / static_cast<double>(cost.frames) / 1000.0) : 0.0;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Clear all cost counters
+    void resetCost()
+    {
+        for (uint32_t i = 0; i < ST_DEBOUNCE_METHOD_COUNT; i++)
+        {
+            mCost[i].frames = 0;
+            mCost[i].totalNsec = 0;
+            mCost[i].lastNsec = 0;
+        }
+    }
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_DEBOUNCE_H
@@ -0,0 +1,273 @@
+//*******************************************************************
+/// @file st_dict_cache.h
+/// Sydor binary data dictionary cache
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// A client loads the server's data dictionary each time it connects:
+/// it receives the JSON document and parses every parameter, alias and
+/// telemetry definition. The dictionary rarely changes, so an IOC
+/// restart repeats the same work.
+///
+/// StDataStore::saveBinary() writes a parsed dictionary to a compact
+/// binary snapshot, one file per dictionary version and date
+/// (makeDictCachePath()). StDataStore::loadBinary() maps a snapshot
+/// (STUTIL::MapFile) and rebuilds the data store from it without the
+/// JSON parse. It only accepts a snapshot of the expected version and
+/// date, so the caller must know which dictionary it wants.
+///
+/// Snapshot layout (host byte order, only read on the host that wrote it):
+///
+///     StDictCacheHeader
+///     payload:
+///         dictionary version, date, min/max FPGA and supervisor versions
+///         dictionary JSON text
+///         aliases (id, definition, protected)
+///         parameters (StParameter::toBinary())
+///         telemetry parameters (StParameter::toBinary())
+///
+/// Strings are a uint32_t length followed by the bytes. The header holds
+/// the payload size and an FNV-1a 64-bit checksum, so a truncated or
+/// damaged file is rejected and the caller falls back to the JSON.
+///
+/// @note StClientInterface::openConnection() is in the prebuilt client
+/// library. It still fetches and parses the JSON on every connect and
+/// never calls loadBinary(), so the driver's connect time is unchanged.
+///
+//*******************************************************************
+#ifndef ST_DICT_CACHE_H
+#define ST_DICT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include "st_errors.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_DICT_CACHE_MAGIC      = 0x43445453;   ///< 'STDC'
+const uint32_t ST_DICT_CACHE_FORMAT     = 1;            ///< Snapshot format version
+const uint32_t ST_DICT_CACHE_MAX_DIMENSION = 1u << 20;  ///< Largest parameter dimension accepted
+
+#define ST_DICT_CACHE_DIR_ENV   "ST_DICT_CACHE_DIR"     ///< Default cache directory variable
+#define ST_DICT_CACHE_PREFIX    "st_dict_"              ///< Snapshot file name prefix
+#define ST_DICT_CACHE_EXT       ".bin"                  ///< Snapshot file name extension
+
+//******************************************************************
+// Data structures
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Snapshot file header
+struct StDictCacheHeader
+{
+    uint32_t magic;             ///< ST_DICT_CACHE_MAGIC
+    uint32_t format;            ///< ST_DICT_CACHE_FORMAT
+    uint32_t headerBytes;       ///< sizeof(StDictCacheHeader)
+    uint32_t dictVersion;       ///< Dictionary version
+    uint64_t payloadBytes;      ///< Payload size following the header
+    uint64_t checksum;          ///< FNV-1a 64 of the payload
+    uint32_t paramCount;        ///< Number of parameters
+    uint32_t aliasCount;        ///< Number of aliases
+    uint32_t telemCount;        ///< Number of telemetry parameters
+    uint32_t rsvd;              ///< Reserved (0)
+};
+
+static_assert(sizeof(StDictCacheHeader) == 48, "StDictCacheHeader must be 48 bytes");
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Snapshot payload writer
+class StDictWriter
+{
+private:
+    std::string mBuf;           ///< Payload bytes
+
+public:
+    //----------------------------------------------
+    /// Append a number (arithmetic types only)
+    template<typename T>
+    void put(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value, "StDictWriter::put() needs an arithmetic type");
+        mBuf.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    //----------------------------------------------
+    /// Append a string
+    void putStr(const std::string& str)
+    {
+        put<uint32_t>(static_cast<uint32_t>(str.size()));
+        mBuf.append(str);
+    }
+
+    //----------------------------------------------
+    /// Append a list of strings
+    void putStrs(const std::vector<std::string>& strs)
+    {
+        put<uint32_t>(static_cast<uint32_t>(strs.size()));
+        for (const std::string& str : strs)
+        {
+            putStr(str);
+        }
+    }
+
+    const std::string& getBuffer(void) const { return mBuf; }   ///< Payload bytes
+    void reserve(size_t bytes) { mBuf.reserve(bytes); }         ///< Reserve payload space
+};
+
+//------------------------------------------------------------------
+/// Bounds-checked snapshot payload reader
+///
+/// A read past the end of the payload sets the reader's failed state
+/// and returns zero or empty values. Check isOk() once at the end.
+///
+class StDictReader
+{
+private:
+    const uint8_t* mpCur;       ///< Next byte
+    const uint8_t* mpEnd;       ///< End of the payload
+    bool mOk;                   ///< false once a read failed
+
+    //----------------------------------------------
+    /// Check that bytes remain, else fail
+    bool have(size_t bytes)
+    {
+        if (mOk && (static_cast<size_t>(mpEnd - mpCur) >= bytes))
+        {
+            return true;
+        }
+        mOk = false;
+        return false;
+    }
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StDictReader(const uint8_t* pData, size_t bytes)
+        : mpCur(pData), mpEnd(pData + bytes), mOk(nullptr != pData)
+    {
+    }
+
+    //----------------------------------------------
+    /// Read a number (arithmetic types only)
+    template<typename T>
+    T get(void)
+    {
+        static_assert(std::is_arithmetic<T>::value, "StDictReader::get() needs an arithmetic type");
+        T value = T();
+        if (have(sizeof(T)))
+        {
+            memcpy(&value, mpCur, sizeof(T));
+            mpCur += sizeof(T);
+        }
+        return value;
+    }
+
+    //----------------------------------------------
+    /// Read a string
+    std::string getStr(void)
+    {
+        uint32_t len = get<uint32_t>();
+        if (!have(len))
+        {
+            return std::string();
+        }
+        std::string str(reinterpret_cast<const char*>(mpCur), len);
+        mpCur += len;
+        return str;
+    }
+
+    //----------------------------------------------
+    /// Read a list of strings
+    std::vector<std::string> getStrs(void)
+    {
+        std::vector<std::string> strs;
+        uint32_t count = get<uint32_t>();
+        // Each string takes at least its length word
+        if (have(static_cast<size_t>(count) * sizeof(uint32_t)))
+        {
+            strs.reserve(count);
+            for (uint32_t i = 0; mOk && (i < count); i++)
+            {
+                strs.push_back(getStr());
+            }
+        }
+        return strs;
+    }
+
+    bool isOk(void) const { return mOk; }                       ///< No read failed
+    bool atEnd(void) const { return mOk && (mpCur == mpEnd); }  ///< All bytes were read
+};
+
+//------------------------------------------------------------------
+/// Snapshot checksum (FNV-1a 64)
+inline uint64_t stDictChecksum(const void* pData, size_t bytes)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(pData);
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+//------------------------------------------------------------------
+/// Get the snapshot path for a dictionary version and date
+///
+/// Characters of the date that are not safe in a file name are
+/// replaced with '_'. The header holds the exact version, and the
+/// payload the exact date, so a name collision only costs a cache miss.
+///
+/// @param[in] dir          cache directory
+/// @param[in] version      dictionary version
+/// @param[in] date         dictionary date
+///
+/// @return snapshot file path, or "" if dir is empty
+///
+inline std::string makeDictCachePath(const std::string& dir, uint32_t version, const std::string& date)
+{
+    if (dir.empty())
+    {
+        return std::string();
+    }
+    std::string name = ST_DICT_CACHE_PREFIX + std::to_string(version) + "_";
+    for (char c : date)
+    {
+        bool safe = ((c >= '0') && (c <= '9')) || ((c >= 'A') && (c <= 'Z')) ||
+                    ((c >= 'a') && (c <= 'z')) || ('-' == c);
+        name += safe ? c : '_';
+    }
+    char last = dir[dir.size() - 1];
+    return dir + ((('/' == last) || ('\\' == last)) ? "" : "/") + name + ST_DICT_CACHE_EXT;
+}
+
+//------------------------------------------------------------------
+/// Get the default cache directory ($ST_DICT_CACHE_DIR, or "" = no cache)
+inline std::string getDefaultDictCacheDir(void)
+{
+    const char* pDir = getenv(ST_DICT_CACHE_DIR_ENV);
+    return (nullptr == pDir) ? std::string() : std::string(pDir);
+}
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_DICT_CACHE_H
@@ -0,0 +1,576 @@
+//*******************************************************************
+/// @file st_frame_cache.h
+/// Sydor Server Interface run frame cache
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// Replay and review clients read the same run frames again and again,
+/// often several clients at once. Without a cache every GetRunFrame goes
+/// back to ResponseHandler::getRunFrame() and the disk.
+///
+/// StFrameCache keeps loaded (and type converted) frames keyed by
+/// (set, run, frame number, data type). It evicts the least recently
+/// used frames to stay within a byte budget, counted from the frame
+/// buffer sizes. A response handler puts it in front of its own frame
+/// reader (StSimResponseHandler::getRunFrame() does); the cache only
+/// calls the loader it is given.
+///
+/// Read-ahead: each (set, run, data type) stream tracks its last frame.
+/// After ST_FRAME_CACHE_SEQ_TRIGGER requests in a row for consecutive
+/// frames, the next readAheadDepth frames are queued for a background
+/// loader thread. If a request arrives for a frame that is still being
+/// loaded, it waits for that load and does not read the frame twice.
+/// Read-ahead stops at the first frame the loader cannot read (the end
+/// of the run).
+///
+/// Hit, miss, eviction and read-ahead counts are kept for tuning.
+///
+/// @note The production response handler is prebuilt and does not use
+/// the cache. Its GetRunFrame requests still go to disk every time.
+///
+//*******************************************************************
+#ifndef ST_FRAME_CACHE_H
+#define ST_FRAME_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <list>
+#include <map>
+#include <set>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const size_t   ST_FRAME_CACHE_DEFAULT_BYTES = 256 * 1024 * 1024;   ///< Default byte budget
+const uint32_t ST_FRAME_CACHE_DEFAULT_AHEAD = 8;        ///< Default read-ahead depth (frames)
+const uint32_t ST_FRAME_CACHE_MAX_AHEAD     = 256;      ///< Max read-ahead depth (frames)
+const uint32_t ST_FRAME_CACHE_SEQ_TRIGGER   = 2;        ///< Consecutive requests that start read-ahead
+const uint32_t ST_FRAME_CACHE_MAX_STREAMS   = 64;       ///< Streams tracked for read-ahead
+const size_t   ST_FRAME_CACHE_ENTRY_BYTES   = 128;      ///< Bookkeeping bytes charged per frame
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Cache key
+struct StFrameCacheKey
+{
+    std::string setName;        ///< Capture set
+    std::string runName;        ///< Capture run
+    uint32_t frameNumber;       ///< Frame in the run
+    STDataType dataType;        ///< Requested pixel type (DT_ANY = as stored)
+
+    StFrameCacheKey() : frameNumber(0), dataType(DT_ANY) {}
+    StFrameCacheKey(const std::string& set, const std::string& run, uint32_t frame, STDataType type)
+        : setName(set), runName(run), frameNumber(frame), dataType(type)
+    {
+    }
+
+    bool operator<(const StFrameCacheKey& rhs) const
+    {
+        if (frameNumber != rhs.frameNumber) return frameNumber < rhs.frameNumber;
+        if (dataType != rhs.dataType) return dataType < rhs.dataType;
+        if (runName != rhs.runName) return runName < rhs.runName;
+        return setName < rhs.setName;
+    }
+};
+
+//----------------------------------------------
+/// Cache statistics
+struct StFrameCacheStats
+{
+    uint64_t hits;              ///< Requests served from the cache
+    uint64_t misses;            ///< Requests that loaded the frame
+    uint64_t waits;             ///< Requests that waited for an in-progress load
+    uint64_t evictions;         ///< Frames evicted to stay within budget
+    uint64_t prefetched;        ///< Frames loaded by read-ahead
+    uint64_t prefetchHits;      ///< Requests served by a read-ahead frame
+    uint64_t loadErrors;        ///< Loader errors
+    size_t bytes;               ///< Bytes held
+    size_t maxBytes;            ///< Byte budget
+    uint32_t frames;            ///< Frames held
+
+    StFrameCacheStats()
+        : hits(0), misses(0), waits(0), evictions(0), prefetched(0), prefetchHits(0),
+          loadErrors(0), bytes(0), maxBytes(0), frames(0)
+    {
+    }
+};
+
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// StFrameCacheT class
+///
+/// FrameT is the cached frame type (StFrameBuffer for StFrameCache). It
+/// must be default constructible and copy assignable, and provide
+/// getFrameBytes().
+///
+template<typename FrameT>
+class StFrameCacheT
+{
+public:
+    /// Frame loader. Fills frame with the keyed frame; returns 0 if ok.
+    typedef std::function<int32_t(const StFrameCacheKey& key, FrameT& frame)> Loader;
+
+private:
+    typedef std::shared_ptr<FrameT> FramePtr;
+
+    //----------------------------------------------
+    /// Cached frame
+    struct Entry
+    {
+        StFrameCacheKey key;        ///< Key
+        FramePtr pFrame;            ///< Frame
+        size_t bytes;               ///< Bytes charged
+        bool prefetched;            ///< Loaded by read-ahead and not yet requested
+    };
+    typedef std::list<Entry> LruList;
+
+    //----------------------------------------------
+    /// Sequential access state of one (set, run, type) stream
+    struct Stream
+    {
+        uint32_t lastFrame;         ///< Last requested frame
+        uint32_t seqCount;          ///< Consecutive sequential requests
+        uint32_t aheadUntil;        ///< Read-ahead queued up to (exclusive)
+        uint32_t endFrame;          ///< First frame that failed to load (UINT32_MAX if unknown)
+        uint64_t lastUse;           ///< Access counter value at last request
+    };
+
+    Loader mLoader;                 ///< Frame loader
+    std::mutex mMutex;                          ///< Protects everything below
+    std::condition_variable mLoadCond;          ///< Signals a finished load
+    std::condition_variable mAheadCond;         ///< Wakes the read-ahead thread
+    LruList mLru;                               ///< Frames, most recently used first
+    std::map<StFrameCacheKey, typename LruList::iterator> mIndex;   ///< Key to frame
+    std::set<StFrameCacheKey> mLoading;         ///< Loads in progress
+    std::deque<StFrameCacheKey> mAheadQueue;    ///< Read-ahead requests
+    std::map<StFrameCacheKey, Stream> mStreams; ///< Streams (frameNumber of key unused)
+    std::thread mAheadThread;                   ///< Read-ahead thread (started on first use)
+    bool mStop;                                 ///< Read-ahead thread stop request
+    size_t mMaxBytes;                           ///< Byte budget
+    uint32_t mAheadDepth;                       ///< Read-ahead depth (0 = off)
+    uint64_t mAccessCount;                      ///< Request counter
+    uint64_t mGeneration;                       ///< Incremented by invalidate() and clear()
+    StFrameCacheStats mStats;                   ///< Statistics
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    ///
+    /// @param[in] loader       frame loader, called without the cache lock
+    ///
+    explicit StFrameCacheT(const Loader& loader = Loader())
+        : mLoader(loader)
+        , mStop(false)
+        , mMaxBytes(ST_FRAME_CACHE_DEFAULT_BYTES)
+        , mAheadDepth(ST_FRAME_CACHE_DEFAULT_AHEAD)
+        , mAccessCount(0)
+        , mGeneration(0)
+    {
+    }
+
+    //----------------------------------------------
+    /// Destructor - stops the read-ahead thread
+    ~StFrameCacheT()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+            mAheadQueue.clear();
+        }
+        mAheadCond.notify_all();
+        if (mAheadThread.joinable())
+        {
+            mAheadThread.join();
+        }
+    }
+
+    StFrameCacheT(const StFrameCacheT&) = delete;
+    StFrameCacheT& operator=(const StFrameCacheT&) = delete;
+
+    //----------------------------------------------
+    /// Set the frame loader (before first use)
+    void setLoader(const Loader& loader)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLoader = loader;
+    }
+
+    //----------------------------------------------
+    /// Set the byte budget and read-ahead depth
+    ///
+    /// @param[in] maxBytes     byte budget (0 disables caching)
+    /// @param[in] aheadDepth   frames to read ahead (0 disables read-ahead)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t setLimits(size_t maxBytes, uint32_t aheadDepth)
+    {
+        if (aheadDepth > ST_FRAME_CACHE_MAX_AHEAD)
+        {
+            return ST_ERR_PARAM;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        mMaxBytes = maxBytes;
+        mAheadDepth = aheadDepth;
+        if (0 == mAheadDepth)
+        {
+            mAheadQueue.clear();
+        }
+        evict(0);
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Get a frame, from the cache or the loader
+    ///
+    /// @param[in]  key     frame key
+    /// @param[out] dest    copy of the frame
+    ///
+    /// @return 0 if ok, else the loader error code
+    ///
+    int32_t get(const StFrameCacheKey& key, FrameT& dest)
+    {
+        FramePtr pFrame;
+        uint64_t generation;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            noteAccess(key);
+
+            bool waited = false;
+            while (mLoading.count(key))
+            {
+                waited = true;
+                mLoadCond.wait(lock);
+            }
+            if (waited)
+            {
+                mStats.waits++;
+            }
+
+            typename std::map<StFrameCacheKey, typename LruList::iterator>::iterator it = mIndex.find(key);
+            if (mIndex.end() != it)
+            {
+                mLru.splice(mLru.begin(), mLru, it->second);
+                Entry& entry = *it->second;
+                mStats.hits++;
+                if (entry.prefetched)
+                {
+                    mStats.prefetchHits++;
+                    entry.prefetched = false;
+                }
+                pFrame = entry.pFrame;
+            }
+            else
+            {
+                mStats.misses++;
+                mLoading.insert(key);
+            }
+            generation = mGeneration;
+        }
+
+        if (pFrame)
+        {
+            dest = *pFrame;
+            return ST_ERR_OK;
+        }
+
+        pFrame = std::make_shared<FrameT>();
+        int32_t rtn = load(key, *pFrame);
+        if (0 == rtn)
+        {
+            dest = *pFrame;
+        }
+        finishLoad(key, pFrame, rtn, false, generation);
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Drop every cached frame of a run (e.g. after it was rewritten)
+    void invalidate(const std::string& setName, const std::string& runName)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mGeneration++;
+        for (typename LruList::iterator it = mLru.begin(); it != mLru.end();)
+        {
+            if ((it->key.setName == setName) && (it->key.runName == runName))
+            {
+                mStats.bytes -= it->bytes;
+                mIndex.erase(it->key);
+                it = mLru.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+        for (std::deque<StFrameCacheKey>::iterator it = mAheadQueue.begin(); it != mAheadQueue.end();)
+        {
+            bool match = (it->setName == setName) && (it->runName == runName);
+            it = match ? mAheadQueue.erase(it) : (it + 1);
+        }
+        for (typename std::map<StFrameCacheKey, Stream>::iterator it = mStreams.begin(); it != mStreams.end();)
+        {
+            bool match = (it->first.setName == setName) && (it->first.runName == runName);
+            it = match ? mStreams.erase(it) : std::next(it);
+        }
+    }
+
+    //----------------------------------------------
+    /// Drop every cached frame
+    void clear(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mGeneration++;
+        mLru.clear();
+        mIndex.clear();
+        mAheadQueue.clear();
+        mStreams.clear();
+        mStats.bytes = 0;
+    }
+
+    //----------------------------------------------
+    /// Get the statistics
+    void getStats(StFrameCacheStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        stats = mStats;
+        stats.maxBytes = mMaxBytes;
+        stats.frames = static_cast<uint32_t>(mLru.size());
+    }
+
+    //----------------------------------------------
+    /// Reset the counters (bytes and frames held are kept)
+    void resetStats(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t bytes = mStats.bytes;
+        mStats = StFrameCacheStats();
+        mStats.bytes = bytes;
+    }
+
+private:
+    //----------------------------------------------
+    // Call the loader (without the lock)
+    int32_t load(const StFrameCacheKey& key, FrameT& frame)
+    {
+        Loader loader;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            loader = mLoader;
+        }
+        if (!loader)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return loader(key, frame);
+    }
+
+    //----------------------------------------------
+    // Insert a loaded frame and wake waiters. A frame whose load
+    // started before an invalidate() or clear() is not kept.
+    void finishLoad(const StFrameCacheKey& key, const FramePtr& pFrame, int32_t rtn,
+                    bool prefetched, uint64_t generation)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLoading.erase(key);
+        if (0 != rtn)
+        {
+            mStats.loadErrors++;
+            if (prefetched)
+            {
+                // Past the end of the run: stop reading ahead on this stream
+                typename std::map<StFrameCacheKey, Stream>::iterator it = mStreams.find(streamKey(key));
+                if ((mStreams.end() != it) && (key.frameNumber < it->second.endFrame))
+                {
+                    it->second.endFrame = key.frameNumber;
+                }
+            }
+        }
+        else if ((generation == mGeneration) && (0 == mIndex.count(key)))
+        {
+            size_t bytes = pFrame->getFrameBytes() + ST_FRAME_CACHE_ENTRY_BYTES;
+            if (bytes <= mMaxBytes)
+            {
+                evict(bytes);
+                Entry entry = { key, pFrame, bytes, prefetched };
+                mLru.push_front(entry);
+                mIndex[key] = mLru.begin();
+                mStats.bytes += bytes;
+                if (prefetched)
+                {
+                    mStats.prefetched++;
+                }
+            }
+        }
+        mLoadCond.notify_all();
+    }
+
+    //----------------------------------------------
+    // Evict least recently used frames until 'incoming' more bytes
+    // fit in the budget (caller holds mMutex)
+    void evict(size_t incoming)
+    {
+        while (!mLru.empty() && ((mStats.bytes + incoming) > mMaxBytes))
+        {
+            Entry& victim = mLru.back();
+            mStats.bytes -= victim.bytes;
+            mIndex.erase(victim.key);
+            mLru.pop_back();
+            mStats.evictions++;
+        }
+    }
+
+    //----------------------------------------------
+    // Stream key: the frame key without its frame number
+    static StFrameCacheKey streamKey(const StFrameCacheKey& key)
+    {
+        return StFrameCacheKey(key.setName, key.runName, 0, key.dataType);
+    }
+
+    //----------------------------------------------
+    // Track sequential access and queue read-ahead (caller holds mMutex)
+    void noteAccess(const StFrameCacheKey& key)
+    {
+        mAccessCount++;
+        if ((0 == mAheadDepth) || (0 == mMaxBytes))
+        {
+            return;
+        }
+
+        StFrameCacheKey sk = streamKey(key);
+        typename std::map<StFrameCacheKey, Stream>::iterator it = mStreams.find(sk);
+        if (mStreams.end() == it)
+        {
+            if (mStreams.size() >= ST_FRAME_CACHE_MAX_STREAMS)
+            {
+                forgetOldestStream();
+            }
+            Stream stream = { key.frameNumber, 0, key.frameNumber + 1, UINT32_MAX, mAccessCount };
+            mStreams[sk] = stream;
+            return;
+        }
+
+        Stream& stream = it->second;
+        stream.lastUse = mAccessCount;
+        if (key.frameNumber == stream.lastFrame)
+        {
+            return;         // another client on the same frame
+        }
+        stream.seqCount = (key.frameNumber == (stream.lastFrame + 1)) ? (stream.seqCount + 1) : 0;
+        stream.lastFrame = key.frameNumber;
+        if (stream.seqCount < ST_FRAME_CACHE_SEQ_TRIGGER)
+        {
+            stream.aheadUntil = key.frameNumber + 1;
+            return;
+        }
+
+        uint32_t target = key.frameNumber + 1 + mAheadDepth;
+        if (target > stream.endFrame)
+        {
+            target = stream.endFrame;
+        }
+        if (stream.aheadUntil < (key.frameNumber + 1))
+        {
+            stream.aheadUntil = key.frameNumber + 1;
+        }
+        bool queued = false;
+        for (; stream.aheadUntil < target; stream.aheadUntil++)
+        {
+            StFrameCacheKey ahead(key.setName, key.runName, stream.aheadUntil, key.dataType);
+            if ((0 == mIndex.count(ahead)) && (0 == mLoading.count(ahead)))
+            {
+                mAheadQueue.push_back(ahead);
+                queued = true;
+            }
+        }
+        if (queued)
+        {
+            if (!mAheadThread.joinable())
+            {
+                mAheadThread = std::thread(&StFrameCacheT::aheadMain, this);
+            }
+            mAheadCond.notify_one();
+        }
+    }
+
+    //----------------------------------------------
+    // Drop the least recently used stream (caller holds mMutex)
+    void forgetOldestStream(void)
+    {
+        typename std::map<StFrameCacheKey, Stream>::iterator oldest = mStreams.begin();
+        for (typename std::map<StFrameCacheKey, Stream>::iterator it = mStreams.begin(); it != mStreams.end(); ++it)
+        {
+            if (it->second.lastUse < oldest->second.lastUse)
+            {
+                oldest = it;
+            }
+        }
+        if (mStreams.end() != oldest)
+        {
+            mStreams.erase(oldest);
+        }
+    }
+
+    //----------------------------------------------
+    // Read-ahead thread
+    void aheadMain(void)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        for (;;)
+        {
+            mAheadCond.wait(lock, [this] { return mStop || !mAheadQueue.empty(); });
+            if (mStop)
+            {
+                return;
+            }
+            StFrameCacheKey key = mAheadQueue.front();
+            mAheadQueue.pop_front();
+            if (mIndex.count(key) || mLoading.count(key))
+            {
+                continue;
+            }
+            mLoading.insert(key);
+            uint64_t generation = mGeneration;
+            lock.unlock();
+
+            FramePtr pFrame = std::make_shared<FrameT>();
+            int32_t rtn = load(key, *pFrame);
+            finishLoad(key, pFrame, rtn, true, generation);
+
+            lock.lock();
+        }
+    }
+};  // class StFrameCacheT
+
+typedef StFrameCacheT<StFrameBuffer> StFrameCache;    ///< Run frame cache
+typedef StFrameCache::Loader StFrameCacheLoader;      ///< Run frame loader
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_FRAME_CACHE_H
@@ -0,0 +1,425 @@
+//*******************************************************************
+/// @file st_frame_stats.h
+/// Sydor Server Interface per-frame summary statistics
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// A small statistics block for one frame: total counts, min/max,
+/// saturated pixel count, intensity centroid and an optional histogram.
+/// The block is stored in the frame's data3 section
+/// (ST_FRAME_STATS_SECTION), so it travels with the frame. A stored run
+/// can then be summarised by reading only that section of each frame
+/// (see StSimResponseHandler::getRunFrameStats()).
+///
+/// The helpers are computed where the frame is produced. The prebuilt
+/// server library does not call them; a response handler that wants
+/// the block calls computeFrameStats() and setFrameStats() before it
+/// stores or publishes the frame.
+///
+/// @note The production server does not compute the block during
+/// ingest, so frames from real detectors carry no statistics section.
+///
+/// Section layout: one packed StFrameStatsRecord followed by histBins
+/// uint32_t histogram counts.
+///
+//*******************************************************************
+#ifndef ST_FRAME_STATS_H
+#define ST_FRAME_STATS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+/// Statistics selection flags (StFrameStatsConfig::flags)
+const uint32_t ST_FRAME_STATS_SUM           = 0x0001;   ///< Total counts
+const uint32_t ST_FRAME_STATS_MIN_MAX       = 0x0002;   ///< Min and max pixel value
+const uint32_t ST_FRAME_STATS_SATURATED     = 0x0004;   ///< Pixels at or above the saturation level
+const uint32_t ST_FRAME_STATS_CENTROID      = 0x0008;   ///< Intensity-weighted centroid
+const uint32_t ST_FRAME_STATS_HISTOGRAM     = 0x0010;   ///< Histogram
+const uint32_t ST_FRAME_STATS_DEFAULT       = ST_FRAME_STATS_SUM | ST_FRAME_STATS_MIN_MAX |
+                                              ST_FRAME_STATS_CENTROID;
+const uint32_t ST_FRAME_STATS_ALL           = 0x001F;
+
+const uint32_t ST_FRAME_STATS_ID            = 0x53544653;   ///< Record magic: 'STFS'
+const uint16_t ST_FRAME_STATS_VERSION       = 0x0100;       ///< Record version 0xMMmm
+const uint32_t ST_FRAME_STATS_SECTION       = 3;            ///< Frame data section holding the block
+const uint32_t ST_FRAME_STATS_MAX_BINS      = 4096;         ///< Max histogram bins
+const uint32_t ST_FRAME_STATS_DEFAULT_BINS  = 256;          ///< Default histogram bins
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Statistics computed at frame ingest
+struct StFrameStatsConfig
+{
+    uint32_t flags;             ///< ST_FRAME_STATS_XXX selection (0 = none)
+    double saturationLevel;     ///< Saturation threshold (ST_FRAME_STATS_SATURATED)
+    uint32_t histBins;          ///< Histogram bin count
+    double histMin;             ///< Lower edge of the first bin
+    double histMax;             ///< Upper edge of the last bin
+
+    StFrameStatsConfig()
+        : flags(ST_FRAME_STATS_DEFAULT)
+        , saturationLevel(0.0)
+        , histBins(ST_FRAME_STATS_DEFAULT_BINS)
+        , histMin(0.0)
+        , histMax(65536.0)
+    {
+    }
+
+    //----------------------------------------------
+    /// @return 0 if ok, else ST_ERR_PARAM
+    int32_t validate(void) const
+    {
+        if (0 != (flags & ~ST_FRAME_STATS_ALL))
+        {
+            return ST_ERR_PARAM;
+        }
+        if ((0 != (flags & ST_FRAME_STATS_SATURATED)) && !(saturationLevel > 0.0))
+        {
+            return ST_ERR_PARAM;
+        }
+        if ((0 != (flags & ST_FRAME_STATS_HISTOGRAM)) &&
+            ((0 == histBins) || (histBins > ST_FRAME_STATS_MAX_BINS) || !(histMax > histMin)))
+        {
+            return ST_ERR_PARAM;
+        }
+        return ST_ERR_OK;
+    }
+};
+
+//----------------------------------------------
+/// Fixed part of the statistics section (88 bytes)
+#pragma pack(push, 1)
+struct StFrameStatsRecord
+{
+    uint32_t id;                ///< ST_FRAME_STATS_ID
+    uint16_t version;           ///< ST_FRAME_STATS_VERSION
+    uint16_t recordBytes;       ///< sizeof(StFrameStatsRecord)
+    uint32_t flags;             ///< Statistics present (ST_FRAME_STATS_XXX)
+    uint32_t frameNumber;       ///< Run frame number
+    uint32_t pixelCount;        ///< Pixels included
+    uint32_t saturatedCount;    ///< Pixels >= saturation level
+    uint32_t histBins;          ///< Histogram bins that follow the record
+    uint32_t reserved;          ///< Reserved for 8-byte alignment
+    double sum;                 ///< Total counts
+    double minValue;            ///< Min pixel value
+    double maxValue;            ///< Max pixel value
+    double centroidX;           ///< Centroid column (pixels)
+    double centroidY;           ///< Centroid row (pixels)
+    double histMin;             ///< Lower edge of the first bin
+    double histMax;             ///< Upper edge of the last bin
+};
+#pragma pack(pop)
+
+//----------------------------------------------
+/// Statistics of one frame
+struct StFrameStats
+{
+    uint32_t flags;                     ///< Statistics present (0 = none)
+    uint32_t frameNumber;               ///< Run frame number
+    uint32_t pixelCount;                ///< Pixels included
+    uint32_t saturatedCount;            ///< Pixels >= saturation level
+    double sum;                         ///< Total counts
+    double minValue;                    ///< Min pixel value
+    double maxValue;                    ///< Max pixel value
+    double centroidX;                   ///< Centroid column (pixels)
+    double centroidY;                   ///< Centroid row (pixels)
+    double histMin;                     ///< Lower edge of the first bin
+    double histMax;                     ///< Upper edge of the last bin
+    std::vector<uint32_t> histogram;    ///< Bin counts (ST_FRAME_STATS_HISTOGRAM)
+
+    StFrameStats()
+        : flags(0), frameNumber(0), pixelCount(0), saturatedCount(0)
+        , sum(0.0), minValue(0.0), maxValue(0.0), centroidX(0.0), centroidY(0.0)
+        , histMin(0.0), histMax(0.0)
+    {
+    }
+
+    //----------------------------------------------
+    /// Serialized length in bytes
+    uint32_t getBytes(void) const
+    {
+        return static_cast<uint32_t>(sizeof(StFrameStatsRecord) + (histogram.size() * sizeof(uint32_t)));
+    }
+
+    //----------------------------------------------
+    /// Serialize into a section (at least getBytes() long)
+    void toBytes(uint8_t* pDest) const
+    {
+        StFrameStatsRecord rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.id = ST_FRAME_STATS_ID;
+        rec.version = ST_FRAME_STATS_VERSION;
+        rec.recordBytes = static_cast<uint16_t>(sizeof(StFrameStatsRecord));
+        rec.flags = flags;
+        rec.frameNumber = frameNumber;
+        rec.pixelCount = pixelCount;
+        rec.saturatedCount = saturatedCount;
+        rec.histBins = static_cast<uint32_t>(histogram.size());
+        rec.sum = sum;
+        rec.minValue = minValue;
+        rec.maxValue = maxValue;
+        rec.centroidX = centroidX;
+        rec.centroidY = centroidY;
+        rec.histMin = histMin;
+        rec.histMax = histMax;
+        memcpy(pDest, &rec, sizeof(rec));
+        if (!histogram.empty())
+        {
+            memcpy(pDest + sizeof(rec), histogram.data(), histogram.size() * sizeof(uint32_t));
+        }
+    }
+
+    //----------------------------------------------
+    /// Deserialize from a section
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_AVAILABLE if the section holds no
+    ///         statistics block
+    ///
+    int32_t fromBytes(const uint8_t* pSrc, uint32_t bytes)
+    {
+        StFrameStatsRecord rec;
+        if ((nullptr == pSrc) || (bytes < sizeof(rec)))
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        memcpy(&rec, pSrc, sizeof(rec));
+        if ((ST_FRAME_STATS_ID != rec.id) || ((rec.version >> 8) != (ST_FRAME_STATS_VERSION >> 8)) ||
+            (rec.recordBytes < sizeof(rec)) || (rec.histBins > ST_FRAME_STATS_MAX_BINS) ||
+            (bytes < (rec.recordBytes + (rec.histBins * sizeof(uint32_t)))))
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        flags = rec.flags;
+        frameNumber = rec.frameNumber;
+        pixelCount = rec.pixelCount;
+        saturatedCount = rec.saturatedCount;
+        sum = rec.sum;
+        minValue = rec.minValue;
+        maxValue = rec.maxValue;
+        centroidX = rec.centroidX;
+        centroidY = rec.centroidY;
+        histMin = rec.histMin;
+        histMax = rec.histMax;
+        histogram.resize(rec.histBins);
+        if (0 != rec.histBins)
+        {
+            memcpy(histogram.data(), pSrc + rec.recordBytes, rec.histBins * sizeof(uint32_t));
+        }
+        return ST_ERR_OK;
+    }
+};
+
+//******************************************************************
+// Kernels
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Compute statistics of one image
+///
+/// Each row is scanned once per selected statistic while it is in
+/// cache; every pass is a branch-free loop. Histogram values outside
+/// [histMin, histMax) are counted in the first or last bin.
+///
+/// @param[in]  pSrc        image
+/// @param[in]  width       image width
+/// @param[in]  height      image height
+/// @param[in]  config      statistics to compute (validated)
+/// @param[out] stats       statistics (frameNumber is not set)
+///
+template<typename T>
+inline void frameStatsKernel(const T* ST_RESTRICT pSrc, uint32_t width, uint32_t height,
+                             const StFrameStatsConfig& config, StFrameStats& stats)
+{
+    const uint32_t flags = config.flags;
+    const bool doSum = (0 != (flags & (ST_FRAME_STATS_SUM | ST_FRAME_STATS_CENTROID)));
+    const bool doCentroid = (0 != (flags & ST_FRAME_STATS_CENTROID));
+    const bool doMinMax = (0 != (flags & ST_FRAME_STATS_MIN_MAX));
+    const bool doSaturated = (0 != (flags & ST_FRAME_STATS_SATURATED));
+    const bool doHistogram = (0 != (flags & ST_FRAME_STATS_HISTOGRAM));
+    const double sat = config.saturationLevel;
+    const int32_t lastBin = static_cast<int32_t>(config.histBins) - 1;
+    const double histScale = doHistogram ? (config.histBins / (config.histMax - config.histMin)) : 0.0;
+    const double histMin = config.histMin;
+
+    double sum = 0.0;
+    double momentX = 0.0;
+    double momentY = 0.0;
+    T minValue = pSrc[0];
+    T maxValue = pSrc[0];
+    uint32_t saturated = 0;
+    std::vector<uint32_t> hist(doHistogram ? config.histBins : 0, 0);
+    uint32_t* ST_RESTRICT pHist = hist.data();
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        const T* ST_RESTRICT pRow = pSrc + (static_cast<size_t>(y) * width);
+        if (doSum)
+        {
+            double rowSum = 0.0;
+            double rowMoment = 0.0;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                double v = static_cast<double>(pRow[x]);
+                rowSum += v;
+                rowMoment += v * x;
+            }
+            sum += rowSum;
+            momentX += rowMoment;
+            momentY += rowSum * y;
+        }
+        if (doMinMax)
+        {
+            T rowMin = minValue;
+            T rowMax = maxValue;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                rowMin = (pRow[x] < rowMin) ? pRow[x] : rowMin;
+                rowMax = (pRow[x] > rowMax) ? pRow[x] : rowMax;
+            }
+            minValue = rowMin;
+            maxValue = rowMax;
+        }
+        if (doSaturated)
+        {
+            uint32_t rowSat = 0;
+            for (uint32_t x = 0; x < width; x++)
+            {
+                rowSat += (static_cast<double>(pRow[x]) >= sat) ? 1 : 0;
+            }
+            saturated += rowSat;
+        }
+        if (doHistogram)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                double pos = (static_cast<double>(pRow[x]) - histMin) * histScale;
+                int32_t bin = (pos < 0.0) ? 0 : ((pos >= lastBin) ? lastBin : static_cast<int32_t>(pos));
+                pHist[bin]++;
+            }
+        }
+    }
+
+    stats.flags = flags;
+    stats.pixelCount = width * height;
+    stats.sum = (0 != (flags & ST_FRAME_STATS_SUM)) ? sum : 0.0;
+    stats.minValue = doMinMax ? static_cast<double>(minValue) : 0.0;
+    stats.maxValue = doMinMax ? static_cast<double>(maxValue) : 0.0;
+    stats.saturatedCount = saturated;
+    stats.centroidX = (doCentroid && (0.0 != sum)) ? (momentX / sum) : 0.0;
+    stats.centroidY = (doCentroid && (0.0 != sum)) ? (momentY / sum) : 0.0;
+    stats.histMin = doHistogram ? config.histMin : 0.0;
+    stats.histMax = doHistogram ? config.histMax : 0.0;
+    stats.histogram.swap(hist);
+}
+
+//------------------------------------------------------------------
+/// Statistics operation functor
+struct StFrameStatsOp
+{
+    const void* pSrc;
+    uint32_t width;
+    uint32_t height;
+    const StFrameStatsConfig* pConfig;
+    StFrameStats* pStats;
+    template<typename T> int32_t run()
+    {
+        frameStatsKernel(static_cast<const T*>(pSrc), width, height, *pConfig, *pStats);
+        return ST_ERR_OK;
+    }
+};
+
+//------------------------------------------------------------------
+/// Compute the statistics of a frame image
+///
+/// @param[in]  frame       frame
+/// @param[in]  config      statistics to compute
+/// @param[out] stats       statistics
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t computeFrameStats(StFrameBuffer& frame, const StFrameStatsConfig& config,
+                                 StFrameStats& stats)
+{
+    int32_t rtn = config.validate();
+    if (0 != rtn)
+    {
+        return rtn;
+    }
+    StFrameStatsOp op = { frame.getImagePtr(), frame.getImageWidth(), frame.getImageHeight(),
+                          &config, &stats };
+    if (nullptr == op.pSrc)
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    if ((0 == op.width) || (0 == op.height))
+    {
+        return ST_ERR_IMAGE_SIZE;
+    }
+    rtn = dispatchPixelType(frame.getPixelType(), op);
+    stats.frameNumber = frame.getFrameNumber();
+    return rtn;
+}
+
+//------------------------------------------------------------------
+/// Store a statistics block in the frame's statistics section
+///
+/// The section is resized only when its length changes, so a frame
+/// buffer reused for every frame of a run is allocated once.
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t setFrameStats(StFrameBuffer& frame, const StFrameStats& stats)
+{
+    uint32_t bytes = stats.getBytes();
+    if (frame.getData3Bytes() != STUTIL::roundUp(bytes, 4))
+    {
+        int32_t rtn = frame.resize(true, ST_SYS_NONE, 0 == frame.getTelemetryBytes(), 1, 1, 1, bytes);
+        if (0 != rtn)
+        {
+            return rtn;
+        }
+    }
+    uint8_t* pSection = frame.getData3Ptr();
+    if (nullptr == pSection)
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    memset(pSection, 0, frame.getData3Bytes());
+    stats.toBytes(pSection);
+    return ST_ERR_OK;
+}
+
+//------------------------------------------------------------------
+/// Read the statistics block from a frame
+///
+/// @return 0 if ok, ST_ERR_NOT_AVAILABLE if the frame has none
+///
+inline int32_t getFrameStats(StFrameBuffer& frame, StFrameStats& stats)
+{
+    return stats.fromBytes(frame.getData3Ptr(), frame.getData3Bytes());
+}
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_FRAME_STATS_H
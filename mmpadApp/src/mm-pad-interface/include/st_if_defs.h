@@ -221,6 +221,7 @@ const uint32_t HV_CTRL_DISABLE      = 0x0000;
 #define CUR_IMAGE_COUNT_PARAM       "Cur_Image_Count"
 #define CUR_FRAME_COUNT_PARAM       "Cur_Frame_Count"
 #define RUN_DEBUG_STATUS_PARAM      "Run_Debug_Status"
+#define DEBOUNCE_METHOD_PARAM       "Debounce_Method"   ///< StDebounceMethod (ST_ADDR_DEBOUNCE_METHOD)
 
 // The following definitions apply to the AD5391 DAC on the KECK data path boards
 #define DAC_PCR_CTRL_PARAM          "DFPGA_DAC_PCR_CTRL"
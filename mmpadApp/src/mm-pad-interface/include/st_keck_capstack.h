@@ -0,0 +1,428 @@
+//*******************************************************************
+/// @file st_keck_capstack.h
+/// Sydor KeckPAD multi-capacitor stack correction
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// A KeckPAD "image" is a stack of up to KK_MAX_CAPACITOR_COUNT
+/// capacitor frames. StKeckCapStack corrects all selected caps of a
+/// stack in ONE pass over the pixels instead of walking the stack
+/// once per cap.
+///
+/// Per-cap background and gain are stored interleaved by pixel
+/// ([pixel][cap]), so for each pixel the calibration of every cap is
+/// one contiguous, cache-line friendly run. The cap loop length is a
+/// compile-time constant (the kernel is instantiated for 1..8 caps),
+/// so the inner loop across caps is unrolled and vectorized:
+///
+///     out[c][p] = (raw[c][p] - bg[p][c]) * gain[p][c]
+///
+/// Output is either planar (one image per cap) or interleaved
+/// ([pixel][cap]). Whole stacks are tiled by pixel range across a
+/// STUTIL::WorkPool.
+///
+/// StCorrEngine::correctCapStack() picks the selected caps of a stack
+/// (the library cap_reg order) and runs them through the calibration's
+/// corrector. The cap ordinal map cap_list is not needed for this. The
+/// prebuilt StCorrections::applyCorrections() still walks a stack once
+/// per cap; KeckPAD callers must call correctCapStack() to get the
+/// single pass.
+///
+//*******************************************************************
+#ifndef ST_KECK_CAPSTACK_H
+#define ST_KECK_CAPSTACK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+#include "stutil_workpool.hpp"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_KECK_CAPSTACK_TILE_PIXELS    (16*1024)   ///< Pixels per parallel tile
+
+//******************************************************************
+// Kernels
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Correct N caps for pixels [begin, end), planar output
+///
+/// @param[in]  ppRaw   N raw cap images
+/// @param[in]  pBg     interleaved background [pixel][N]
+/// @param[in]  pGain   interleaved gain [pixel][N]
+/// @param[out] ppOut   N output images
+///
+template<uint32_t N, typename S, typename D>
+inline void keckCapStackKernel(const S* const* ppRaw, const float* ST_RESTRICT pBg,
+                               const float* ST_RESTRICT pGain, D* const* ppOut,
+                               size_t begin, size_t end)
+{
+    const S* pRaw[N];
+    D* pOut[N];
+    for (uint32_t c = 0; c < N; c++)
+    {
+        pRaw[c] = ppRaw[c];
+        pOut[c] = ppOut[c];
+    }
+    for (size_t p = begin; p < end; p++)
+    {
+        const float* ST_RESTRICT bg = pBg + p * N;
+        const float* ST_RESTRICT gain = pGain + p * N;
+        float v[N];
+        for (uint32_t c = 0; c < N; c++)
+        {
+            v[c] = (static_cast<float>(pRaw[c][p]) - bg[c]) * gain[c];
+        }
+        for (uint32_t c = 0; c < N; c++)
+        {
+            pOut[c][p] = static_cast<D>(v[c]);
+        }
+    }
+}
+
+//------------------------------------------------------------------
+/// Correct N caps for pixels [begin, end), interleaved output [pixel][N]
+template<uint32_t N, typename S, typename D>
+inline void keckCapStackInterleavedKernel(const S* const* ppRaw, const float* ST_RESTRICT pBg,
+                                          const float* ST_RESTRICT pGain, D* ST_RESTRICT pOut,
+                                          size_t begin, size_t end)
+{
+    const S* pRaw[N];
+    for (uint32_t c = 0; c < N; c++)
+    {
+        pRaw[c] = ppRaw[c];
+    }
+    for (size_t p = begin; p < end; p++)
+    {
+        const float* ST_RESTRICT bg = pBg + p * N;
+        const float* ST_RESTRICT gain = pGain + p * N;
+        D* ST_RESTRICT out = pOut + p * N;
+        for (uint32_t c = 0; c < N; c++)
+        {
+            out[c] = static_cast<D>((static_cast<float>(pRaw[c][p]) - bg[c]) * gain[c]);
+        }
+    }
+}
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// KeckPAD capacitor stack corrector
+class StKeckCapStack
+{
+private:
+    uint32_t mCapCount;             ///< Caps per stack (interleave factor)
+    uint32_t mPixels;               ///< Pixels per cap image
+    std::vector<float> mBg;         ///< Background [pixel][cap]
+    std::vector<float> mGain;       ///< Gain [pixel][cap]
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StKeckCapStack() : mCapCount(0), mPixels(0) {}
+
+    //----------------------------------------------
+    /// Size the calibration tables. Background is reset to 0, gain to 1.
+    ///
+    /// @param[in] capCount     number of selected caps (1..KK_MAX_CAPACITOR_COUNT)
+    /// @param[in] pixels       pixels per cap image
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t init(uint32_t capCount, uint32_t pixels = KK_RAW_IMAGE_PIXELS)
+    {
+        if ((0 == capCount) || (capCount > KK_MAX_CAPACITOR_COUNT))
+        {
+            return ST_ERR_CAP_COUNT;
+        }
+        if (0 == pixels)
+        {
+            return ST_ERR_DIMENSION;
+        }
+        mCapCount = capCount;
+        mPixels = pixels;
+        mBg.assign(static_cast<size_t>(capCount) * pixels, 0.0f);
+        mGain.assign(static_cast<size_t>(capCount) * pixels, 1.0f);
+        return ST_ERR_OK;
+    }
+
+    uint32_t getCapCount() const { return mCapCount; }    ///< Caps per stack
+    uint32_t getPixels() const   { return mPixels; }      ///< Pixels per cap
+
+    //----------------------------------------------
+    /// Load the background of one cap from a frame
+    ///
+    /// @param[in] capIndex     ordinal of the cap in the stack (0..capCount-1)
+    /// @param[in] bgFrame      background image, any numeric pixel type
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t setCapBackground(uint32_t capIndex, StFrameBuffer& bgFrame)
+    {
+        return loadCapTable(mBg, capIndex, bgFrame);
+    }
+
+    //----------------------------------------------
+    /// Set a uniform background for one cap
+    int32_t setCapBackground(uint32_t capIndex, float bg)
+    {
+        return fillCapTable(mBg, capIndex, bg);
+    }
+
+    //----------------------------------------------
+    /// Load the per-pixel gain of one cap from a frame
+    int32_t setCapGain(uint32_t capIndex, StFrameBuffer& gainFrame)
+    {
+        return loadCapTable(mGain, capIndex, gainFrame);
+    }
+
+    //----------------------------------------------
+    /// Set a uniform gain for one cap
+    int32_t setCapGain(uint32_t capIndex, float gain)
+    {
+        return fillCapTable(mGain, capIndex, gain);
+    }
+
+    //----------------------------------------------
+    /// Correct a cap stack into planar per-cap outputs
+    ///
+    /// @param[in]  ppRaw   getCapCount() raw images of S pixels
+    /// @param[out] ppOut   getCapCount() output images of D pixels
+    /// @param[in]  begin   first pixel
+    /// @param[in]  end     one past the last pixel (0 = all)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    template<typename S, typename D>
+    int32_t process(const S* const* ppRaw, D* const* ppOut, size_t begin = 0, size_t end = 0) const
+    {
+        if ((nullptr == ppRaw) || (nullptr == ppOut))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if (0 == end)
+        {
+            end = mPixels;
+        }
+        if ((begin > end) || (end > mPixels))
+        {
+            return ST_ERR_INDEX;
+        }
+        const float* pBg = mBg.data();
+        const float* pGain = mGain.data();
+        switch (mCapCount)
+        {
+            case 1: keckCapStackKernel<1>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 2: keckCapStackKernel<2>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 3: keckCapStackKernel<3>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 4: keckCapStackKernel<4>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 5: keckCapStackKernel<5>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 6: keckCapStackKernel<6>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 7: keckCapStackKernel<7>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            case 8: keckCapStackKernel<8>(ppRaw, pBg, pGain, ppOut, begin, end); break;
+            default: return ST_ERR_CAP_COUNT;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Correct a cap stack into one interleaved [pixel][cap] output
+    ///
+    /// @param[in]  ppRaw   getCapCount() raw images of S pixels
+    /// @param[out] pOut    getPixels() * getCapCount() D values
+    /// @param[in]  begin   first pixel
+    /// @param[in]  end     one past the last pixel (0 = all)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    template<typename S, typename D>
+    int32_t processInterleaved(const S* const* ppRaw, D* pOut, size_t begin = 0, size_t end = 0) const
+    {
+        if ((nullptr == ppRaw) || (nullptr == pOut))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if (0 == end)
+        {
+            end = mPixels;
+        }
+        if ((begin > end) || (end > mPixels))
+        {
+            return ST_ERR_INDEX;
+        }
+        const float* pBg = mBg.data();
+        const float* pGain = mGain.data();
+        switch (mCapCount)
+        {
+            case 1: keckCapStackInterleavedKernel<1>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 2: keckCapStackInterleavedKernel<2>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 3: keckCapStackInterleavedKernel<3>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 4: keckCapStackInterleavedKernel<4>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 5: keckCapStackInterleavedKernel<5>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 6: keckCapStackInterleavedKernel<6>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 7: keckCapStackInterleavedKernel<7>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            case 8: keckCapStackInterleavedKernel<8>(ppRaw, pBg, pGain, pOut, begin, end); break;
+            default: return ST_ERR_CAP_COUNT;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Correct a whole cap stack into planar per-cap outputs, tiled
+    /// by pixel range across a worker pool
+    ///
+    /// @param[in]  ppRaw   getCapCount() raw images of S pixels
+    /// @param[out] ppOut   getCapCount() output images of D pixels
+    /// @param[in]  pPool   worker pool (nullptr = calling thread only)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    template<typename S, typename D>
+    int32_t processParallel(const S* const* ppRaw, D* const* ppOut, STUTIL::WorkPool* pPool) const
+    {
+        if (nullptr == pPool)
+        {
+            return process(ppRaw, ppOut);
+        }
+        if ((nullptr == ppRaw) || (nullptr == ppOut))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        if ((0 == mCapCount) || (mCapCount > KK_MAX_CAPACITOR_COUNT))
+        {
+            return ST_ERR_CAP_COUNT;
+        }
+        const StKeckCapStack* pStack = this;
+        pPool->parallelFor(mPixels, ST_KECK_CAPSTACK_TILE_PIXELS,
+            [pStack, ppRaw, ppOut](size_t begin, size_t end) { pStack->process(ppRaw, ppOut, begin, end); });
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Correct a stack of KeckPAD frames into planar output frames
+    ///
+    /// @param[in]  rawFrames   getCapCount() raw cap frames (KKRawPixel)
+    /// @param[out] outFrames   getCapCount() output frames, DT_FLOAT or DT_DOUBLE,
+    ///                         all of the same pixel type
+    /// @param[in]  pPool       optional worker pool
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t processFrames(std::vector<StFrameBuffer*>& rawFrames,
+                          std::vector<StFrameBuffer*>& outFrames,
+                          STUTIL::WorkPool* pPool = nullptr) const
+    {
+        if ((rawFrames.size() != mCapCount) || (outFrames.size() != mCapCount))
+        {
+            return ST_ERR_CAP_COUNT;
+        }
+        const KKRawPixel* ppRaw[KK_MAX_CAPACITOR_COUNT];
+        void* ppOut[KK_MAX_CAPACITOR_COUNT];
+        STDataType outType = outFrames[0]->getPixelType();
+        for (uint32_t c = 0; c < mCapCount; c++)
+        {
+            if ((rawFrames[c]->getImagePixelCount() != mPixels) ||
+                (outFrames[c]->getImagePixelCount() != mPixels))
+            {
+                return ST_ERR_IMAGE_SIZE;
+            }
+            if ((rawFrames[c]->getPixelBytes() != sizeof(KKRawPixel)) ||
+                (outFrames[c]->getPixelType() != outType))
+            {
+                return ST_ERR_DATA_TYPE;
+            }
+            ppRaw[c] = reinterpret_cast<const KKRawPixel*>(rawFrames[c]->getImagePtr());
+            ppOut[c] = outFrames[c]->getImagePtr();
+            if ((nullptr == ppRaw[c]) || (nullptr == ppOut[c]))
+            {
+                return ST_ERR_NULL_PTR;
+            }
+        }
+        if (DT_FLOAT == outType)
+        {
+            return processParallel(ppRaw, reinterpret_cast<float* const*>(ppOut), pPool);
+        }
+        if (DT_DOUBLE == outType)
+        {
+            return processParallel(ppRaw, reinterpret_cast<double* const*>(ppOut), pPool);
+        }
+        return ST_ERR_DATA_TYPE;
+    }
+
+private:
+    //----------------------------------------------
+    // Dispatch functor: copy one cap image into an interleaved table
+    struct LoadOp
+    {
+        float* pTable;
+        const void* pSrc;
+        uint32_t capIndex;
+        uint32_t capCount;
+        uint32_t pixels;
+        template<typename T> int32_t run()
+        {
+            const T* pS = static_cast<const T*>(pSrc);
+            for (size_t p = 0; p < pixels; p++)
+            {
+                pTable[p * capCount + capIndex] = static_cast<float>(pS[p]);
+            }
+            return ST_ERR_OK;
+        }
+    };
+
+    //----------------------------------------------
+    /// Set one cap of an interleaved table to a uniform value
+    int32_t fillCapTable(std::vector<float>& table, uint32_t capIndex, float value)
+    {
+        if (capIndex >= mCapCount)
+        {
+            return ST_ERR_INDEX;
+        }
+        for (size_t p = 0; p < mPixels; p++)
+        {
+            table[p * mCapCount + capIndex] = value;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Copy one cap image into an interleaved table
+    int32_t loadCapTable(std::vector<float>& table, uint32_t capIndex, StFrameBuffer& frame)
+    {
+        if (capIndex >= mCapCount)
+        {
+            return ST_ERR_INDEX;
+        }
+        if (frame.getImagePixelCount() != mPixels)
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        LoadOp op = { table.data(), frame.getImagePtr(), capIndex, mCapCount, mPixels };
+        if (nullptr == op.pSrc)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return dispatchPixelType(frame.getPixelType(), op);
+    }
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_KECK_CAPSTACK_H
@@ -0,0 +1,373 @@
+//*******************************************************************
+/// @file st_mm_decode.h
+/// Sydor MM-PAD calibrated digital/analog pixel decode
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// An MM-PAD raw pixel (MXRawPixel) packs a digital overflow count in
+/// its upper bits above an analog residual in its low analogBits bits.
+/// StMmDecode turns raw pixels into calibrated photon-equivalent values
+/// with three per-pixel tables:
+///
+///     out[i] = (analog[i] - pedestal[i]) * gain[i] + digital[i] * overflowScale[i]
+///
+/// The decode is one streaming pass: each pixel reads the raw word and
+/// the three table entries, and writes one output value. The loop is
+/// branch free with restrict-qualified planar tables, so the compiler
+/// emits packed SIMD integer unpack and float multiply-add for it. It
+/// tiles across a STUTIL::WorkPool.
+///
+/// Calibration file format (native byte order):
+///
+///     StMmDecodeFileHeader                 64 bytes
+///     float pedestal[width * height]
+///     float gain[width * height]
+///     float overflowScale[width * height]
+///
+/// The file is memory mapped, so tables are used in place with no copy
+/// and are shared between processes that load the same file.
+///
+//*******************************************************************
+#ifndef ST_MM_DECODE_H
+#define ST_MM_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+#include "stutil_mapfile.hpp"
+#include "stutil_workpool.hpp"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_MM_DECODE_MAGIC          0x43444D4D  ///< "MMDC"
+#define ST_MM_DECODE_VERSION        1           ///< Calibration file version
+#define ST_MM_DECODE_ANALOG_BITS    14          ///< Default analog residual width
+#define ST_MM_DECODE_TILE_PIXELS    (64*1024)   ///< Pixels per parallel tile
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Decode calibration file header
+#pragma pack(push, 1)
+struct StMmDecodeFileHeader
+{
+    uint32_t magic;         ///< ST_MM_DECODE_MAGIC
+    uint32_t version;       ///< ST_MM_DECODE_VERSION
+    uint32_t width;         ///< Image width in pixels
+    uint32_t height;        ///< Image height in pixels
+    uint32_t analogBits;    ///< Width of the analog residual field
+    uint32_t reserved[11];  ///< 0 (pads the tables to a 64 byte boundary)
+};
+#pragma pack(pop)
+
+//******************************************************************
+// Kernels
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Decode a run of raw pixels
+///
+/// @param[in]  pRaw        raw pixels
+/// @param[in]  pPedestal   per-pixel analog pedestal
+/// @param[in]  pGain       per-pixel analog gain
+/// @param[in]  pScale      per-pixel value of one digital overflow count
+/// @param[out] pOut        calibrated pixels
+/// @param[in]  count       pixels to decode
+/// @param[in]  analogBits  width of the analog residual field
+///
+template<typename R, typename D>
+inline void mmDecodeKernel(const R* ST_RESTRICT pRaw,
+                           const float* ST_RESTRICT pPedestal,
+                           const float* ST_RESTRICT pGain,
+                           const float* ST_RESTRICT pScale,
+                           D* ST_RESTRICT pOut, size_t count, uint32_t analogBits)
+{
+    typedef typename StPixelCalcType<float, D>::type CalcT;
+    const uint32_t mask = (1u << analogBits) - 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t raw = static_cast<uint32_t>(pRaw[i]);
+        CalcT analog = static_cast<CalcT>(static_cast<int32_t>(raw & mask));
+        CalcT digital = static_cast<CalcT>(static_cast<int32_t>(raw >> analogBits));
+        pOut[i] = static_cast<D>((analog - pPedestal[i]) * pGain[i] + digital * pScale[i]);
+    }
+}
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Calibrated MM-PAD decode stage
+class StMmDecode
+{
+private:
+    STUTIL::MapFile mFile;          ///< Mapped calibration file
+    std::vector<float> mTables;     ///< Tables set with setTables()
+    const float* mpPedestal;        ///< Pedestal table
+    const float* mpGain;            ///< Gain table
+    const float* mpScale;           ///< Overflow scale table
+    uint32_t mWidth;                ///< Image width
+    uint32_t mHeight;               ///< Image height
+    uint32_t mAnalogBits;           ///< Analog residual width
+
+public:
+    //----------------------------------------------
+    /// Constructor - creates an empty decoder
+    StMmDecode()
+        : mpPedestal(nullptr), mpGain(nullptr), mpScale(nullptr),
+          mWidth(0), mHeight(0), mAnalogBits(ST_MM_DECODE_ANALOG_BITS)
+    {
+    }
+
+    StMmDecode(const StMmDecode&) = delete;
+    StMmDecode& operator=(const StMmDecode&) = delete;
+
+    //----------------------------------------------
+    /// Map a calibration file and use its tables in place
+    ///
+    /// @param[in] path     calibration file
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t load(const std::string& path)
+    {
+        clear();
+        int32_t rtn = mFile.open(path);
+        if (0 != rtn)
+        {
+            return rtn;
+        }
+        if (mFile.size() < sizeof(StMmDecodeFileHeader))
+        {
+            clear();
+            return ST_ERR_FILE_READ;
+        }
+        const StMmDecodeFileHeader* pHdr = reinterpret_cast<const StMmDecodeFileHeader*>(mFile.data());
+        if ((ST_MM_DECODE_MAGIC != pHdr->magic) || (ST_MM_DECODE_VERSION != pHdr->version))
+        {
+            clear();
+            return ST_ERR_DATA;
+        }
+        size_t pixels = static_cast<size_t>(pHdr->width) * pHdr->height;
+        if ((0 == pixels) || (0 == pHdr->analogBits) || (pHdr->analogBits > 31))
+        {
+            clear();
+            return ST_ERR_DIMENSION;
+        }
+        // Three float tables follow the header; divide rather than multiply so a
+        // corrupt width/height cannot wrap the size check
+        if (pixels > ((mFile.size() - sizeof(StMmDecodeFileHeader)) / (3 * sizeof(float))))
+        {
+            clear();
+            return ST_ERR_LENGTH;
+        }
+
+        const float* pTables = reinterpret_cast<const float*>(mFile.data() + sizeof(StMmDecodeFileHeader));
+        mpPedestal = pTables;
+        mpGain = pTables + pixels;
+        mpScale = pTables + (2 * pixels);
+        mWidth = pHdr->width;
+        mHeight = pHdr->height;
+        mAnalogBits = pHdr->analogBits;
+        mFile.prefetch();
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Use tables held in memory (e.g. from a calibration fit)
+    ///
+    /// @param[in] width        image width
+    /// @param[in] height       image height
+    /// @param[in] analogBits   width of the analog residual field
+    /// @param[in] pedestal     width * height pedestal values
+    /// @param[in] gain         width * height gain values
+    /// @param[in] scale        width * height overflow scale values
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t setTables(uint32_t width, uint32_t height, uint32_t analogBits,
+                      const std::vector<float>& pedestal,
+                      const std::vector<float>& gain,
+                      const std::vector<float>& scale)
+    {
+        size_t pixels = static_cast<size_t>(width) * height;
+        if ((0 == pixels) || (0 == analogBits) || (analogBits > 31))
+        {
+            return ST_ERR_DIMENSION;
+        }
+        if ((pedestal.size() != pixels) || (gain.size() != pixels) || (scale.size() != pixels))
+        {
+            return ST_ERR_LENGTH;
+        }
+        clear();
+        mTables.reserve(3 * pixels);
+        mTables.insert(mTables.end(), pedestal.begin(), pedestal.end());
+        mTables.insert(mTables.end(), gain.begin(), gain.end());
+        mTables.insert(mTables.end(), scale.begin(), scale.end());
+        mpPedestal = mTables.data();
+        mpGain = mpPedestal + pixels;
+        mpScale = mpPedestal + (2 * pixels);
+        mWidth = width;
+        mHeight = height;
+        mAnalogBits = analogBits;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Write a calibration file
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    static int32_t writeFile(const std::string& path,
+                             uint32_t width, uint32_t height, uint32_t analogBits,
+                             const std::vector<float>& pedestal,
+                             const std::vector<float>& gain,
+                             const std::vector<float>& scale)
+    {
+        size_t pixels = static_cast<size_t>(width) * height;
+        if ((pedestal.size() != pixels) || (gain.size() != pixels) || (scale.size() != pixels))
+        {
+            return ST_ERR_LENGTH;
+        }
+        StMmDecodeFileHeader hdr = {};
+        hdr.magic = ST_MM_DECODE_MAGIC;
+        hdr.version = ST_MM_DECODE_VERSION;
+        hdr.width = width;
+        hdr.height = height;
+        hdr.analogBits = analogBits;
+
+        FILE* fp = fopen(path.c_str(), "wb");
+        if (nullptr == fp)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        bool ok = (1 == fwrite(&hdr, sizeof(hdr), 1, fp)) &&
+                  (pixels == fwrite(pedestal.data(), sizeof(float), pixels, fp)) &&
+                  (pixels == fwrite(gain.data(), sizeof(float), pixels, fp)) &&
+                  (pixels == fwrite(scale.data(), sizeof(float), pixels, fp));
+        ok = (0 == fclose(fp)) && ok;
+        return ok ? ST_ERR_OK : ST_ERR_FILE_WRITE;
+    }
+
+    //----------------------------------------------
+    /// Discard the tables
+    void clear()
+    {
+        mFile.close();
+        mTables.clear();
+        mTables.shrink_to_fit();
+        mpPedestal = mpGain = mpScale = nullptr;
+        mWidth = mHeight = 0;
+        mAnalogBits = ST_MM_DECODE_ANALOG_BITS;
+    }
+
+    bool isValid() const { return nullptr != mpPedestal; }     ///< Tables loaded
+    bool isMapped() const { return mFile.isOpen(); }           ///< Tables are file mapped
+    uint32_t getWidth() const { return mWidth; }               ///< Image width
+    uint32_t getHeight() const { return mHeight; }             ///< Image height
+    uint32_t getAnalogBits() const { return mAnalogBits; }     ///< Analog residual width
+
+    //----------------------------------------------
+    /// Decode a range of pixels
+    ///
+    /// @param[in]  pRaw    raw image, getWidth() x getHeight()
+    /// @param[out] pOut    output image, same geometry
+    /// @param[in]  begin   first pixel
+    /// @param[in]  end     one past the last pixel
+    ///
+    template<typename R, typename D>
+    void decodePixels(const R* pRaw, D* pOut, size_t begin, size_t end) const
+    {
+        mmDecodeKernel(pRaw + begin, mpPedestal + begin, mpGain + begin, mpScale + begin,
+                       pOut + begin, end - begin, mAnalogBits);
+    }
+
+    //----------------------------------------------
+    /// Decode a raw frame image
+    ///
+    /// @param[in]  fRaw    raw frame, DT_INT32 or DT_UINT32 image
+    /// @param[out] fDest   destination frame, same geometry, DT_DOUBLE or DT_FLOAT
+    /// @param[in]  pPool   optional worker pool
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t decode(StFrameBuffer& fRaw, StFrameBuffer& fDest, STUTIL::WorkPool* pPool = nullptr) const
+    {
+        if (!isValid())
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        if ((fRaw.getImageWidth() != mWidth) || (fRaw.getImageHeight() != mHeight) ||
+            (fDest.getImageWidth() != mWidth) || (fDest.getImageHeight() != mHeight))
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        STDataType rawType = fRaw.getPixelType();
+        STDataType destType = fDest.getPixelType();
+        if (((DT_INT32 != rawType) && (DT_UINT32 != rawType)) ||
+            ((DT_DOUBLE != destType) && (DT_FLOAT != destType)))
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+
+        DecodeOp op = { this, fRaw.getImagePtr(), fDest.getImagePtr(), pPool };
+        if ((nullptr == op.pRaw) || (nullptr == op.pDest))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return dispatchPixelTypes(rawType, destType, op);
+    }
+
+private:
+    //----------------------------------------------
+    // Dispatch functor for decode()
+    struct DecodeOp
+    {
+        const StMmDecode* pDecode;
+        const void* pRaw;
+        void* pDest;
+        STUTIL::WorkPool* pPool;
+
+        template<typename R, typename D> int32_t run()
+        {
+            const StMmDecode* pDec = pDecode;
+            const R* pR = static_cast<const R*>(pRaw);
+            D* pD = static_cast<D*>(pDest);
+            size_t pixels = static_cast<size_t>(pDec->mWidth) * pDec->mHeight;
+            if (nullptr == pPool)
+            {
+                pDec->decodePixels(pR, pD, 0, pixels);
+            }
+            else
+            {
+                pPool->parallelFor(pixels, ST_MM_DECODE_TILE_PIXELS,
+                    [pDec, pR, pD](size_t begin, size_t end) { pDec->decodePixels(pR, pD, begin, end); });
+            }
+            return ST_ERR_OK;
+        }
+    };
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_MM_DECODE_H
@@ -20,6 +20,7 @@
 #include "nlohmann_json_fwd.hpp"
 #include "st_if_defs.h"
 #include "st_errors.h"
+#include "st_dict_cache.h"
 #include "stutil_logger.h"
 
 //******************************************************************
@@ -651,6 +652,114 @@ public:
     /// @param[in]  getValue     value onlyif true, definition if false
     void toJson(std::string& jsonStr, bool getValue = false) const;
 
+    //----------------------------------------------
+    /// Serialize the definition to a binary dictionary cache snapshot
+    ///
+    /// Cached values are not saved.
+    ///
+    /// @param[out] w            snapshot writer
+    ///
+    void toBinary(StDictWriter& w) const
+    {
+        w.putStr(mId);
+        w.put<uint8_t>(mDisable);
+        w.putStr(mName);
+        w.putStr(mDescription);
+        w.put<int32_t>(static_cast<int32_t>(mAccess));
+        w.put<uint8_t>(mCommon);
+        w.put<uint8_t>(mRawRegister);
+        w.put<uint8_t>(mRequired);
+        w.put<uint8_t>(mConfig);
+        w.put<uint32_t>(mDimension);
+
+        w.put<int32_t>(static_cast<int32_t>(mDomain));
+        w.put<int32_t>(static_cast<int32_t>(mSubDomain));
+        w.put<uint32_t>(mAddress);
+        w.put<uint32_t>(mNBytes);
+        w.put<uint32_t>(mArrayStride);
+        w.put<uint32_t>(mArrayOffset);
+        w.put<uint32_t>(mStartBit);
+        w.put<uint32_t>(mNBits);
+        w.put<uint8_t>(mVolatile);
+
+        w.putStr(mTelemName);
+        w.put<uint32_t>(mTelemIndex);
+        w.put<uint32_t>(mTelemDimension);
+        w.put<uint32_t>(mTelemArrayStride);
+
+        w.put<int32_t>(static_cast<int32_t>(mDataType));
+        w.put<double>(mMinimum);
+        w.put<double>(mMaximum);
+        w.put<double>(mScale);
+        w.put<double>(mOffset);
+        w.put<double>(mDefaultValue);
+        w.putStr(mUnits);
+        w.putStrs(mEnumValues);
+        w.putStr(mFormat);
+        w.putStr(mConversion);
+    }
+
+    //----------------------------------------------
+    /// De-serialize the definition from a binary dictionary cache snapshot
+    ///
+    /// The cached values are reset to not valid and not modified.
+    ///
+    /// @param[in,out] r         snapshot reader
+    ///
+    /// @return 0 if ok, ST_ERR_FILE_FORMAT if the snapshot is short
+    ///
+    int32_t fromBinary(StDictReader& r)
+    {
+        mId = r.getStr();
+        mDisable = (0 != r.get<uint8_t>());
+        mName = r.getStr();
+        mDescription = r.getStr();
+        mAccess = static_cast<AccessMode_t>(r.get<int32_t>());
+        mCommon = (0 != r.get<uint8_t>());
+        mRawRegister = (0 != r.get<uint8_t>());
+        mRequired = (0 != r.get<uint8_t>());
+        mConfig = (0 != r.get<uint8_t>());
+        mDimension = r.get<uint32_t>();
+
+        mDomain = static_cast<DataDomain_t>(r.get<int32_t>());
+        mSubDomain = static_cast<DataSubDomain_t>(r.get<int32_t>());
+        mAddress = r.get<uint32_t>();
+        mNBytes = r.get<uint32_t>();
+        mArrayStride = r.get<uint32_t>();
+        mArrayOffset = r.get<uint32_t>();
+        mStartBit = r.get<uint32_t>();
+        mNBits = r.get<uint32_t>();
+        mVolatile = (0 != r.get<uint8_t>());
+
+        mTelemName = r.getStr();
+        mTelemIndex = r.get<uint32_t>();
+        mTelemDimension = r.get<uint32_t>();
+        mTelemArrayStride = r.get<uint32_t>();
+
+        mDataType = static_cast<DataType_t>(r.get<int32_t>());
+        mMinimum = r.get<double>();
+        mMaximum = r.get<double>();
+        mScale = r.get<double>();
+        mOffset = r.get<double>();
+        mDefaultValue = r.get<double>();
+        mUnits = r.getStr();
+        mEnumValues = r.getStrs();
+        mFormat = r.getStr();
+        mConversion = r.getStr();
+
+        if (!r.isOk() || (mDimension > ST_DICT_CACHE_MAX_DIMENSION))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        CachedValue_t cached = { mDefaultValue, 0, 0, false, false };
+        mCachedValue.assign((mDimension > 1) ? mDimension : 1, cached);
+        for (uint32_t i = 0; i < mCachedValue.size(); i++)
+        {
+            mCachedValue[i].index = i;
+        }
+        return ST_ERR_OK;
+    }
+
 }; // class StParameter
 
 ///@} end of class definitions
@@ -0,0 +1,380 @@
+//*******************************************************************
+/// @file st_pixel_kernels.h
+/// Sydor X-PAD compile-time pixel type dispatch and frame kernels
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// Header-only frame code resolves the STDataType of each operand ONCE
+/// per frame with dispatchPixelType() / dispatchPixelTypes(), which then
+/// call a fully specialized kernel template operating on plain typed
+/// pointers. The kernels contain no branches or virtual calls, so the
+/// compiler is free to inline and vectorize them.
+///
+/// The prebuilt library is not routed through this layer:
+/// StFrameBuffer::resize() and StCorrections::scaleImage(),
+/// accumulateImage() and subtractImage() keep their own per-pixel type
+/// handling. scaleFrame(), accumulateFrame() and subtractFrame() below
+/// are the dispatched equivalents for code in this tree; unlike
+/// StCorrections::subtractImage(), subtractFrame() accepts a background
+/// of any numeric pixel type.
+///
+/// Adding a new operation means writing a small "Op" struct with a
+/// templated run<T>() (or run<T1, T2>()) method and passing it to the
+/// appropriate dispatch function.
+///
+//*******************************************************************
+#ifndef ST_PIXEL_KERNELS_H
+#define ST_PIXEL_KERNELS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+    #define ST_RESTRICT __restrict      ///< No-alias hint for kernel pointers
+#else
+    #define ST_RESTRICT
+#endif
+
+
+//******************************************************************
+// Pixel type traits
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Map an STDataType to its C++ pixel type
+template<STDataType T> struct StPixelTraits;
+template<> struct StPixelTraits<DT_UINT32> { typedef uint32_t type; };
+template<> struct StPixelTraits<DT_INT32>  { typedef int32_t  type; };
+template<> struct StPixelTraits<DT_UINT16> { typedef uint16_t type; };
+template<> struct StPixelTraits<DT_INT16>  { typedef int16_t  type; };
+template<> struct StPixelTraits<DT_UINT8>  { typedef uint8_t  type; };
+template<> struct StPixelTraits<DT_INT8>   { typedef int8_t   type; };
+template<> struct StPixelTraits<DT_UINT64> { typedef uint64_t type; };
+template<> struct StPixelTraits<DT_INT64>  { typedef int64_t  type; };
+template<> struct StPixelTraits<DT_FLOAT>  { typedef float    type; };
+template<> struct StPixelTraits<DT_DOUBLE> { typedef double   type; };
+
+//------------------------------------------------------------------
+/// Arithmetic type used when combining two pixel types
+///
+/// double if either operand is double, float if either operand is
+/// float, otherwise double (integer pixels).
+template<typename T1, typename T2> struct StPixelCalcType        { typedef double type; };
+template<> struct StPixelCalcType<float, float>                  { typedef float  type; };
+template<typename T> struct StPixelCalcType<float, T>            { typedef float  type; };
+template<typename T> struct StPixelCalcType<T, float>            { typedef float  type; };
+template<> struct StPixelCalcType<double, float>                 { typedef double type; };
+template<> struct StPixelCalcType<float, double>                 { typedef double type; };
+template<typename T> struct StPixelCalcType<double, T>           { typedef double type; };
+template<typename T> struct StPixelCalcType<T, double>           { typedef double type; };
+template<> struct StPixelCalcType<double, double>                { typedef double type; };
+
+
+//******************************************************************
+// Pixel type dispatch
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Resolve one runtime pixel type to a compile-time type
+///
+/// @param[in] pixelType    runtime pixel type
+/// @param[in] op           operation functor providing template<typename T> int32_t run()
+///
+/// @return value returned by op.run<T>(), or ST_ERR_DATA_TYPE if
+///         pixelType is not a numeric pixel type
+///
+template<class Op>
+inline int32_t dispatchPixelType(STDataType pixelType, Op& op)
+{
+    switch (pixelType)
+    {
+        case DT_UINT32: return op.template run<uint32_t>();
+        case DT_INT32:  return op.template run<int32_t>();
+        case DT_UINT16: return op.template run<uint16_t>();
+        case DT_INT16:  return op.template run<int16_t>();
+        case DT_UINT8:  return op.template run<uint8_t>();
+        case DT_INT8:   return op.template run<int8_t>();
+        case DT_UINT64: return op.template run<uint64_t>();
+        case DT_INT64:  return op.template run<int64_t>();
+        case DT_FLOAT:  return op.template run<float>();
+        case DT_DOUBLE: return op.template run<double>();
+        default:        return ST_ERR_DATA_TYPE;
+    }
+}
+
+//------------------------------------------------------------------
+// Helpers for two-type dispatch
+template<class Op, typename T1>
+struct StBindFirstPixelType
+{
+    Op& op;
+    explicit StBindFirstPixelType(Op& o) : op(o) {}
+    template<typename T2> int32_t run() { return op.template run<T1, T2>(); }
+};
+
+template<class Op>
+struct StDispatchSecondPixelType
+{
+    Op& op;
+    STDataType type2;
+    StDispatchSecondPixelType(Op& o, STDataType t2) : op(o), type2(t2) {}
+    template<typename T1> int32_t run()
+    {
+        StBindFirstPixelType<Op, T1> bound(op);
+        return dispatchPixelType(type2, bound);
+    }
+};
+
+//------------------------------------------------------------------
+/// Resolve a pair of runtime pixel types to compile-time types
+///
+/// @param[in] type1        first runtime pixel type
+/// @param[in] type2        second runtime pixel type
+/// @param[in] op           operation functor providing
+///                         template<typename T1, typename T2> int32_t run()
+///
+/// @return value returned by op.run<T1, T2>(), or ST_ERR_DATA_TYPE
+///
+template<class Op>
+inline int32_t dispatchPixelTypes(STDataType type1, STDataType type2, Op& op)
+{
+    StDispatchSecondPixelType<Op> second(op, type2);
+    return dispatchPixelType(type1, second);
+}
+
+
+//******************************************************************
+// Pixel kernels
+// Branch-free inner loops. All pointers must reference distinct
+// buffers unless noted otherwise.
+//******************************************************************
+
+//------------------------------------------------------------------
+/// pixels[i] *= scale  (in place)
+template<typename T>
+inline void scaleKernel(T* ST_RESTRICT pPixels, size_t count, double scale)
+{
+    typedef typename StPixelCalcType<T, T>::type CalcT;
+    const CalcT s = static_cast<CalcT>(scale);
+    for (size_t i = 0; i < count; i++)
+    {
+        pPixels[i] = static_cast<T>(static_cast<CalcT>(pPixels[i]) * s);
+    }
+}
+
+//------------------------------------------------------------------
+/// dest[i] += src[i]
+template<typename S, typename D>
+inline void accumulateKernel(const S* ST_RESTRICT pSrc, D* ST_RESTRICT pDest, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        pDest[i] = static_cast<D>(pDest[i] + pSrc[i]);
+    }
+}
+
+//------------------------------------------------------------------
+/// dest[i] = fg[i] - bg[i]
+///
+/// @note pDest may alias pFg (in-place subtraction) when F == D
+template<typename F, typename B, typename D>
+inline void subtractKernel(const F* pFg, const B* ST_RESTRICT pBg, D* pDest, size_t count)
+{
+    typedef typename StPixelCalcType<F, B>::type CalcT;
+    for (size_t i = 0; i < count; i++)
+    {
+        pDest[i] = static_cast<D>(static_cast<CalcT>(pFg[i]) - static_cast<CalcT>(pBg[i]));
+    }
+}
+
+//------------------------------------------------------------------
+/// dest[i] = (D)src[i]
+template<typename S, typename D>
+inline void convertKernel(const S* ST_RESTRICT pSrc, D* ST_RESTRICT pDest, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        pDest[i] = static_cast<D>(pSrc[i]);
+    }
+}
+
+
+//******************************************************************
+// Dispatch operations
+// Functors binding runtime buffers to the typed kernels
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Scale operation functor
+struct StScaleOp
+{
+    void* pPixels;
+    size_t count;
+    double scale;
+    template<typename T> int32_t run()
+    {
+        scaleKernel(static_cast<T*>(pPixels), count, scale);
+        return ST_ERR_OK;
+    }
+};
+
+//------------------------------------------------------------------
+/// Accumulate operation functor (T1 = source, T2 = destination)
+struct StAccumulateOp
+{
+    const void* pSrc;
+    void* pDest;
+    size_t count;
+    template<typename S, typename D> int32_t run()
+    {
+        accumulateKernel(static_cast<const S*>(pSrc), static_cast<D*>(pDest), count);
+        return ST_ERR_OK;
+    }
+};
+
+//------------------------------------------------------------------
+/// Convert operation functor (T1 = source, T2 = destination)
+struct StConvertOp
+{
+    const void* pSrc;
+    void* pDest;
+    size_t count;
+    template<typename S, typename D> int32_t run()
+    {
+        convertKernel(static_cast<const S*>(pSrc), static_cast<D*>(pDest), count);
+        return ST_ERR_OK;
+    }
+};
+
+//------------------------------------------------------------------
+/// Subtract operation functor (T1 = foreground/destination, T2 = background)
+struct StSubtractOp
+{
+    const void* pFg;
+    const void* pBg;
+    void* pDest;
+    size_t count;
+    template<typename F, typename B> int32_t run()
+    {
+        subtractKernel(static_cast<const F*>(pFg), static_cast<const B*>(pBg),
+                       static_cast<F*>(pDest), count);
+        return ST_ERR_OK;
+    }
+};
+
+
+//******************************************************************
+// Frame level entry points
+// Each of these resolves pixel types once and runs one kernel pass
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Convert a block of pixels from one pixel type to another
+///
+/// @param[in]  pSrc        source pixels
+/// @param[in]  srcType     source pixel type
+/// @param[out] pDest       destination pixels
+/// @param[in]  destType    destination pixel type
+/// @param[in]  count       number of pixels
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t convertPixels(const void* pSrc, STDataType srcType,
+                             void* pDest, STDataType destType, size_t count)
+{
+    if ((nullptr == pSrc) || (nullptr == pDest))
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    StConvertOp op = { pSrc, pDest, count };
+    return dispatchPixelTypes(srcType, destType, op);
+}
+
+//------------------------------------------------------------------
+/// Multiply every pixel in a frame by a scale value
+///
+/// @param[in,out] f1           frame to scale
+/// @param[in]     scaleValue   multiplier
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t scaleFrame(StFrameBuffer& f1, double scaleValue)
+{
+    StScaleOp op = { f1.getImagePtr(), f1.getImagePixelCount(), scaleValue };
+    if (nullptr == op.pPixels)
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    return dispatchPixelType(f1.getPixelType(), op);
+}
+
+//------------------------------------------------------------------
+/// Add the image of one frame into another
+///
+/// @param[in]     fSrc     frame to add
+/// @param[in,out] fDest    accumulating frame (keeps its own pixel type)
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t accumulateFrame(StFrameBuffer& fSrc, StFrameBuffer& fDest)
+{
+    if (fSrc.getImagePixelCount() != fDest.getImagePixelCount())
+    {
+        return ST_ERR_IMAGE_SIZE;
+    }
+    StAccumulateOp op = { fSrc.getImagePtr(), fDest.getImagePtr(), fDest.getImagePixelCount() };
+    if ((nullptr == op.pSrc) || (nullptr == op.pDest))
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    return dispatchPixelTypes(fSrc.getPixelType(), fDest.getPixelType(), op);
+}
+
+//------------------------------------------------------------------
+/// Compute fDest = fFg - fBg
+///
+/// @param[in]  fFg     foreground frame
+/// @param[in]  fBg     background frame (any numeric pixel type)
+/// @param[out] fDest   result frame; must have the pixel type of fFg.
+///                     May be the same frame as fFg.
+///
+/// @return 0 if ok, else negative error code
+///
+inline int32_t subtractFrame(StFrameBuffer& fFg, StFrameBuffer& fBg, StFrameBuffer& fDest)
+{
+    uint32_t count = fFg.getImagePixelCount();
+    if ((count != fBg.getImagePixelCount()) || (count != fDest.getImagePixelCount()))
+    {
+        return ST_ERR_IMAGE_SIZE;
+    }
+    if (fFg.getPixelType() != fDest.getPixelType())
+    {
+        return ST_ERR_DATA_TYPE;
+    }
+    StSubtractOp op = { fFg.getImagePtr(), fBg.getImagePtr(), fDest.getImagePtr(), count };
+    if ((nullptr == op.pFg) || (nullptr == op.pBg) || (nullptr == op.pDest))
+    {
+        return ST_ERR_NULL_PTR;
+    }
+    return dispatchPixelTypes(fFg.getPixelType(), fBg.getPixelType(), op);
+}
+
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_PIXEL_KERNELS_H
@@ -0,0 +1,371 @@
+//*******************************************************************
+/// @file st_read_plan.h
+/// Sydor Server coalesced raw register read planner
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// readParamArray() reads one parameter at a time through the response
+/// handler. Many parameters share a register (different StartBit/NBits
+/// fields) or sit at neighbouring addresses, so a telemetry or status
+/// poll costs one bus transaction per field.
+///
+/// StReadPlan takes a list of parameter reads, once, and groups the
+/// registers they touch by data domain and address. Registers closer
+/// than the gap limit are merged into one range, and each range is read
+/// with a single StRawBurstReader::readRawBurst() call. Every requested
+/// element keeps its position in its range, and every request keeps a
+/// precomputed field shift and mask, so execute() only copies words and
+/// extracts fields.
+///
+/// Only plain memory mapped 32-bit registers are merged: Back Channel,
+/// Sensor FPGA and Host FPGA domains with no subdomain and NBytes == 4.
+/// SPI/I2C registers, software variables and per-client values are read
+/// with readRawValueArray(), as before.
+///
+/// Burst reads are a capability of the response handler, not part of
+/// the ResponseHandler interface (its vtable is shared with the prebuilt
+/// server library). A hardware handler that can read register ranges
+/// also derives from StRawBurstReader; execute() finds it with a
+/// dynamic_cast. Handlers without it, or that return ST_ERR_NOT_IMPL,
+/// read every request with readRawValueArray().
+///
+/// The server application runs a plan with its own response handler
+/// and scales the values with StParameter::getScaledFromRaw().
+///
+//*******************************************************************
+#ifndef ST_READ_PLAN_H
+#define ST_READ_PLAN_H
+
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_parameter.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_READ_PLAN_WORD_BYTES      = 4;    ///< Register size merged by the planner
+const uint32_t ST_READ_PLAN_DEF_GAP_WORDS   = 4;    ///< Default unused words allowed inside a range
+const uint32_t ST_READ_PLAN_DEF_BURST_WORDS = 256;  ///< Default largest range (words)
+
+//******************************************************************
+// Data structures
+//******************************************************************
+
+//------------------------------------------------------------------
+/// One parameter read
+template<typename ParamT>
+struct StReadRequestT
+{
+    ParamT* pParam;             ///< Parameter definition
+    uint32_t index;             ///< First array index
+    uint32_t count;             ///< Number of elements (1 for a scalar)
+};
+
+//------------------------------------------------------------------
+/// Field extraction for a request (from StartBit/NBits)
+struct StReadField
+{
+    uint32_t shift;             ///< Field start bit
+    uint32_t mask;              ///< Field mask after the shift
+
+    uint32_t extract(uint32_t raw) const { return (raw >> shift) & mask; } ///< Field value of a register
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Burst register read capability of a response handler
+class StRawBurstReader
+{
+public:
+    virtual ~StRawBurstReader() {}
+
+    //----------------------------------------------
+    /// Read a range of consecutive 32-bit registers in one transaction
+    ///
+    /// Only called for the Back Channel, Sensor FPGA and Host FPGA
+    /// domains (memory mapped registers, no subdomain).
+    ///
+    /// @param[in] domain       data domain
+    /// @param[in] address      first register address (byte address, 4-byte aligned)
+    /// @param[in] count        number of registers
+    /// @param[out] rawValues   vector to receive count register values
+    /// @param[in] padIndex     optional PAD index (ignored if not needed)
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_IMPL to have the plan read each
+    ///         parameter instead, else negative error code
+    ///
+    virtual int32_t readRawBurst(STDataDomain domain,
+        uint32_t address,
+        uint32_t count,
+        std::vector<uint32_t>& rawValues,
+        uint32_t padIndex = 0) = 0;
+};
+
+//------------------------------------------------------------------
+/// Coalesced read plan for a fixed list of parameter reads
+///
+/// Build once (for example per telemetry or status poll list) and
+/// execute as often as needed. The parameters must stay valid while
+/// the plan is in use (the data store does not move them).
+///
+/// ParamT is StParameter (see StReadPlan); the tests plan over a stub
+/// with the same register layout accessors.
+///
+template<typename ParamT>
+class StReadPlanT
+{
+public:
+    typedef StReadRequestT<ParamT> Request;     ///< One parameter read
+
+private:
+    //----------------------------------------------
+    /// One burst read
+    struct Burst
+    {
+        STDataDomain domain;    ///< Data domain
+        uint32_t address;       ///< First register address
+        uint32_t words;         ///< Registers read
+    };
+
+    //----------------------------------------------
+    /// Where a requested element comes from
+    struct Slot
+    {
+        uint32_t burst;         ///< mBursts entry
+        uint32_t word;          ///< Word within the burst
+    };
+
+    //----------------------------------------------
+    /// Planning entry (one requested element)
+    struct Entry
+    {
+        STDataDomain domain;    ///< Data domain
+        uint32_t address;       ///< Register address
+        uint32_t request;       ///< mRequests entry
+        uint32_t element;       ///< Element within the request
+
+        bool operator<(const Entry& e) const
+        {
+            return (domain != e.domain) ? (domain < e.domain) : (address < e.address);
+        }
+    };
+
+    std::vector<Request> mRequests;             ///< Requested reads
+    std::vector<StReadField> mFields;           ///< Field per request
+    std::vector<bool> mCoalesced;               ///< true if the request is read from bursts
+    std::vector<uint32_t> mFirstSlot;           ///< First mSlots entry per request
+    std::vector<Slot> mSlots;                   ///< Source of each coalesced element
+    std::vector<Burst> mBursts;                 ///< Burst reads
+
+public:
+    //----------------------------------------------
+    /// Return true if the planner can merge reads of this parameter
+    static bool isCoalescable(ParamT& param)
+    {
+        STDataDomain domain = param.getDomain();
+        uint32_t stride = param.getArrayStride();
+        return ((DD_BACK_CHANNEL == domain) || (DD_SENSOR_FPGA == domain) || (DD_HOST_FPGA == domain)) &&
+               (DS_NONE == param.getSubDomain()) && (ST_READ_PLAN_WORD_BYTES == param.getNBytes()) &&
+               (0 == (param.getAddress() % ST_READ_PLAN_WORD_BYTES)) &&
+               (0 == (stride % ST_READ_PLAN_WORD_BYTES));
+    }
+
+    //----------------------------------------------
+    /// Get the field shift and mask of a parameter
+    static StReadField makeField(ParamT& param)
+    {
+        StReadField field;
+        uint32_t nbits = param.getNBits();
+        field.shift = (param.getStartBit() < 32) ? param.getStartBit() : 0;
+        field.mask = ((0 == nbits) || (nbits >= 32)) ? 0xFFFFFFFFu : ((1u << nbits) - 1);
+        return field;
+    }
+
+    //----------------------------------------------
+    /// Build the plan
+    ///
+    /// @param[in] requests     parameter reads
+    /// @param[in] gapWords     max unused registers between two merged reads
+    /// @param[in] burstWords   max registers per burst
+    ///
+    /// @return 0 if ok, ST_ERR_PARAM if a request has no parameter or
+    ///         reaches past the parameter dimension
+    ///
+    int32_t build(const std::vector<Request>& requests,
+                  uint32_t gapWords = ST_READ_PLAN_DEF_GAP_WORDS,
+                  uint32_t burstWords = ST_READ_PLAN_DEF_BURST_WORDS)
+    {
+        clear();
+        std::vector<Entry> entries;
+        for (uint32_t r = 0; r < requests.size(); r++)
+        {
+            const Request& req = requests[r];
+            if ((nullptr == req.pParam) || (0 == req.count))
+            {
+                clear();
+                return ST_ERR_PARAM;
+            }
+            uint32_t dimension = std::max<uint32_t>(req.pParam->getDimension(), 1);
+            if ((req.index >= dimension) || (req.count > (dimension - req.index)))
+            {
+                clear();
+                return ST_ERR_PARAM;
+            }
+            bool coalesce = isCoalescable(*req.pParam);
+            mFields.push_back(makeField(*req.pParam));
+            mCoalesced.push_back(coalesce);
+            for (uint32_t e = 0; coalesce && (e < req.count); e++)
+            {
+                Entry entry;
+                entry.domain = req.pParam->getDomain();
+                entry.address = req.pParam->getAddress() + (req.index + e) * req.pParam->getArrayStride();
+                entry.request = r;
+                entry.element = e;
+                entries.push_back(entry);
+            }
+        }
+        mRequests = requests;
+
+        // Merge registers in address order; shared registers take one word
+        std::stable_sort(entries.begin(), entries.end());
+        std::vector<Slot> slots(entries.size());
+        uint32_t maxSpan = std::max<uint32_t>(burstWords, 1) * ST_READ_PLAN_WORD_BYTES;
+        uint32_t maxGap = (gapWords + 1) * ST_READ_PLAN_WORD_BYTES;
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            const Entry& entry = entries[i];
+            Burst* pBurst = mBursts.empty() ? nullptr : &mBursts.back();
+            uint32_t end = (nullptr == pBurst) ? 0 : (pBurst->address + (pBurst->words - 1) * ST_READ_PLAN_WORD_BYTES);
+            if ((nullptr == pBurst) || (pBurst->domain != entry.domain) ||
+                ((entry.address - end) > maxGap) ||
+                ((entry.address - pBurst->address) >= maxSpan))
+            {
+                Burst burst = { entry.domain, entry.address, 1 };
+                mBursts.push_back(burst);
+                pBurst = &mBursts.back();
+            }
+            else
+            {
+                pBurst->words = (entry.address - pBurst->address) / ST_READ_PLAN_WORD_BYTES + 1;
+            }
+            slots[i].burst = static_cast<uint32_t>(mBursts.size() - 1);
+            slots[i].word = (entry.address - pBurst->address) / ST_READ_PLAN_WORD_BYTES;
+        }
+
+        // Lay the slots out in request order
+        mFirstSlot.assign(mRequests.size(), 0);
+        uint32_t next = 0;
+        for (uint32_t r = 0; r < mRequests.size(); r++)
+        {
+            mFirstSlot[r] = next;
+            next += mCoalesced[r] ? mRequests[r].count : 0;
+        }
+        mSlots.resize(next);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            mSlots[mFirstSlot[entries[i].request] + entries[i].element] = slots[i];
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Remove all requests
+    void clear(void)
+    {
+        mRequests.clear();
+        mFields.clear();
+        mCoalesced.clear();
+        mFirstSlot.clear();
+        mSlots.clear();
+        mBursts.clear();
+    }
+
+    //----------------------------------------------
+    /// Read all requests
+    ///
+    /// @param[in]  handler     response handler (ResponseHandler), optionally
+    ///                         also an StRawBurstReader
+    /// @param[out] rawValues   raw field values, one vector per request
+    ///                         (as returned by readRawValueArray())
+    /// @param[in]  padIndex    PAD index
+    ///
+    /// @return 0 if ok, negative error code on any error
+    ///
+    template<typename HandlerT>
+    int32_t execute(HandlerT& handler, std::vector<std::vector<uint32_t>>& rawValues,
+                    uint32_t padIndex = 0) const
+    {
+        rawValues.resize(mRequests.size());
+        std::vector<std::vector<uint32_t>> burstValues(mBursts.size());
+        StRawBurstReader* pReader = dynamic_cast<StRawBurstReader*>(&handler);
+        bool useBursts = (nullptr != pReader) && !mBursts.empty();
+        for (size_t b = 0; useBursts && (b < mBursts.size()); b++)
+        {
+            const Burst& burst = mBursts[b];
+            int32_t rtn = pReader->readRawBurst(burst.domain, burst.address, burst.words,
+                                                burstValues[b], padIndex);
+            if (ST_ERR_NOT_IMPL == rtn)
+            {
+                useBursts = false;
+            }
+            else if (0 != rtn)
+            {
+                return rtn;
+            }
+            else if (burstValues[b].size() < burst.words)
+            {
+                return ST_ERR_LENGTH;
+            }
+        }
+
+        for (uint32_t r = 0; r < mRequests.size(); r++)
+        {
+            const Request& req = mRequests[r];
+            std::vector<uint32_t>& values = rawValues[r];
+            if (useBursts && mCoalesced[r])
+            {
+                values.resize(req.count);
+                const StReadField& field = mFields[r];
+                const Slot* pSlot = &mSlots[mFirstSlot[r]];
+                for (uint32_t e = 0; e < req.count; e++)
+                {
+                    values[e] = field.extract(burstValues[pSlot[e].burst][pSlot[e].word]);
+                }
+                continue;
+            }
+            int32_t rtn = handler.readRawValueArray(*req.pParam, values, req.index, req.count, padIndex);
+            if (0 != rtn)
+            {
+                return rtn;
+            }
+        }
+        return ST_ERR_OK;
+    }
+
+    const std::vector<Request>& getRequests(void) const { return mRequests; }        ///< Requested reads
+    const StReadField& getField(uint32_t request) const { return mFields[request]; } ///< Field of a request
+    uint32_t getBurstCount(void) const { return static_cast<uint32_t>(mBursts.size()); } ///< Burst reads per execute()
+    bool isCoalesced(uint32_t request) const { return mCoalesced[request]; }         ///< Request is read from bursts
+};
+
+typedef StReadRequestT<StParameter> StReadRequest;  ///< One data dictionary parameter read
+typedef StReadPlanT<StParameter> StReadPlan;        ///< Read plan over data dictionary parameters
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_READ_PLAN_H
@@ -0,0 +1,372 @@
+//*******************************************************************
+/// @file st_remap_table.h
+/// Sydor X-PAD precomputed sparse pixel remap table
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// StRemapTable holds a geometric correction compiled into a sparse
+/// matrix in CSR (compressed sparse row) form. Each output pixel owns
+/// a contiguous run of (source index, weight) terms:
+///
+///     out[o] = sum( weight[k] * src[srcIndex[k]] ),
+///              k = rowStart[o] .. rowStart[o+1]-1
+///
+/// The table is built once, when calibration is (re)loaded, and each
+/// frame is then a single gather pass with no geometry math. The
+/// gather has no data dependent branches and output rows are
+/// independent, so it tiles cleanly across a WorkPool.
+///
+/// Output may be double (MMGCRawPixel) or float. Float output halves
+/// the memory traffic of the corrected image.
+///
+/// @note The MM-PAD geometry (sensor tile placement and the split of
+/// the enlarged edge pixels) is part of the detector calibration and
+/// is not in this tree; the prebuilt library geocorrection does not
+/// export it. A caller builds the table from the calibration with
+/// buildFromTiles() (plain tile placement) or build() (arbitrary
+/// terms). Until then StCorrCalibration::geo_remap is empty and the
+/// fused geocorrection chain returns ST_ERR_NOT_AVAILABLE.
+///
+//*******************************************************************
+#ifndef ST_REMAP_TABLE_H
+#define ST_REMAP_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_pixel_kernels.h"
+#include "stutil_workpool.hpp"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define ST_REMAP_DEFAULT_TILE_ROWS 16   ///< Output image rows per parallel tile
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// One contribution of a source pixel to an output pixel
+struct StRemapTerm
+{
+    uint32_t outIndex;      ///< Output pixel index (row * width + col)
+    uint32_t srcIndex;      ///< Source pixel index (row * width + col)
+    float    weight;        ///< Weight applied to the source pixel
+};
+
+//----------------------------------------------
+/// A rectangle of source pixels copied to an output position
+struct StRemapTile
+{
+    uint32_t srcX;          ///< Source column of the tile's first pixel
+    uint32_t srcY;          ///< Source row of the tile's first pixel
+    uint32_t width;         ///< Tile width in pixels
+    uint32_t height;        ///< Tile height in pixels
+    uint32_t outX;          ///< Output column of the tile's first pixel
+    uint32_t outY;          ///< Output row of the tile's first pixel
+};
+
+//----------------------------------------------
+/// Post step for a plain gather
+struct StRemapIdentity
+{
+    template<typename T> T operator()(size_t, T value) const { return value; }
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Sparse CSR remap table
+class StRemapTable
+{
+private:
+    uint32_t mSrcWidth;                 ///< Source image width
+    uint32_t mSrcHeight;                ///< Source image height
+    uint32_t mOutWidth;                 ///< Output image width
+    uint32_t mOutHeight;                ///< Output image height
+    std::vector<uint32_t> mRowStart;    ///< CSR row pointers (output pixels + 1)
+    std::vector<uint32_t> mSrcIndex;    ///< CSR column indices (source pixels)
+    std::vector<float>    mWeight;      ///< CSR values
+    uint32_t mGeneration;               ///< Incremented on every build()
+
+public:
+    //----------------------------------------------
+    /// Constructor - creates an empty table
+    StRemapTable()
+        : mSrcWidth(0), mSrcHeight(0), mOutWidth(0), mOutHeight(0), mGeneration(0)
+    {
+    }
+
+    //----------------------------------------------
+    /// Build the table from a list of remap terms
+    ///
+    /// Terms may be given in any order. Output pixels with no terms
+    /// are written as 0.
+    ///
+    /// @param[in] srcWidth     source image width in pixels
+    /// @param[in] srcHeight    source image height in pixels
+    /// @param[in] outWidth     output image width in pixels
+    /// @param[in] outHeight    output image height in pixels
+    /// @param[in] terms        list of remap terms
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t build(uint32_t srcWidth, uint32_t srcHeight,
+                  uint32_t outWidth, uint32_t outHeight,
+                  const std::vector<StRemapTerm>& terms)
+    {
+        // Pixel indices and term offsets are 32 bit
+        uint64_t srcPixels = static_cast<uint64_t>(srcWidth) * srcHeight;
+        uint64_t outPixels = static_cast<uint64_t>(outWidth) * outHeight;
+
+        if ((0 == srcPixels) || (0 == outPixels) ||
+            (srcPixels > UINT32_MAX) || (outPixels >= UINT32_MAX))
+        {
+            return ST_ERR_DIMENSION;
+        }
+        if (terms.size() > UINT32_MAX)
+        {
+            return ST_ERR_PARAM;
+        }
+        for (const auto& t : terms)
+        {
+            if ((t.outIndex >= outPixels) || (t.srcIndex >= srcPixels))
+            {
+                return ST_ERR_INDEX;
+            }
+        }
+
+        // Counting sort by output pixel
+        std::vector<uint32_t> rowStart(static_cast<size_t>(outPixels) + 1, 0);
+        for (const auto& t : terms)
+        {
+            rowStart[t.outIndex + 1]++;
+        }
+        for (uint32_t o = 0; o < outPixels; o++)
+        {
+            rowStart[o + 1] += rowStart[o];
+        }
+
+        std::vector<uint32_t> fill(rowStart.begin(), rowStart.end() - 1);
+        std::vector<uint32_t> srcIndex(terms.size());
+        std::vector<float> weight(terms.size());
+        for (const auto& t : terms)
+        {
+            uint32_t k = fill[t.outIndex]++;
+            srcIndex[k] = t.srcIndex;
+            weight[k] = t.weight;
+        }
+
+        mSrcWidth = srcWidth;
+        mSrcHeight = srcHeight;
+        mOutWidth = outWidth;
+        mOutHeight = outHeight;
+        mRowStart.swap(rowStart);
+        mSrcIndex.swap(srcIndex);
+        mWeight.swap(weight);
+        mGeneration++;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Build the table from a tile layout
+    ///
+    /// Every tile pixel is copied with weight 1. Output pixels not
+    /// covered by a tile (the gaps between sensors) are written as 0.
+    ///
+    /// @param[in] srcWidth     source image width in pixels
+    /// @param[in] srcHeight    source image height in pixels
+    /// @param[in] outWidth     output image width in pixels
+    /// @param[in] outHeight    output image height in pixels
+    /// @param[in] tiles        tile placements, each inside both images
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t buildFromTiles(uint32_t srcWidth, uint32_t srcHeight,
+                           uint32_t outWidth, uint32_t outHeight,
+                           const std::vector<StRemapTile>& tiles)
+    {
+        if ((static_cast<uint64_t>(srcWidth) * srcHeight > UINT32_MAX) ||
+            (static_cast<uint64_t>(outWidth) * outHeight >= UINT32_MAX))
+        {
+            return ST_ERR_DIMENSION;
+        }
+        std::vector<StRemapTerm> terms;
+        for (const auto& t : tiles)
+        {
+            if ((t.width > srcWidth) || (t.srcX > srcWidth - t.width) ||
+                (t.height > srcHeight) || (t.srcY > srcHeight - t.height) ||
+                (t.width > outWidth) || (t.outX > outWidth - t.width) ||
+                (t.height > outHeight) || (t.outY > outHeight - t.height))
+            {
+                return ST_ERR_INDEX;
+            }
+            for (uint32_t row = 0; row < t.height; row++)
+            {
+                for (uint32_t col = 0; col < t.width; col++)
+                {
+                    StRemapTerm term = { (t.outY + row) * outWidth + t.outX + col,
+                                         (t.srcY + row) * srcWidth + t.srcX + col, 1.0f };
+                    terms.push_back(term);
+                }
+            }
+        }
+        return build(srcWidth, srcHeight, outWidth, outHeight, terms);
+    }
+
+    //----------------------------------------------
+    /// Discard the table
+    void clear()
+    {
+        mSrcWidth = mSrcHeight = mOutWidth = mOutHeight = 0;
+        mRowStart.clear();
+        mSrcIndex.clear();
+        mWeight.clear();
+        mGeneration++;
+    }
+
+    //----------------------------------------------
+    /// Return true if the table has been built
+    bool isValid() const { return !mRowStart.empty(); }
+
+    //----------------------------------------------
+    /// Return the build generation (changes on every build/clear)
+    uint32_t getGeneration() const { return mGeneration; }
+
+    uint32_t getSrcWidth() const   { return mSrcWidth; }     ///< Source width
+    uint32_t getSrcHeight() const  { return mSrcHeight; }    ///< Source height
+    uint32_t getOutWidth() const   { return mOutWidth; }     ///< Output width
+    uint32_t getOutHeight() const  { return mOutHeight; }    ///< Output height
+    size_t   getTermCount() const  { return mSrcIndex.size(); }  ///< Non-zero terms
+
+    //----------------------------------------------
+    /// Gather a range of output rows
+    ///
+    /// @param[in]  pSrc        source image, getSrcWidth() x getSrcHeight()
+    /// @param[out] pOut        output image, getOutWidth() x getOutHeight()
+    /// @param[in]  rowBegin    first output row
+    /// @param[in]  rowEnd      one past the last output row
+    ///
+    template<typename S, typename D>
+    void applyRows(const S* ST_RESTRICT pSrc, D* ST_RESTRICT pOut,
+                   size_t rowBegin, size_t rowEnd) const
+    {
+        gatherRows(pSrc, pOut, rowBegin, rowEnd, StRemapIdentity());
+    }
+
+    //----------------------------------------------
+    /// Gather a range of output rows through a per-pixel post step
+    ///
+    /// Writes pOut[o] = post(o, gathered value). post is inlined into
+    /// the gather loop, so later per-pixel corrections cost no extra
+    /// pass over the image.
+    ///
+    template<typename S, typename D, typename P>
+    void gatherRows(const S* ST_RESTRICT pSrc, D* ST_RESTRICT pOut,
+                    size_t rowBegin, size_t rowEnd, const P& post) const
+    {
+        typedef typename StPixelCalcType<float, D>::type CalcT;
+        const uint32_t* ST_RESTRICT pRowStart = mRowStart.data();
+        const uint32_t* ST_RESTRICT pSrcIndex = mSrcIndex.data();
+        const float*    ST_RESTRICT pWeight   = mWeight.data();
+        size_t oEnd = rowEnd * mOutWidth;
+
+        for (size_t o = rowBegin * mOutWidth; o < oEnd; o++)
+        {
+            CalcT sum = 0;
+            uint32_t kEnd = pRowStart[o + 1];
+            for (uint32_t k = pRowStart[o]; k < kEnd; k++)
+            {
+                sum += static_cast<CalcT>(pWeight[k]) * static_cast<CalcT>(pSrc[pSrcIndex[k]]);
+            }
+            pOut[o] = static_cast<D>(post(o, sum));
+        }
+    }
+
+    //----------------------------------------------
+    /// Remap a whole frame image
+    ///
+    /// @param[in]  fSrc    source frame, image getSrcWidth() x getSrcHeight()
+    /// @param[out] fDest   destination frame. Must already be sized to
+    ///                     getOutWidth() x getOutHeight() with pixel type
+    ///                     DT_DOUBLE or DT_FLOAT.
+    /// @param[in]  pPool   optional worker pool for tiling output rows
+    /// @param[in]  tileRows output rows per tile
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t apply(StFrameBuffer& fSrc, StFrameBuffer& fDest,
+                  STUTIL::WorkPool* pPool = nullptr,
+                  uint32_t tileRows = ST_REMAP_DEFAULT_TILE_ROWS) const
+    {
+        if (mRowStart.empty())
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        if ((fSrc.getImageWidth() != mSrcWidth) || (fSrc.getImageHeight() != mSrcHeight) ||
+            (fDest.getImageWidth() != mOutWidth) || (fDest.getImageHeight() != mOutHeight))
+        {
+            return ST_ERR_IMAGE_SIZE;
+        }
+        STDataType destType = fDest.getPixelType();
+        if ((DT_DOUBLE != destType) && (DT_FLOAT != destType))
+        {
+            return ST_ERR_DATA_TYPE;
+        }
+
+        ApplyOp op = { this, fSrc.getImagePtr(), fDest.getImagePtr(), pPool, tileRows };
+        if ((nullptr == op.pSrc) || (nullptr == op.pDest))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        return dispatchPixelTypes(fSrc.getPixelType(), destType, op);
+    }
+
+private:
+    //----------------------------------------------
+    // Dispatch functor for apply()
+    struct ApplyOp
+    {
+        const StRemapTable* pTable;
+        const void* pSrc;
+        void* pDest;
+        STUTIL::WorkPool* pPool;
+        uint32_t tileRows;
+
+        template<typename S, typename D> int32_t run()
+        {
+            const StRemapTable* pT = pTable;
+            const S* pS = static_cast<const S*>(pSrc);
+            D* pD = static_cast<D*>(pDest);
+            if (nullptr == pPool)
+            {
+                pT->applyRows(pS, pD, 0, pT->mOutHeight);
+            }
+            else
+            {
+                pPool->parallelFor(pT->mOutHeight, tileRows,
+                    [pT, pS, pD](size_t begin, size_t end) { pT->applyRows(pS, pD, begin, end); });
+            }
+            return ST_ERR_OK;
+        }
+    };
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_REMAP_TABLE_H
@@ -0,0 +1,930 @@
+//*******************************************************************
+/// @file st_run_container.h
+/// Sydor capture run container file format, reader and writer
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// A run container (.strun) holds a whole capture run in one file. It
+/// can be read locally without a server. Frames are found in O(1)
+/// through a footer index, and can be streamed in sequence straight
+/// from a memory mapping.
+///
+/// File layout (all integers little-endian, structures packed):
+///
+///     StRunFileHeader                     64 bytes
+///     chunk 0                             starts on a 4 KB boundary
+///         StRunChunkHeader                64 bytes
+///         payload                         storedBytes
+///     chunk 1 ...
+///     run configuration                   configBytes (JSON text)
+///     metadata column                     frameCount x STFrameMetadata
+///     telemetry column                    telemetryBytes
+///     chunk index                         chunkCount x StRunChunkEntry
+///     frame index                         frameCount x StRunFrameEntry
+///     StRunFooter                         last 96 bytes of the file
+///
+/// - A chunk holds framesPerChunk complete StFrameBuffer records
+///   (header, image, telemetry and data sections) back to back. A frame
+///   is at frame.rawOffset in its chunk's decoded payload.
+/// - Each chunk names its own codec. ST_RUN_CODEC_NONE payloads are the
+///   raw records, so frames are read from the mapping without a copy.
+///   ST_RUN_CODEC_SHUFFLE_RLE payloads are 4-byte shuffled, then run
+///   length coded. The writer stores a chunk raw whenever coding would
+///   not make it smaller.
+/// - The metadata and telemetry columns repeat each frame's metadata
+///   and telemetry section. Scanning them does not touch pixel data.
+/// - Readers check the footer id, the version major number and every
+///   section bound before using the file. A file without a valid
+///   footer (e.g. a writer that was killed) is rejected.
+///
+/// StRunReader objects are not thread safe; use one per thread. The
+/// mapping pages are shared by the OS.
+///
+//*******************************************************************
+#ifndef ST_RUN_CONTAINER_H
+#define ST_RUN_CONTAINER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <fstream>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "stutil_mapfile.hpp"
+#include "stutil_timer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_RUN_FILE_ID               = 0x43525453;   ///< File header magic: "STRC"
+const uint32_t ST_RUN_CHUNK_ID              = 0x4B435453;   ///< Chunk header magic: "STCK"
+const uint32_t ST_RUN_FOOTER_ID             = 0x46525453;   ///< Footer magic: "STRF"
+const uint16_t ST_RUN_FILE_VERSION          = 0x0100;       ///< Format version 0xMMmm
+const uint32_t ST_RUN_CHUNK_ALIGN           = 4096;         ///< Chunk start alignment
+const uint32_t ST_RUN_DEFAULT_FRAMES_PER_CHUNK = 16;        ///< Default chunk size in frames
+const uint32_t ST_RUN_MAX_FRAMES_PER_CHUNK  = 4096;         ///< Max chunk size in frames
+const char     ST_RUN_FILE_EXT[]            = ".strun";     ///< Run container file extension
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Chunk payload coding
+enum StRunCodec
+{
+    ST_RUN_CODEC_NONE           = 0,    ///< Raw frame records
+    ST_RUN_CODEC_SHUFFLE_RLE    = 1,    ///< 4-byte shuffle, then run length coding
+};
+
+#pragma pack(push, 1)
+//----------------------------------------------
+/// File header (64 bytes)
+struct StRunFileHeader
+{
+    uint32_t id;                ///< ST_RUN_FILE_ID
+    uint16_t version;           ///< ST_RUN_FILE_VERSION
+    uint16_t headerBytes;       ///< sizeof(StRunFileHeader)
+    uint16_t frameType;         ///< STSystemType of the first frame
+    uint16_t codec;             ///< Requested chunk codec (StRunCodec)
+    uint32_t framesPerChunk;    ///< Frames per chunk
+    uint64_t createTime;        ///< Creation time (mSec)
+    uint8_t  reserved[40];      ///< Reserved (0)
+};
+
+//----------------------------------------------
+/// Chunk header (64 bytes)
+struct StRunChunkHeader
+{
+    uint32_t id;                ///< ST_RUN_CHUNK_ID
+    uint16_t codec;             ///< Payload coding (StRunCodec)
+    uint16_t reserved1;         ///< Reserved (0)
+    uint32_t firstFrame;        ///< First frame in the chunk
+    uint32_t frameCount;        ///< Frames in the chunk
+    uint64_t rawBytes;          ///< Decoded payload length
+    uint64_t storedBytes;       ///< Stored payload length
+    uint8_t  reserved2[32];     ///< Reserved (0)
+};
+
+//----------------------------------------------
+/// Chunk index entry (32 bytes)
+struct StRunChunkEntry
+{
+    uint64_t offset;            ///< File offset of the chunk header
+    uint64_t storedBytes;       ///< Stored payload length
+    uint64_t rawBytes;          ///< Decoded payload length
+    uint32_t firstFrame;        ///< First frame in the chunk
+    uint16_t codec;             ///< Payload coding (StRunCodec)
+    uint16_t reserved;          ///< Reserved (0)
+};
+
+//----------------------------------------------
+/// Frame index entry (32 bytes)
+struct StRunFrameEntry
+{
+    uint32_t chunk;             ///< Chunk holding the frame
+    uint32_t frameBytes;        ///< Frame record length
+    uint64_t rawOffset;         ///< Record offset in the decoded chunk payload
+    uint64_t telemetryOffset;   ///< Telemetry offset in the telemetry column
+    uint32_t telemetryBytes;    ///< Telemetry length (0 = none)
+    uint32_t reserved;          ///< Reserved (0)
+};
+
+//----------------------------------------------
+/// File footer (96 bytes, at the end of the file)
+struct StRunFooter
+{
+    uint32_t id;                ///< ST_RUN_FOOTER_ID
+    uint16_t version;           ///< ST_RUN_FILE_VERSION
+    uint16_t footerBytes;       ///< sizeof(StRunFooter)
+    uint32_t frameCount;        ///< Frames in the run
+    uint32_t chunkCount;        ///< Chunks in the file
+    uint64_t configOffset;      ///< Run configuration offset
+    uint64_t configBytes;       ///< Run configuration length
+    uint64_t metadataOffset;    ///< Metadata column offset
+    uint64_t telemetryOffset;   ///< Telemetry column offset
+    uint64_t telemetryBytes;    ///< Telemetry column length
+    uint64_t chunkIndexOffset;  ///< Chunk index offset
+    uint64_t frameIndexOffset;  ///< Frame index offset
+    uint8_t  reserved[24];      ///< Reserved (0)
+};
+#pragma pack(pop)
+
+static_assert(sizeof(StRunFileHeader) == 64, "StRunFileHeader size");
+static_assert(sizeof(StRunChunkHeader) == 64, "StRunChunkHeader size");
+static_assert(sizeof(StRunChunkEntry) == 32, "StRunChunkEntry size");
+static_assert(sizeof(StRunFrameEntry) == 32, "StRunFrameEntry size");
+static_assert(sizeof(StRunFooter) == 96, "StRunFooter size");
+
+//******************************************************************
+// Chunk codecs
+//******************************************************************
+
+//------------------------------------------------------------------
+/// Encode a chunk payload
+///
+/// Shuffle: byte b of every 4-byte word goes to plane b, so the mostly
+/// zero high bytes of detector counts line up. Any 1-3 trailing bytes
+/// are copied after the planes.
+///
+/// Run length: a control byte c < 128 is followed by c + 1 literal
+/// bytes. c >= 128 is followed by one byte repeated c - 125 times
+/// (3..130).
+///
+/// @param[in]  codec       StRunCodec
+/// @param[in]  pSrc        raw payload
+/// @param[in]  bytes       raw payload length
+/// @param[out] out         encoded payload
+///
+/// @return 0 if ok, ST_ERR_PARAM for an unknown codec
+///
+inline int32_t runChunkEncode(uint16_t codec, const uint8_t* pSrc, size_t bytes,
+                              std::vector<uint8_t>& out)
+{
+    out.clear();
+    if (ST_RUN_CODEC_NONE == codec)
+    {
+        out.assign(pSrc, pSrc + bytes);
+        return ST_ERR_OK;
+    }
+    if (ST_RUN_CODEC_SHUFFLE_RLE != codec)
+    {
+        return ST_ERR_PARAM;
+    }
+
+    std::vector<uint8_t> planes(bytes);
+    const size_t words = bytes / 4;
+    for (size_t b = 0; b < 4; b++)
+    {
+        uint8_t* pPlane = planes.data() + (b * words);
+        for (size_t i = 0; i < words; i++)
+        {
+            pPlane[i] = pSrc[(i * 4) + b];
+        }
+    }
+    memcpy(planes.data() + (words * 4), pSrc + (words * 4), bytes - (words * 4));
+
+    const uint8_t* p = planes.data();
+    out.reserve(bytes / 2);
+    size_t i = 0;
+    while (i < bytes)
+    {
+        size_t run = 1;
+        while (((i + run) < bytes) && (run < 130) && (p[i + run] == p[i]))
+        {
+            run++;
+        }
+        if (run >= 3)
+        {
+            out.push_back(static_cast<uint8_t>(run + 125));
+            out.push_back(p[i]);
+            i += run;
+            continue;
+        }
+        size_t start = i;
+        size_t len = 0;
+        while ((i < bytes) && (len < 128))
+        {
+            if (((i + 2) < bytes) && (p[i] == p[i + 1]) && (p[i] == p[i + 2]))
+            {
+                break;
+            }
+            i++;
+            len++;
+        }
+        out.push_back(static_cast<uint8_t>(len - 1));
+        out.insert(out.end(), p + start, p + start + len);
+    }
+    return ST_ERR_OK;
+}
+
+//------------------------------------------------------------------
+/// Decode a chunk payload
+///
+/// @param[in]  codec       StRunCodec
+/// @param[in]  pSrc        stored payload
+/// @param[in]  storedBytes stored payload length
+/// @param[out] pDest       decoded payload (rawBytes long)
+/// @param[in]  rawBytes    decoded payload length
+///
+/// @return 0 if ok, ST_ERR_FILE_FORMAT if the payload is corrupt
+///
+inline int32_t runChunkDecode(uint16_t codec, const uint8_t* pSrc, size_t storedBytes,
+                              uint8_t* pDest, size_t rawBytes)
+{
+    if (ST_RUN_CODEC_NONE == codec)
+    {
+        if (storedBytes != rawBytes)
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        memcpy(pDest, pSrc, rawBytes);
+        return ST_ERR_OK;
+    }
+    if (ST_RUN_CODEC_SHUFFLE_RLE != codec)
+    {
+        return ST_ERR_FILE_FORMAT;
+    }
+
+    std::vector<uint8_t> planes(rawBytes);
+    uint8_t* p = planes.data();
+    size_t in = 0;
+    size_t out = 0;
+    while (in < storedBytes)
+    {
+        uint8_t ctrl = pSrc[in++];
+        if (ctrl < 128)
+        {
+            size_t len = static_cast<size_t>(ctrl) + 1;
+            if (((in + len) > storedBytes) || ((out + len) > rawBytes))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+            memcpy(p + out, pSrc + in, len);
+            in += len;
+            out += len;
+        }
+        else
+        {
+            size_t len = static_cast<size_t>(ctrl) - 125;
+            if ((in >= storedBytes) || ((out + len) > rawBytes))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+            memset(p + out, pSrc[in++], len);
+            out += len;
+        }
+    }
+    if (out != rawBytes)
+    {
+        return ST_ERR_FILE_FORMAT;
+    }
+
+    const size_t words = rawBytes / 4;
+    for (size_t b = 0; b < 4; b++)
+    {
+        const uint8_t* pPlane = p + (b * words);
+        for (size_t i = 0; i < words; i++)
+        {
+            pDest[(i * 4) + b] = pPlane[i];
+        }
+    }
+    memcpy(pDest + (words * 4), p + (words * 4), rawBytes - (words * 4));
+    return ST_ERR_OK;
+}
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// StRunWriter class
+///
+/// Writes a run container one frame at a time. Only the current chunk,
+/// the metadata and telemetry columns and the index are held in
+/// memory. The file is valid only after close().
+///
+class StRunWriter
+{
+private:
+    std::ofstream mFile;                        ///< Output file
+    std::string mPath;                          ///< Output path
+    uint16_t mCodec;                            ///< Requested chunk codec
+    uint32_t mFramesPerChunk;                   ///< Frames per chunk
+    uint64_t mOffset;                           ///< Current file offset
+    std::vector<uint8_t> mChunk;                ///< Current chunk raw payload
+    uint32_t mChunkFrames;                      ///< Frames in the current chunk
+    std::vector<uint8_t> mEncoded;              ///< Encoded chunk scratch
+    std::vector<StRunChunkEntry> mChunkIndex;   ///< Written chunks
+    std::vector<StRunFrameEntry> mFrameIndex;   ///< Written frames
+    std::vector<STFrameMetadata> mMetadata;     ///< Metadata column
+    std::vector<uint8_t> mTelemetry;            ///< Telemetry column
+    std::string mConfig;                        ///< Run configuration JSON
+    bool mHeaderWritten;                        ///< File header written
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StRunWriter()
+        : mCodec(ST_RUN_CODEC_NONE)
+        , mFramesPerChunk(ST_RUN_DEFAULT_FRAMES_PER_CHUNK)
+        , mOffset(0)
+        , mChunkFrames(0)
+        , mHeaderWritten(false)
+    {
+    }
+
+    //----------------------------------------------
+    /// Destructor - completes the file
+    ~StRunWriter()
+    {
+        close();
+    }
+
+    StRunWriter(const StRunWriter&) = delete;
+    StRunWriter& operator=(const StRunWriter&) = delete;
+
+    //----------------------------------------------
+    /// Create a container file
+    ///
+    /// @param[in] path             output file (replaced if it exists)
+    /// @param[in] codec            chunk codec (StRunCodec)
+    /// @param[in] framesPerChunk   frames per chunk
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t open(const std::string& path,
+                 uint16_t codec = ST_RUN_CODEC_NONE,
+                 uint32_t framesPerChunk = ST_RUN_DEFAULT_FRAMES_PER_CHUNK)
+    {
+        close();
+        if ((ST_RUN_CODEC_NONE != codec) && (ST_RUN_CODEC_SHUFFLE_RLE != codec))
+        {
+            return ST_ERR_PARAM;
+        }
+        if ((0 == framesPerChunk) || (framesPerChunk > ST_RUN_MAX_FRAMES_PER_CHUNK))
+        {
+            return ST_ERR_PARAM;
+        }
+        mFile.clear();
+        mFile.open(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!mFile)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        mPath = path;
+        mCodec = codec;
+        mFramesPerChunk = framesPerChunk;
+        mOffset = 0;
+        mChunk.clear();
+        mChunkFrames = 0;
+        mChunkIndex.clear();
+        mFrameIndex.clear();
+        mMetadata.clear();
+        mTelemetry.clear();
+        mConfig.clear();
+        mHeaderWritten = false;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// True if a file is open
+    bool isOpen(void) const { return mFile.is_open(); }
+
+    //----------------------------------------------
+    /// Frames written so far
+    uint32_t getFrameCount(void) const { return static_cast<uint32_t>(mFrameIndex.size()); }
+
+    //----------------------------------------------
+    /// Set the run configuration (stored as written, typically JSON)
+    void setConfig(const std::string& config) { mConfig = config; }
+
+    //----------------------------------------------
+    /// Append a frame
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t addFrame(StFrameBuffer& frame)
+    {
+        if (!mFile.is_open())
+        {
+            return ST_ERR_STATE;
+        }
+        const uint8_t* pFrame = frame.getBufferPtr();
+        uint32_t frameBytes = frame.getFrameBytes();
+        if ((nullptr == pFrame) || (0 == frameBytes))
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        int32_t rtn = ST_ERR_OK;
+        if (!mHeaderWritten)
+        {
+            rtn = writeFileHeader(frame.getFrameType());
+            if (0 != rtn)
+            {
+                return rtn;
+            }
+        }
+
+        StRunFrameEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.chunk = static_cast<uint32_t>(mChunkIndex.size());
+        entry.frameBytes = frameBytes;
+        entry.rawOffset = mChunk.size();
+        entry.telemetryOffset = mTelemetry.size();
+        const uint8_t* pTelem = reinterpret_cast<const uint8_t*>(frame.getTelemetryPtr());
+        if (nullptr != pTelem)
+        {
+            entry.telemetryBytes = frame.getTelemetryBytes();
+            mTelemetry.insert(mTelemetry.end(), pTelem, pTelem + entry.telemetryBytes);
+        }
+        STFrameMetadata meta;
+        memset(&meta, 0, sizeof(meta));
+        frame.getMetadata(&meta);
+
+        mChunk.insert(mChunk.end(), pFrame, pFrame + frameBytes);
+        mFrameIndex.push_back(entry);
+        mMetadata.push_back(meta);
+        if (++mChunkFrames >= mFramesPerChunk)
+        {
+            rtn = flushChunk();
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Write the last chunk, the columns, the index and the footer, and
+    /// close the file
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t close(void)
+    {
+        if (!mFile.is_open())
+        {
+            return ST_ERR_OK;
+        }
+        int32_t rtn = mHeaderWritten ? ST_ERR_OK : writeFileHeader(ST_SYS_NONE);
+        rtn = (0 == rtn) ? flushChunk() : rtn;
+
+        StRunFooter footer;
+        memset(&footer, 0, sizeof(footer));
+        footer.id = ST_RUN_FOOTER_ID;
+        footer.version = ST_RUN_FILE_VERSION;
+        footer.footerBytes = static_cast<uint16_t>(sizeof(footer));
+        footer.frameCount = static_cast<uint32_t>(mFrameIndex.size());
+        footer.chunkCount = static_cast<uint32_t>(mChunkIndex.size());
+        footer.configOffset = mOffset;
+        footer.configBytes = mConfig.size();
+        rtn = (0 == rtn) ? write(mConfig.data(), mConfig.size()) : rtn;
+        footer.metadataOffset = mOffset;
+        rtn = (0 == rtn) ? write(mMetadata.data(), mMetadata.size() * sizeof(STFrameMetadata)) : rtn;
+        footer.telemetryOffset = mOffset;
+        footer.telemetryBytes = mTelemetry.size();
+        rtn = (0 == rtn) ? write(mTelemetry.data(), mTelemetry.size()) : rtn;
+        footer.chunkIndexOffset = mOffset;
+        rtn = (0 == rtn) ? write(mChunkIndex.data(), mChunkIndex.size() * sizeof(StRunChunkEntry)) : rtn;
+        footer.frameIndexOffset = mOffset;
+        rtn = (0 == rtn) ? write(mFrameIndex.data(), mFrameIndex.size() * sizeof(StRunFrameEntry)) : rtn;
+        rtn = (0 == rtn) ? write(&footer, sizeof(footer)) : rtn;
+
+        mFile.close();
+        if ((0 == rtn) && mFile.fail())
+        {
+            rtn = ST_ERR_FILE_WRITE;
+        }
+        mChunk.clear();
+        mEncoded.clear();
+        mMetadata.clear();
+        mTelemetry.clear();
+        return rtn;
+    }
+
+private:
+    //----------------------------------------------
+    // Write bytes and advance mOffset
+    int32_t write(const void* pData, size_t bytes)
+    {
+        if ((0 != bytes) && !mFile.write(static_cast<const char*>(pData), static_cast<std::streamsize>(bytes)))
+        {
+            return ST_ERR_FILE_WRITE;
+        }
+        mOffset += bytes;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    // Write the file header
+    int32_t writeFileHeader(STSystemType frameType)
+    {
+        StRunFileHeader header;
+        memset(&header, 0, sizeof(header));
+        header.id = ST_RUN_FILE_ID;
+        header.version = ST_RUN_FILE_VERSION;
+        header.headerBytes = static_cast<uint16_t>(sizeof(header));
+        header.frameType = static_cast<uint16_t>(frameType);
+        header.codec = mCodec;
+        header.framesPerChunk = mFramesPerChunk;
+        header.createTime = STUTIL::Timer::getTimeStampMSec();
+        mHeaderWritten = true;
+        return write(&header, sizeof(header));
+    }
+
+    //----------------------------------------------
+    // Write the current chunk, coded if that makes it smaller
+    int32_t flushChunk(void)
+    {
+        if (0 == mChunkFrames)
+        {
+            return ST_ERR_OK;
+        }
+        static const uint8_t zeros[ST_RUN_CHUNK_ALIGN] = {};
+        int32_t rtn = write(zeros, (ST_RUN_CHUNK_ALIGN - (mOffset % ST_RUN_CHUNK_ALIGN)) % ST_RUN_CHUNK_ALIGN);
+
+        uint16_t codec = ST_RUN_CODEC_NONE;
+        const std::vector<uint8_t>* pPayload = &mChunk;
+        if ((0 == rtn) && (ST_RUN_CODEC_NONE != mCodec))
+        {
+            rtn = runChunkEncode(mCodec, mChunk.data(), mChunk.size(), mEncoded);
+            if ((0 == rtn) && (mEncoded.size() < mChunk.size()))
+            {
+                codec = mCodec;
+                pPayload = &mEncoded;
+            }
+        }
+
+        StRunChunkHeader header;
+        memset(&header, 0, sizeof(header));
+        header.id = ST_RUN_CHUNK_ID;
+        header.codec = codec;
+        header.firstFrame = static_cast<uint32_t>(mFrameIndex.size() - mChunkFrames);
+        header.frameCount = mChunkFrames;
+        header.rawBytes = mChunk.size();
+        header.storedBytes = pPayload->size();
+
+        StRunChunkEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.offset = mOffset;
+        entry.storedBytes = header.storedBytes;
+        entry.rawBytes = header.rawBytes;
+        entry.firstFrame = header.firstFrame;
+        entry.codec = codec;
+
+        rtn = (0 == rtn) ? write(&header, sizeof(header)) : rtn;
+        rtn = (0 == rtn) ? write(pPayload->data(), pPayload->size()) : rtn;
+        if (0 == rtn)
+        {
+            mChunkIndex.push_back(entry);
+        }
+        mChunk.clear();
+        mChunkFrames = 0;
+        return rtn;
+    }
+};  // class StRunWriter
+
+//------------------------------------------------------------------
+/// StRunReader class
+///
+/// Maps a run container read-only. Frames in raw chunks are returned
+/// as pointers into the mapping. Coded chunks are decoded once into a
+/// one-chunk cache, so a sequential scan decodes each chunk once.
+/// Every frame access also asks the OS to read the next chunk ahead.
+///
+class StRunReader
+{
+private:
+    STUTIL::MapFile mFile;                  ///< Mapped container
+    const StRunFileHeader* mpHeader;        ///< File header (in the mapping)
+    const StRunFooter* mpFooter;            ///< Footer (in the mapping)
+    const StRunChunkEntry* mpChunks;        ///< Chunk index (in the mapping)
+    const StRunFrameEntry* mpFrames;        ///< Frame index (in the mapping)
+    const STFrameMetadata* mpMetadata;      ///< Metadata column (in the mapping)
+    const uint8_t* mpTelemetry;             ///< Telemetry column (in the mapping)
+    std::vector<uint8_t> mDecoded;          ///< Decoded chunk cache
+    uint32_t mDecodedChunk;                 ///< Chunk in mDecoded (UINT32_MAX = none)
+    uint32_t mPrefetchedChunk;              ///< Last chunk passed to prefetch
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StRunReader()
+    {
+        reset();
+    }
+
+    StRunReader(const StRunReader&) = delete;
+    StRunReader& operator=(const StRunReader&) = delete;
+
+    //----------------------------------------------
+    /// Map and validate a container file
+    ///
+    /// @return 0 if ok, ST_ERR_FILE_FORMAT if the file is not a complete
+    ///         container, else negative error code
+    ///
+    int32_t open(const std::string& path)
+    {
+        close();
+        int32_t rtn = mFile.open(path);
+        if (0 != rtn)
+        {
+            return rtn;
+        }
+        rtn = validate();
+        if (0 != rtn)
+        {
+            close();
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Unmap the file
+    void close(void)
+    {
+        mFile.close();
+        reset();
+    }
+
+    //----------------------------------------------
+    /// True if a container is open
+    bool isOpen(void) const { return nullptr != mpFooter; }
+
+    //----------------------------------------------
+    /// Frames in the run
+    uint32_t getFrameCount(void) const { return isOpen() ? mpFooter->frameCount : 0; }
+
+    //----------------------------------------------
+    /// Chunks in the file
+    uint32_t getChunkCount(void) const { return isOpen() ? mpFooter->chunkCount : 0; }
+
+    //----------------------------------------------
+    /// System type of the run frames
+    STSystemType getFrameType(void) const
+    {
+        return isOpen() ? static_cast<STSystemType>(mpHeader->frameType) : ST_SYS_NONE;
+    }
+
+    //----------------------------------------------
+    /// Get the run configuration
+    int32_t getConfig(std::string& config) const
+    {
+        if (!isOpen())
+        {
+            return ST_ERR_STATE;
+        }
+        config.assign(reinterpret_cast<const char*>(mFile.data() + mpFooter->configOffset),
+                      static_cast<size_t>(mpFooter->configBytes));
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Get a frame's metadata from the metadata column
+    int32_t getMetadata(uint32_t frameNumber, STFrameMetadata& meta) const
+    {
+        if (frameNumber >= getFrameCount())
+        {
+            return ST_ERR_FRAME_NUMBER;
+        }
+        memcpy(&meta, mpMetadata + frameNumber, sizeof(meta));
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Get a frame's telemetry from the telemetry column (no copy)
+    ///
+    /// @param[in]  frameNumber     frame
+    /// @param[out] pData           telemetry (nullptr if the frame has none)
+    /// @param[out] bytes           telemetry length
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t getTelemetry(uint32_t frameNumber, const uint8_t*& pData, uint32_t& bytes) const
+    {
+        if (frameNumber >= getFrameCount())
+        {
+            return ST_ERR_FRAME_NUMBER;
+        }
+        const StRunFrameEntry& entry = mpFrames[frameNumber];
+        bytes = entry.telemetryBytes;
+        pData = (0 != bytes) ? (mpTelemetry + entry.telemetryOffset) : nullptr;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Get a frame record
+    ///
+    /// The pointer stays valid until the next call or close(). It points
+    /// into the mapping for raw chunks, or into the decoded chunk cache.
+    ///
+    /// @param[in]  frameNumber     frame
+    /// @param[out] pData           StFrameBuffer record
+    /// @param[out] bytes           record length
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t getFrameData(uint32_t frameNumber, const uint8_t*& pData, uint32_t& bytes)
+    {
+        if (frameNumber >= getFrameCount())
+        {
+            return ST_ERR_FRAME_NUMBER;
+        }
+        const StRunFrameEntry& entry = mpFrames[frameNumber];
+        const StRunChunkEntry& chunk = mpChunks[entry.chunk];
+        prefetchChunk(entry.chunk + 1);
+        const uint8_t* pPayload = mFile.data() + chunk.offset + sizeof(StRunChunkHeader);
+        if (ST_RUN_CODEC_NONE != chunk.codec)
+        {
+            if (mDecodedChunk != entry.chunk)
+            {
+                mDecoded.resize(static_cast<size_t>(chunk.rawBytes));
+                mDecodedChunk = UINT32_MAX;
+                int32_t rtn = runChunkDecode(chunk.codec, pPayload, static_cast<size_t>(chunk.storedBytes),
+                                             mDecoded.data(), mDecoded.size());
+                if (0 != rtn)
+                {
+                    return rtn;
+                }
+                mDecodedChunk = entry.chunk;
+            }
+            pPayload = mDecoded.data();
+        }
+        pData = pPayload + entry.rawOffset;
+        bytes = entry.frameBytes;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Copy a frame into a frame buffer
+    ///
+    /// The buffer is reallocated only if the record length changes.
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t getFrame(uint32_t frameNumber, StFrameBuffer& frame)
+    {
+        const uint8_t* pData = nullptr;
+        uint32_t bytes = 0;
+        int32_t rtn = getFrameData(frameNumber, pData, bytes);
+        if (0 != rtn)
+        {
+            return rtn;
+        }
+        StFrameHeader header;
+        if (bytes < sizeof(header))
+        {
+            return ST_ERR_FRAME_SIZE;
+        }
+        memcpy(&header, pData, sizeof(header));
+        if ((ST_FRAME_ID != header.id) || (header.frameBytes != bytes))
+        {
+            return ST_ERR_FRAME_STRUCTURE;
+        }
+        if (frame.getFrameBytes() != bytes)
+        {
+            frame = StFrameBuffer(static_cast<STSystemType>(header.frameType),
+                                  0 == header.telemetryBytes, header.imageBytes,
+                                  header.data1Bytes, header.data2Bytes, header.data3Bytes);
+            if (frame.getFrameBytes() != bytes)
+            {
+                return ST_ERR_FRAME_SIZE;
+            }
+        }
+        memcpy(frame.getBufferPtr(), pData, bytes);
+        return frame.updateFrameHeader();
+    }
+
+private:
+    //----------------------------------------------
+    // Clear all mapping pointers
+    void reset(void)
+    {
+        mpHeader = nullptr;
+        mpFooter = nullptr;
+        mpChunks = nullptr;
+        mpFrames = nullptr;
+        mpMetadata = nullptr;
+        mpTelemetry = nullptr;
+        mDecoded.clear();
+        mDecodedChunk = UINT32_MAX;
+        mPrefetchedChunk = UINT32_MAX;
+    }
+
+    //----------------------------------------------
+    // True if [offset, offset + bytes) is inside the file
+    bool inFile(uint64_t offset, uint64_t bytes) const
+    {
+        return (offset <= mFile.size()) && (bytes <= (mFile.size() - offset));
+    }
+
+    //----------------------------------------------
+    // Check the header, footer, sections and index entries
+    int32_t validate(void)
+    {
+        const uint8_t* pBase = mFile.data();
+        size_t size = mFile.size();
+        if (size < (sizeof(StRunFileHeader) + sizeof(StRunFooter)))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        const StRunFileHeader* pHeader = reinterpret_cast<const StRunFileHeader*>(pBase);
+        const StRunFooter* pFooter = reinterpret_cast<const StRunFooter*>(pBase + size - sizeof(StRunFooter));
+        if ((ST_RUN_FILE_ID != pHeader->id) || ((pHeader->version >> 8) != (ST_RUN_FILE_VERSION >> 8)) ||
+            (ST_RUN_FOOTER_ID != pFooter->id) || ((pFooter->version >> 8) != (ST_RUN_FILE_VERSION >> 8)) ||
+            (sizeof(StRunFooter) != pFooter->footerBytes))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        if (!inFile(pFooter->configOffset, pFooter->configBytes) ||
+            !inFile(pFooter->metadataOffset, static_cast<uint64_t>(pFooter->frameCount) * sizeof(STFrameMetadata)) ||
+            !inFile(pFooter->telemetryOffset, pFooter->telemetryBytes) ||
+            !inFile(pFooter->chunkIndexOffset, static_cast<uint64_t>(pFooter->chunkCount) * sizeof(StRunChunkEntry)) ||
+            !inFile(pFooter->frameIndexOffset, static_cast<uint64_t>(pFooter->frameCount) * sizeof(StRunFrameEntry)))
+        {
+            return ST_ERR_FILE_FORMAT;
+        }
+        const StRunChunkEntry* pChunks = reinterpret_cast<const StRunChunkEntry*>(pBase + pFooter->chunkIndexOffset);
+        const StRunFrameEntry* pFrames = reinterpret_cast<const StRunFrameEntry*>(pBase + pFooter->frameIndexOffset);
+        for (uint32_t c = 0; c < pFooter->chunkCount; c++)
+        {
+            const StRunChunkEntry& chunk = pChunks[c];
+            if (!inFile(chunk.offset, sizeof(StRunChunkHeader) + chunk.storedBytes) ||
+                ((ST_RUN_CODEC_NONE == chunk.codec) && (chunk.storedBytes != chunk.rawBytes)) ||
+                ((ST_RUN_CODEC_NONE != chunk.codec) && (ST_RUN_CODEC_SHUFFLE_RLE != chunk.codec)))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+            const StRunChunkHeader* pChunk = reinterpret_cast<const StRunChunkHeader*>(pBase + chunk.offset);
+            if ((ST_RUN_CHUNK_ID != pChunk->id) || (pChunk->storedBytes != chunk.storedBytes))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+        }
+        for (uint32_t n = 0; n < pFooter->frameCount; n++)
+        {
+            const StRunFrameEntry& frame = pFrames[n];
+            if ((frame.chunk >= pFooter->chunkCount) ||
+                (frame.rawOffset > pChunks[frame.chunk].rawBytes) ||
+                (frame.frameBytes > (pChunks[frame.chunk].rawBytes - frame.rawOffset)) ||
+                (frame.telemetryOffset > pFooter->telemetryBytes) ||
+                (frame.telemetryBytes > (pFooter->telemetryBytes - frame.telemetryOffset)))
+            {
+                return ST_ERR_FILE_FORMAT;
+            }
+        }
+        mpHeader = pHeader;
+        mpFooter = pFooter;
+        mpChunks = pChunks;
+        mpFrames = pFrames;
+        mpMetadata = reinterpret_cast<const STFrameMetadata*>(pBase + pFooter->metadataOffset);
+        mpTelemetry = pBase + pFooter->telemetryOffset;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    // Ask the OS to read a chunk ahead (once per chunk)
+    void prefetchChunk(uint32_t chunk)
+    {
+        if ((chunk < mpFooter->chunkCount) && (chunk != mPrefetchedChunk))
+        {
+            mPrefetchedChunk = chunk;
+            mFile.prefetch(static_cast<size_t>(mpChunks[chunk].offset),
+                           static_cast<size_t>(sizeof(StRunChunkHeader) + mpChunks[chunk].storedBytes));
+        }
+    }
+};  // class StRunReader
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_RUN_CONTAINER_H
@@ -0,0 +1,772 @@
+//*******************************************************************
+/// @file st_shm_ring.h
+/// Sydor Server Interface shared-memory frame ring
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// When a client runs on the same host as the server, live view frames
+/// do not need to go through the ZeroMQ socket. The server application
+/// publishes each sample frame into a POSIX shared-memory segment named
+/// after its port (the simulated server does this, see
+/// StSimResponseHandler::enableShmTransport()). A reader on the same
+/// host attaches by name and reads frames straight from the segment,
+/// with no serialization and no socket copy.
+///
+/// Segment layout (all offsets from the start of the segment):
+///
+///     0       StShmRingHeader (64 bytes)
+///     64      StShmSlotHeader[slotCount] (64 bytes each)
+///     data    slot data, page aligned, slotStride bytes per slot
+///
+/// Each slot holds one complete StFrameBuffer record (header, image,
+/// telemetry and data sections, as in getBufferPtr()).
+///
+/// Publishing (one writer, the server):
+/// - the newest slot is never overwritten, so a reader can always get
+///   the latest frame
+/// - a slot is reused only when its reference count is zero. The
+///   writer first clears the slot sequence and then checks the count.
+///   The reader first increments the count and then checks the
+///   sequence. Both use sequentially consistent atomics, so at least
+///   one of them sees the other and a held slot is never overwritten.
+/// - if every other slot is held by readers, the frame is skipped
+///   (ST_ERR_BUSY), like setSampleFrame()
+///
+/// Readers wait on a 32-bit futex word that the writer increments on
+/// each publish. The writer makes the wake system call only when a
+/// reader is waiting. On non-Linux POSIX hosts readers poll instead.
+///
+/// If a reader process dies while it holds a slot, that slot stays
+/// held until the server recreates the ring. Keep references short.
+///
+/// @note Only the simulated server publishes a ring, and the driver
+/// does not attach to one. mLocalServer still receives frames over the
+/// ZeroMQ socket, even when the server runs on the same host.
+///
+//*******************************************************************
+#ifndef ST_SHM_RING_H
+#define ST_SHM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <new>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __linux__
+#include <climits>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+#include "st_errors.h"
+#include "stutil_misc.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_SHM_RING_MAGIC            = 0x52535453;   ///< 'STSR'
+const uint32_t ST_SHM_RING_VERSION          = 1;            ///< Segment layout version
+const uint32_t ST_SHM_RING_MIN_SLOTS        = 2;            ///< Min slots (latest + one to write)
+const uint32_t ST_SHM_RING_MAX_SLOTS        = 64;           ///< Max slots
+const uint32_t ST_SHM_RING_DEFAULT_SLOTS    = 8;            ///< Default slot count
+const uint64_t ST_SHM_RING_DEFAULT_SLOT_BYTES = 8ULL << 20; ///< Default slot size (8 MiB)
+const uint64_t ST_SHM_RING_MAX_SLOT_BYTES   = 1ULL << 30;   ///< Max slot size (1 GiB)
+const uint32_t ST_SHM_RING_PAGE_BYTES       = 4096;         ///< Slot data alignment
+const uint32_t ST_SHM_RING_SLOT_BITS        = 8;            ///< Slot index bits in StShmRingHeader::latest
+const uint32_t ST_SHM_RING_POLL_USEC        = 500;          ///< Reader poll interval without futex
+
+static_assert((ATOMIC_INT_LOCK_FREE == 2) && (ATOMIC_LLONG_LOCK_FREE == 2),
+              "shared-memory ring needs address-free (lock-free) atomics");
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Segment header (offset 0)
+struct StShmRingHeader
+{
+    std::atomic<uint32_t> magic;        ///< ST_SHM_RING_MAGIC once initialized
+    uint32_t version;                   ///< ST_SHM_RING_VERSION
+    uint32_t slotCount;                 ///< Number of slots
+    uint32_t dataOffset;                ///< Offset of slot 0 data
+    uint64_t slotBytes;                 ///< Max frame bytes per slot
+    uint64_t slotStride;                ///< Bytes between slot data blocks
+    uint64_t segmentBytes;              ///< Total segment size
+    std::atomic<uint64_t> latest;       ///< (seq << ST_SHM_RING_SLOT_BITS) | slot, 0 = none
+    std::atomic<uint32_t> isOpen;       ///< 0 once the server has closed or replaced the ring
+    std::atomic<uint32_t> futexWord;    ///< Incremented on each publish and on close
+    std::atomic<uint32_t> waiters;      ///< Readers blocked on futexWord
+    uint32_t rsvd;                      ///< Reserved (0)
+};
+
+//----------------------------------------------
+/// Slot header (offset 64 + 64 * slot)
+struct StShmSlotHeader
+{
+    std::atomic<uint64_t> seq;          ///< Frame sequence held by the slot (0 = being written)
+    std::atomic<uint32_t> refCount;     ///< Readers holding the slot
+    uint32_t frameBytes;                ///< Frame record length
+    uint8_t rsvd[48];                   ///< Pad to 64 bytes (one cache line)
+};
+
+static_assert(sizeof(StShmRingHeader) == 64, "StShmRingHeader must be 64 bytes");
+static_assert(sizeof(StShmSlotHeader) == 64, "StShmSlotHeader must be 64 bytes");
+
+//----------------------------------------------
+/// Writer and reader counters
+struct StShmRingStats
+{
+    uint64_t published;     ///< Frames published
+    uint64_t skippedBusy;   ///< Frames skipped because every free slot was held
+    uint64_t acquired;      ///< Frames acquired by this reader
+    uint64_t retries;       ///< Acquires repeated because the slot was being reused
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// One mapping of a ring segment. Shared by the ring and the frame
+/// references taken from it, so a reference stays valid after the
+/// ring is closed or re-attached.
+class StShmSegment
+{
+private:
+    void* mpBase;           ///< Mapping base
+    size_t mBytes;          ///< Mapping length
+
+public:
+    StShmSegment(void* pBase, size_t bytes) : mpBase(pBase), mBytes(bytes) {}
+
+    ~StShmSegment()
+    {
+#ifndef _WIN32
+        if (nullptr != mpBase)
+        {
+            munmap(mpBase, mBytes);
+        }
+#endif
+    }
+
+    StShmSegment(const StShmSegment&) = delete;
+    StShmSegment& operator=(const StShmSegment&) = delete;
+
+    uint8_t* getBase(void) { return static_cast<uint8_t*>(mpBase); }   ///< Mapping base
+    size_t getBytes(void) const { return mBytes; }                     ///< Mapping length
+
+    //----------------------------------------------
+    /// Ring header
+    StShmRingHeader* getHeader(void) { return reinterpret_cast<StShmRingHeader*>(mpBase); }
+
+    //----------------------------------------------
+    /// Slot header
+    StShmSlotHeader* getSlot(uint32_t slot)
+    {
+        return reinterpret_cast<StShmSlotHeader*>(getBase() + sizeof(StShmRingHeader)) + slot;
+    }
+
+    //----------------------------------------------
+    /// Slot data
+    uint8_t* getSlotData(uint32_t slot)
+    {
+        StShmRingHeader* pHeader = getHeader();
+        return getBase() + pHeader->dataOffset + (slot * pHeader->slotStride);
+    }
+};
+
+//------------------------------------------------------------------
+/// A frame held in a ring slot
+///
+/// The slot cannot be reused while the reference is held. The frame
+/// is read in place through getData() or getHeader(), or copied with
+/// copyTo(). The slot is released by release() or the destructor.
+///
+class StShmFrameRef
+{
+    friend class StShmFrameRing;
+
+private:
+    std::shared_ptr<StShmSegment> mSegment; ///< Keeps the mapping alive
+    StShmSlotHeader* mpSlot;                ///< Held slot (nullptr = none)
+    const uint8_t* mpData;                  ///< Frame record
+    uint32_t mBytes;                        ///< Frame record length
+    uint64_t mSeq;                          ///< Frame sequence
+
+public:
+    StShmFrameRef() : mpSlot(nullptr), mpData(nullptr), mBytes(0), mSeq(0) {}
+
+    ~StShmFrameRef() { release(); }
+
+    StShmFrameRef(const StShmFrameRef&) = delete;
+    StShmFrameRef& operator=(const StShmFrameRef&) = delete;
+
+    //----------------------------------------------
+    /// Move constructor
+    StShmFrameRef(StShmFrameRef&& other)
+        : mSegment(std::move(other.mSegment)), mpSlot(other.mpSlot),
+          mpData(other.mpData), mBytes(other.mBytes), mSeq(other.mSeq)
+    {
+        other.mpSlot = nullptr;
+        other.mpData = nullptr;
+        other.mBytes = 0;
+    }
+
+    //----------------------------------------------
+    /// Move assignment
+    StShmFrameRef& operator=(StShmFrameRef&& other)
+    {
+        if (this != &other)
+        {
+            release();
+            mSegment = std::move(other.mSegment);
+            mpSlot = other.mpSlot;
+            mpData = other.mpData;
+            mBytes = other.mBytes;
+            mSeq = other.mSeq;
+            other.mpSlot = nullptr;
+            other.mpData = nullptr;
+            other.mBytes = 0;
+        }
+        return *this;
+    }
+
+    bool isValid(void) const { return nullptr != mpSlot; }          ///< true if a slot is held
+    const uint8_t* getData(void) const { return mpData; }           ///< Frame record
+    uint32_t getBytes(void) const { return mBytes; }                ///< Frame record length
+    uint64_t getSeq(void) const { return mSeq; }                    ///< Frame sequence
+
+    //----------------------------------------------
+    /// Frame header, in place
+    const StFrameHeader* getHeader(void) const
+    {
+        return reinterpret_cast<const StFrameHeader*>(mpData);
+    }
+
+    //----------------------------------------------
+    /// Copy the frame into a frame buffer, resizing it if needed
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t copyTo(StFrameBuffer& frame) const
+    {
+        if (!isValid())
+        {
+            return ST_ERR_STATE;
+        }
+        StFrameHeader header;
+        memcpy(&header, mpData, sizeof(header));
+        if ((ST_FRAME_ID != header.id) || (header.frameBytes != mBytes))
+        {
+            return ST_ERR_FRAME_STRUCTURE;
+        }
+        if (frame.getFrameBytes() != mBytes)
+        {
+            frame = StFrameBuffer(static_cast<STSystemType>(header.frameType),
+                                  0 == header.telemetryBytes, header.imageBytes,
+                                  header.data1Bytes, header.data2Bytes, header.data3Bytes);
+            if (frame.getFrameBytes() != mBytes)
+            {
+                return ST_ERR_FRAME_SIZE;
+            }
+        }
+        memcpy(frame.getBufferPtr(), mpData, mBytes);
+        return frame.updateFrameHeader();
+    }
+
+    //----------------------------------------------
+    /// Release the slot
+    void release(void)
+    {
+        if (nullptr != mpSlot)
+        {
+            mpSlot->refCount.fetch_sub(1, std::memory_order_release);
+            mpSlot = nullptr;
+        }
+        mpData = nullptr;
+        mBytes = 0;
+        mSegment.reset();
+    }
+};
+
+//------------------------------------------------------------------
+/// Shared-memory frame ring
+///
+/// The server creates the ring with create() and publishes frames with
+/// publish(). Clients attach() by name and take frames with acquire().
+/// The ring is not thread safe. Each process uses one instance per
+/// thread, or serializes access to it.
+///
+class StShmFrameRing
+{
+private:
+    std::shared_ptr<StShmSegment> mSegment; ///< Current mapping
+    std::string mName;                      ///< Segment name
+    bool mIsOwner;                          ///< true if created by this instance (writer)
+    uint64_t mSeq;                          ///< Last published sequence (writer)
+    uint32_t mNextSlot;                     ///< Next slot to try (writer)
+    StShmRingStats mStats;                  ///< Counters
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    StShmFrameRing() : mIsOwner(false), mSeq(0), mNextSlot(0)
+    {
+        resetStats();
+    }
+
+    //----------------------------------------------
+    /// Destructor
+    ~StShmFrameRing() { close(); }
+
+    StShmFrameRing(const StShmFrameRing&) = delete;
+    StShmFrameRing& operator=(const StShmFrameRing&) = delete;
+
+    //----------------------------------------------
+    /// Get the segment name used by the server on a TCP port
+    static std::string makeName(const char* port)
+    {
+        return std::string("/st_frames_") + (((nullptr == port) || ('\0' == *port)) ? ST_INTERFACE_PORT : port);
+    }
+
+    bool isOpen(void) const { return nullptr != mSegment; }     ///< true if created or attached
+    bool isOwner(void) const { return mIsOwner; }               ///< true if this is the writer
+    const std::string& getName(void) const { return mName; }    ///< Segment name
+    void getStats(StShmRingStats& stats) const { stats = mStats; } ///< Counters
+    void resetStats(void) { memset(&mStats, 0, sizeof(mStats)); }  ///< Clear counters
+
+    //----------------------------------------------
+    /// Number of slots (0 if not open)
+    uint32_t getSlotCount(void) const
+    {
+        return isOpen() ? mSegment->getHeader()->slotCount : 0;
+    }
+
+    //----------------------------------------------
+    /// Max frame bytes per slot (0 if not open)
+    uint64_t getSlotBytes(void) const
+    {
+        return isOpen() ? mSegment->getHeader()->slotBytes : 0;
+    }
+
+    //----------------------------------------------
+    /// True if the server still publishes to this ring
+    bool isLive(void) const
+    {
+        return isOpen() && (0 != mSegment->getHeader()->isOpen.load(std::memory_order_acquire));
+    }
+
+    //----------------------------------------------
+    /// Sequence of the newest frame (0 = none)
+    uint64_t getLatestSeq(void) const
+    {
+        return isOpen() ? (mSegment->getHeader()->latest.load(std::memory_order_acquire) >> ST_SHM_RING_SLOT_BITS) : 0;
+    }
+
+    //----------------------------------------------
+    /// Create the ring (server). An existing segment with the same
+    /// name is marked closed for its readers and replaced.
+    ///
+    /// @param[in] name         segment name (see makeName())
+    /// @param[in] slotCount    number of slots
+    /// @param[in] slotBytes    max frame bytes per slot
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t create(const std::string& name, uint32_t slotCount, uint64_t slotBytes)
+    {
+#ifdef _WIN32
+        (void)name; (void)slotCount; (void)slotBytes;
+        return ST_ERR_NOT_IMPL;
+#else
+        if (name.empty() || (slotCount < ST_SHM_RING_MIN_SLOTS) || (slotCount > ST_SHM_RING_MAX_SLOTS) ||
+            (slotBytes < ST_FRAME_HEADER_BYTES) || (slotBytes > ST_SHM_RING_MAX_SLOT_BYTES))
+        {
+            return ST_ERR_PARAM;
+        }
+        close();
+        retireSegment(name);
+
+        uint64_t slotStride = STUTIL::roundUp(slotBytes, ST_SHM_RING_PAGE_BYTES);
+        uint64_t dataOffset = STUTIL::roundUp(static_cast<uint64_t>(sizeof(StShmRingHeader)) +
+                                              (sizeof(StShmSlotHeader) * slotCount), ST_SHM_RING_PAGE_BYTES);
+        uint64_t segmentBytes = dataOffset + (slotStride * slotCount);
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+        if (fd < 0)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        void* pBase = MAP_FAILED;
+        if (0 == ftruncate(fd, static_cast<off_t>(segmentBytes)))
+        {
+            pBase = mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (MAP_FAILED == pBase)
+        {
+            shm_unlink(name.c_str());
+            return ST_ERR_ALLOC;
+        }
+
+        std::shared_ptr<StShmSegment> segment = std::make_shared<StShmSegment>(pBase, segmentBytes);
+        StShmRingHeader* pHeader = new (pBase) StShmRingHeader();
+        pHeader->version = ST_SHM_RING_VERSION;
+        pHeader->slotCount = slotCount;
+        pHeader->dataOffset = static_cast<uint32_t>(dataOffset);
+        pHeader->slotBytes = slotBytes;
+        pHeader->slotStride = slotStride;
+        pHeader->segmentBytes = segmentBytes;
+        pHeader->latest.store(0, std::memory_order_relaxed);
+        pHeader->isOpen.store(1, std::memory_order_relaxed);
+        pHeader->futexWord.store(0, std::memory_order_relaxed);
+        pHeader->waiters.store(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < slotCount; i++)
+        {
+            StShmSlotHeader* pSlot = new (segment->getSlot(i)) StShmSlotHeader();
+            pSlot->seq.store(0, std::memory_order_relaxed);
+            pSlot->refCount.store(0, std::memory_order_relaxed);
+            pSlot->frameBytes = 0;
+        }
+        pHeader->magic.store(ST_SHM_RING_MAGIC, std::memory_order_release);
+
+        mSegment = segment;
+        mName = name;
+        mIsOwner = true;
+        mSeq = 0;
+        mNextSlot = 0;
+        return ST_ERR_OK;
+#endif
+    }
+
+    //----------------------------------------------
+    /// Attach to a ring created by a server on this host (client)
+    ///
+    /// @param[in] name     segment name (see makeName())
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_AVAILABLE if there is no usable ring,
+    ///         else negative error code
+    ///
+    int32_t attach(const std::string& name)
+    {
+#ifdef _WIN32
+        (void)name;
+        return ST_ERR_NOT_IMPL;
+#else
+        if (name.empty())
+        {
+            return ST_ERR_PARAM;
+        }
+        close();
+
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+        struct stat st;
+        void* pBase = MAP_FAILED;
+        size_t bytes = 0;
+        if ((0 == fstat(fd, &st)) && (static_cast<uint64_t>(st.st_size) >= ST_SHM_RING_PAGE_BYTES))
+        {
+            bytes = static_cast<size_t>(st.st_size);
+            pBase = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (MAP_FAILED == pBase)
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+
+        std::shared_ptr<StShmSegment> segment = std::make_shared<StShmSegment>(pBase, bytes);
+        StShmRingHeader* pHeader = segment->getHeader();
+        if ((ST_SHM_RING_MAGIC != pHeader->magic.load(std::memory_order_acquire)) ||
+            (ST_SHM_RING_VERSION != pHeader->version) ||
+            (pHeader->slotCount < ST_SHM_RING_MIN_SLOTS) || (pHeader->slotCount > ST_SHM_RING_MAX_SLOTS) ||
+            (pHeader->segmentBytes != bytes) || (pHeader->slotBytes > pHeader->slotStride) ||
+            (pHeader->dataOffset < sizeof(StShmRingHeader) + (sizeof(StShmSlotHeader) * pHeader->slotCount)) ||
+            (pHeader->dataOffset + (pHeader->slotStride * pHeader->slotCount) > bytes) ||
+            (0 == pHeader->isOpen.load(std::memory_order_acquire)))
+        {
+            return ST_ERR_NOT_AVAILABLE;
+        }
+
+        mSegment = segment;
+        mName = name;
+        mIsOwner = false;
+        return ST_ERR_OK;
+#endif
+    }
+
+    //----------------------------------------------
+    /// Detach from the ring. The server also marks it closed for its
+    /// readers and removes the name.
+    void close(void)
+    {
+        if (!isOpen())
+        {
+            return;
+        }
+        if (mIsOwner)
+        {
+            markClosed(mSegment->getHeader());
+#ifndef _WIN32
+            shm_unlink(mName.c_str());
+#endif
+        }
+        mSegment.reset();
+        mName.clear();
+        mIsOwner = false;
+    }
+
+    //----------------------------------------------
+    /// Publish a frame (server)
+    ///
+    /// Copies the frame record into a free slot and makes it the
+    /// latest frame. Never blocks on readers.
+    ///
+    /// @param[in] frame    frame to publish
+    ///
+    /// @return 0 if ok, ST_ERR_FRAME_SIZE if the frame does not fit a
+    ///         slot, ST_ERR_BUSY if every free slot is held (frame skipped),
+    ///         else negative error code
+    ///
+    int32_t publish(StFrameBuffer& frame)
+    {
+        return publish(frame.getBufferPtr(), frame.getFrameBytes());
+    }
+
+    //----------------------------------------------
+    /// Publish a frame record (server)
+    ///
+    /// @param[in] pSrc     frame record (StFrameBuffer::getBufferPtr() layout)
+    /// @param[in] bytes    frame record length
+    ///
+    /// @return as publish(StFrameBuffer&)
+    ///
+    int32_t publish(const uint8_t* pSrc, uint32_t bytes)
+    {
+        if (!mIsOwner || !isOpen())
+        {
+            return ST_ERR_STATE;
+        }
+        if (nullptr == pSrc)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        StShmRingHeader* pHeader = mSegment->getHeader();
+        if ((bytes < ST_FRAME_HEADER_BYTES) || (bytes > pHeader->slotBytes))
+        {
+            return ST_ERR_FRAME_SIZE;
+        }
+
+        const uint64_t slotMask = (1ULL << ST_SHM_RING_SLOT_BITS) - 1;
+        uint64_t latest = pHeader->latest.load(std::memory_order_relaxed);
+        uint32_t latestSlot = (0 == latest) ? pHeader->slotCount : static_cast<uint32_t>(latest & slotMask);
+        for (uint32_t i = 0; i < pHeader->slotCount; i++)
+        {
+            uint32_t slot = (mNextSlot + i) % pHeader->slotCount;
+            StShmSlotHeader* pSlot = mSegment->getSlot(slot);
+            if ((slot == latestSlot) || (0 != pSlot->refCount.load(std::memory_order_relaxed)))
+            {
+                continue;
+            }
+            pSlot->seq.store(0, std::memory_order_seq_cst);
+            if (0 != pSlot->refCount.load(std::memory_order_seq_cst))
+            {
+                continue;
+            }
+
+            memcpy(mSegment->getSlotData(slot), pSrc, bytes);
+            pSlot->frameBytes = bytes;
+            uint64_t seq = ++mSeq;
+            pSlot->seq.store(seq, std::memory_order_release);
+            pHeader->latest.store((seq << ST_SHM_RING_SLOT_BITS) | slot, std::memory_order_seq_cst);
+            wake(pHeader);
+            mNextSlot = (slot + 1) % pHeader->slotCount;
+            mStats.published++;
+            return ST_ERR_OK;
+        }
+        mStats.skippedBusy++;
+        return ST_ERR_BUSY;
+    }
+
+    //----------------------------------------------
+    /// Take the latest frame (client)
+    ///
+    /// @param[in]  lastSeq         return only a frame newer than this (0 = any)
+    /// @param[in]  timeoutMSec     max wait for such a frame (0 = do not wait)
+    /// @param[out] ref             frame reference
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_AVAILABLE if there is no such frame,
+    ///         ST_ERR_SVR_NOT_OPEN if the server closed or replaced the
+    ///         ring (attach again), else negative error code
+    ///
+    int32_t acquire(uint64_t lastSeq, uint32_t timeoutMSec, StShmFrameRef& ref)
+    {
+        ref.release();
+        if (!isOpen())
+        {
+            return ST_ERR_STATE;
+        }
+        StShmRingHeader* pHeader = mSegment->getHeader();
+        const uint64_t slotMask = (1ULL << ST_SHM_RING_SLOT_BITS) - 1;
+        const std::chrono::steady_clock::time_point deadline =
+            std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMSec);
+
+        for (;;)
+        {
+            if (0 == pHeader->isOpen.load(std::memory_order_acquire))
+            {
+                return ST_ERR_SVR_NOT_OPEN;
+            }
+            uint32_t word = pHeader->futexWord.load(std::memory_order_seq_cst);
+            uint64_t latest = pHeader->latest.load(std::memory_order_seq_cst);
+            uint64_t seq = latest >> ST_SHM_RING_SLOT_BITS;
+            if ((0 != seq) && (seq > lastSeq))
+            {
+                uint32_t slot = static_cast<uint32_t>(latest & slotMask);
+                if (slot >= pHeader->slotCount)
+                {
+                    return ST_ERR_FRAME_STRUCTURE;
+                }
+                StShmSlotHeader* pSlot = mSegment->getSlot(slot);
+                pSlot->refCount.fetch_add(1, std::memory_order_seq_cst);
+                if (seq == pSlot->seq.load(std::memory_order_seq_cst))
+                {
+                    uint32_t bytes = pSlot->frameBytes;
+                    if ((bytes < ST_FRAME_HEADER_BYTES) || (bytes > pHeader->slotBytes))
+                    {
+                        pSlot->refCount.fetch_sub(1, std::memory_order_release);
+                        return ST_ERR_FRAME_STRUCTURE;
+                    }
+                    ref.mSegment = mSegment;
+                    ref.mpSlot = pSlot;
+                    ref.mpData = mSegment->getSlotData(slot);
+                    ref.mBytes = bytes;
+                    ref.mSeq = seq;
+                    mStats.acquired++;
+                    return ST_ERR_OK;
+                }
+                // Replaced while we looked; the newer frame is in another slot
+                pSlot->refCount.fetch_sub(1, std::memory_order_release);
+                mStats.retries++;
+                continue;
+            }
+
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now >= deadline)
+            {
+                return ST_ERR_NOT_AVAILABLE;
+            }
+            wait(pHeader, word, lastSeq, std::chrono::duration_cast<std::chrono::microseconds>(deadline - now));
+        }
+    }
+
+private:
+    //----------------------------------------------
+    // Mark a stale segment (e.g. from a previous server) closed for
+    // any readers still mapped to it, and remove its name
+    static void retireSegment(const std::string& name)
+    {
+#ifndef _WIN32
+        int fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat st;
+        if ((0 == fstat(fd, &st)) && (static_cast<uint64_t>(st.st_size) >= sizeof(StShmRingHeader)))
+        {
+            void* pBase = mmap(nullptr, sizeof(StShmRingHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (MAP_FAILED != pBase)
+            {
+                StShmRingHeader* pHeader = static_cast<StShmRingHeader*>(pBase);
+                if (ST_SHM_RING_MAGIC == pHeader->magic.load(std::memory_order_acquire))
+                {
+                    markClosed(pHeader);
+                }
+                munmap(pBase, sizeof(StShmRingHeader));
+            }
+        }
+        ::close(fd);
+        shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    //----------------------------------------------
+    // Tell readers the ring is gone and wake them
+    static void markClosed(StShmRingHeader* pHeader)
+    {
+        pHeader->isOpen.store(0, std::memory_order_seq_cst);
+        wake(pHeader);
+    }
+
+    //----------------------------------------------
+    // Advance the futex word and wake waiting readers
+    static void wake(StShmRingHeader* pHeader)
+    {
+        pHeader->futexWord.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+        if (0 != pHeader->waiters.load(std::memory_order_seq_cst))
+        {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pHeader->futexWord), FUTEX_WAKE, INT_MAX,
+                    nullptr, nullptr, 0);
+        }
+#endif
+    }
+
+    //----------------------------------------------
+    // Wait for a publish after futexWord was read as 'word'. Returns
+    // at the timeout, on a publish, or spuriously; the caller rechecks.
+    void wait(StShmRingHeader* pHeader, uint32_t word, uint64_t lastSeq, std::chrono::microseconds timeout)
+    {
+#ifdef __linux__
+        pHeader->waiters.fetch_add(1, std::memory_order_seq_cst);
+        // Recheck after registering, so a publish that missed the
+        // waiter count is seen here instead of slept through
+        uint64_t seq = pHeader->latest.load(std::memory_order_seq_cst) >> ST_SHM_RING_SLOT_BITS;
+        if (((0 == seq) || (seq <= lastSeq)) && (0 != pHeader->isOpen.load(std::memory_order_seq_cst)))
+        {
+            struct timespec ts;
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1000000);
+            ts.tv_nsec = static_cast<long>((timeout.count() % 1000000) * 1000);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&pHeader->futexWord), FUTEX_WAIT, word,
+                    &ts, nullptr, 0);
+        }
+        pHeader->waiters.fetch_sub(1, std::memory_order_seq_cst);
+#else
+        (void)pHeader; (void)word; (void)lastSeq;
+        std::this_thread::sleep_for(std::min(timeout, std::chrono::microseconds(ST_SHM_RING_POLL_USEC)));
+#endif
+    }
+};
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_SHM_RING_H
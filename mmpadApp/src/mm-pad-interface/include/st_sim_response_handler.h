@@ -0,0 +1,1228 @@
+//*******************************************************************
+/// @file st_sim_response_handler.h
+/// Sydor Server simulated response handler
+///
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, all rights reserved.
+///
+/// StSimResponseHandler is a complete ResponseHandler that needs no
+/// detector. It can run in the same process as a ServerInterface, so a
+/// simulated server can be started next to the IOC. The whole
+/// client/server/driver stack can then be tested for throughput and
+/// latency on one host.
+///
+/// - Frames come from StSimData (sweep, grid and dot images with
+///   metadata and telemetry), paced at a configurable frame rate.
+/// - Capture sets and runs are kept in memory. Run frames are stored
+///   as fixed size records in <storage>/<set>/<run>/frames.bin, so
+///   getRunFrame() is a single seek and read. Stored frames do not
+///   change, so getRunFrame() serves repeat and sequential reads from
+///   an StFrameCache (setFrameCacheLimits()).
+/// - calcBackground() averages the frames of a run into
+///   background.bin, which getBackground() returns.
+///   startCalcBackground() does the same as an StAsyncJobManager job
+///   with progress and cancellation.
+/// - Each frame gets a statistics block (st_frame_stats.h,
+///   setFrameStatsConfig()), and getRunFrameStats() reads only that
+///   section of each stored frame.
+/// - Sample frames are published while armed. Telemetry is published
+///   at its own rate, armed or not.
+/// - Sample frames can also be published to a shared-memory frame ring
+///   for readers on the same host (enableShmTransport()).
+/// - Raw register writes are stored, and read back by readRawValue().
+///
+/// The storage directory defaults to a new temporary directory.
+///
+//*******************************************************************
+#ifndef ST_SIM_RESPONSE_HANDLER_H
+#define ST_SIM_RESPONSE_HANDLER_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <fstream>
+#include "st_errors.h"
+#include "st_if_defs.h"
+#include "st_framebuffer.h"
+#include "st_dataindex.h"
+#include "st_sim_data.h"
+#include "st_pixel_kernels.h"
+#include "st_frame_stats.h"
+#include "st_frame_cache.h"
+#include "st_async_job.h"
+#include "st_snapshotbuf.h"
+#include "st_shm_ring.h"
+#include "st_response_handler.h"
+#include "st_if_server.h"
+#include "stutil_file.h"
+#include "stutil_timer.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const double   ST_SIM_DEFAULT_FRAME_RATE    = 100.0;    ///< Default frame rate (Hz)
+const double   ST_SIM_DEFAULT_TELEM_RATE    = 1.0;      ///< Default telemetry rate (Hz)
+const uint32_t ST_SIM_MAX_NAME_LENGTH       = 64;       ///< Max set or run name length
+const char     ST_SIM_FRAMES_FILE[]         = "frames.bin";         ///< Run frame file
+const char     ST_SIM_BACKGROUND_FILE[]     = "background.bin";     ///< Run background file
+const char     ST_SIM_CONFIG_FILE[]         = "config.json";        ///< Run configuration file
+
+/// Run completion codes
+const int32_t  ST_SIM_RUN_ACTIVE            = 0;        ///< Run in progress
+const int32_t  ST_SIM_RUN_MAX_FRAMES        = 1;        ///< Frame count reached
+const int32_t  ST_SIM_RUN_MAX_TIME          = 2;        ///< Run time reached
+const int32_t  ST_SIM_RUN_STOPPED           = 3;        ///< Stopped by stopCaptureRun()
+const int32_t  ST_SIM_RUN_DISK_ERROR        = 4;        ///< Frame file write failed
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Simulator configuration
+struct StSimConfig
+{
+    std::string dataDictionaryPath;     ///< Data dictionary returned to clients
+    std::string calibrationDirPath;     ///< Calibration directory returned to clients
+    std::string storageDir;             ///< Run storage directory ("" = new temp directory)
+    double frameRateHz;                 ///< Frame rate while armed
+    double telemetryRateHz;             ///< Telemetry publish rate (0 = none)
+    STSystemType systemType;            ///< Simulated system
+
+    StSimConfig()
+        : frameRateHz(ST_SIM_DEFAULT_FRAME_RATE)
+        , telemetryRateHz(ST_SIM_DEFAULT_TELEM_RATE)
+        , systemType(ST_SYS_MMPAD)
+    {
+    }
+};
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// StSimResponseHandler class
+class StSimResponseHandler : public ResponseHandler
+{
+private:
+    //----------------------------------------------
+    /// Stored capture run
+    struct SimRun
+    {
+        std::string name;           ///< Run name
+        uint64_t timeStamp;         ///< Start time (mSec)
+        uint32_t frameCount;        ///< Frames stored
+        uint32_t frameBytes;        ///< Bytes per stored frame
+        uint32_t statsOffset;       ///< Statistics section offset in a stored frame
+        uint32_t statsBytes;        ///< Statistics section length (0 = none)
+        uint32_t capCount;          ///< Capacitor count
+        uint32_t capSelect;         ///< Capacitor select flags
+        bool hasBackground;         ///< background.bin exists
+    };
+
+    //----------------------------------------------
+    /// Stored capture set
+    struct SimSet
+    {
+        std::string name;           ///< Set name
+        std::string description;    ///< Set description
+        std::string tags;           ///< Set tags
+        uint64_t timeStamp;         ///< Creation time (mSec)
+        std::vector<SimRun> runs;   ///< Runs in start order
+    };
+
+    typedef std::map<uint64_t, uint32_t> SimRegisterMap;
+
+    StSimConfig mConfig;                ///< Configuration
+    ServerInterface* mpServer;          ///< Server for sample frames and telemetry
+    StSimData mSim;                     ///< Simulated data generator (sim thread only)
+
+    std::mutex mMutex;                  ///< Protects everything below
+    std::condition_variable mCond;      ///< Wakes the sim thread
+    std::thread mThread;                ///< Sim thread
+    bool mQuit;                         ///< Sim thread exit request
+    std::vector<SimSet> mSets;          ///< Capture sets
+    std::string mCurSet;                ///< Current capture set
+    STRunStatus mStatus;                ///< Current or last run status
+    uint64_t mRunStart;                 ///< Run start time (mSec)
+    uint32_t mRunGen;                   ///< Incremented at each run start
+    bool mBgSub;                        ///< Background subtraction enabled
+    SimRegisterMap mRegisters;          ///< Raw register values
+    StFrameStatsConfig mStatsConfig;    ///< Per-frame statistics (flags == 0 = none)
+
+    StShmFrameRing mShmRing;            ///< Same-host sample frame ring (enableShmTransport())
+    std::mutex mShmCS;                  ///< Protects mShmRing
+
+    SnapshotBuf<StFrameBuffer> mLastFrame;  ///< Last generated frame (written by the sim thread only)
+
+    StFrameCache mFrameCache;           ///< Stored run frames (its loader uses the members above)
+    StAsyncJobManager mJobs;            ///< Background jobs (last member: jobs use all the others)
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    ///
+    /// @param[in] config    simulator configuration
+    ///
+    explicit StSimResponseHandler(const StSimConfig& config = StSimConfig())
+        : mConfig(config)
+        , mpServer(nullptr)
+        , mQuit(false)
+        , mRunStart(0)
+        , mRunGen(0)
+        , mBgSub(false)
+        , mFrameCache([this](const StFrameCacheKey& key, StFrameBuffer& frame)
+                      { return readRunFrame(key.setName, key.runName, key.frameNumber, frame); })
+    {
+        if (mConfig.storageDir.empty())
+        {
+            char tmpl[] = "/tmp/mmpad_sim_XXXXXX";
+            if (nullptr != mkdtemp(tmpl))
+            {
+                mConfig.storageDir = tmpl;
+            }
+        }
+        mJobs.start(1);
+        mThread = std::thread(&StSimResponseHandler::simThread, this);
+    }
+
+    //----------------------------------------------
+    /// Destructor - stops the sim thread. Stored runs are kept.
+    virtual ~StSimResponseHandler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mQuit = true;
+            mStatus.armed = false;
+        }
+        mCond.notify_all();
+        if (mThread.joinable())
+        {
+            mThread.join();
+        }
+    }
+
+    StSimResponseHandler(const StSimResponseHandler&) = delete;
+    StSimResponseHandler& operator=(const StSimResponseHandler&) = delete;
+
+    //----------------------------------------------
+    /// Set the server that receives sample frames and telemetry
+    void setServer(ServerInterface* pServer)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mpServer = pServer;
+    }
+
+    //----------------------------------------------
+    /// Get the run storage directory ("" if it could not be created)
+    const std::string& getStorageDir(void) const { return mConfig.storageDir; }
+
+    //----------------------------------------------
+    /// Get the configured frame rate
+    double getFrameRate(void) const { return mConfig.frameRateHz; }
+
+    //----------------------------------------------
+    /// Set the statistics stored with each frame
+    ///
+    /// @param[in] config   statistics selection (flags == 0 disables)
+    ///
+    /// @return 0 if ok, ST_ERR_PARAM if the selection is not valid
+    ///
+    int32_t setFrameStatsConfig(const StFrameStatsConfig& config)
+    {
+        int32_t rtn = config.validate();
+        if (0 == rtn)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStatsConfig = config;
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Get the statistics stored with each frame
+    StFrameStatsConfig getFrameStatsConfig(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStatsConfig;
+    }
+
+    //----------------------------------------------
+    /// Get the statistics blocks of a range of run frames
+    ///
+    /// Only the statistics section of each stored frame is read. Frames
+    /// stored without statistics have flags == 0.
+    ///
+    /// @param[in] setName          Capture set name
+    /// @param[in] runName          Capture run name
+    /// @param[in] startFrame       First frame number
+    /// @param[in] count            Max frames (stops at the end of the run)
+    /// @param[out] stats           One entry per frame
+    ///
+    /// @return 0 if ok, negative error code on any error
+    ///
+    int32_t getRunFrameStats(const std::string& setName, const std::string& runName,
+                             uint32_t startFrame, uint32_t count,
+                             std::vector<StFrameStats>& stats)
+    {
+        SimRun run;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const SimRun* pRun = findRun(setName, runName);
+            if (nullptr == pRun)
+            {
+                return ST_ERR_RUN_NOT_FOUND;
+            }
+            run = *pRun;
+        }
+        if (startFrame >= run.frameCount)
+        {
+            return ST_ERR_FRAME_NUMBER;
+        }
+
+        std::ifstream file(runPath(setName, runName, ST_SIM_FRAMES_FILE).c_str(), std::ios::binary);
+        if (!file)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        uint32_t endFrame = (count < (run.frameCount - startFrame)) ? (startFrame + count) : run.frameCount;
+        std::vector<uint8_t> section(run.statsBytes);
+        stats.clear();
+        for (uint32_t n = startFrame; n < endFrame; n++)
+        {
+            stats.push_back(StFrameStats());
+            if (0 == run.statsBytes)
+            {
+                stats.back().frameNumber = n;
+                continue;
+            }
+            uint64_t offset = (static_cast<uint64_t>(n) * run.frameBytes) + run.statsOffset;
+            if (!file.seekg(static_cast<std::streamoff>(offset)))
+            {
+                return ST_ERR_FILE_SEEK;
+            }
+            if (!file.read(reinterpret_cast<char*>(section.data()), run.statsBytes))
+            {
+                return ST_ERR_FILE_READ;
+            }
+            if (0 != stats.back().fromBytes(section.data(), run.statsBytes))
+            {
+                stats.back() = StFrameStats();
+                stats.back().frameNumber = n;
+            }
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Start calcBackground() as a background job
+    ///
+    /// @param[in]  setName     Capture set name
+    /// @param[in]  runName     Capture run name
+    /// @param[out] jobId       ID for getJobStatus(), waitJob() and cancelJob()
+    ///
+    /// @return 0 if ok, negative error code on any error
+    ///
+    int32_t startCalcBackground(const std::string& setName, const std::string& runName, uint32_t& jobId)
+    {
+        return mJobs.submit(ST_JOB_CALC_BACKGROUND, setName, runName,
+                            [this, setName, runName](StAsyncJobProgress& progress)
+                            { return calcBackgroundJob(setName, runName, progress); },
+                            jobId);
+    }
+
+    //----------------------------------------------
+    /// Get the status of a background job
+    int32_t getJobStatus(uint32_t jobId, StAsyncJobStatus& status) { return mJobs.getStatus(jobId, status); }
+
+    //----------------------------------------------
+    /// Wait up to timeoutMSec (max ST_ASYNC_JOB_MAX_WAIT_MSEC) for a background job
+    int32_t waitJob(uint32_t jobId, StAsyncJobStatus& status, uint32_t timeoutMSec)
+    {
+        return mJobs.wait(jobId, status, timeoutMSec);
+    }
+
+    //----------------------------------------------
+    /// Cancel a background job
+    int32_t cancelJob(uint32_t jobId) { return mJobs.cancel(jobId); }
+
+    //----------------------------------------------
+    /// Set the run frame cache byte budget and read-ahead depth
+    ///
+    /// @param[in] maxBytes     byte budget (0 disables caching)
+    /// @param[in] aheadDepth   frames to read ahead (0 disables read-ahead)
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t setFrameCacheLimits(size_t maxBytes, uint32_t aheadDepth)
+    {
+        return mFrameCache.setLimits(maxBytes, aheadDepth);
+    }
+
+    //----------------------------------------------
+    /// Get run frame cache statistics
+    void getFrameCacheStats(StFrameCacheStats& stats) { mFrameCache.getStats(stats); }
+
+    //----------------------------------------------
+    /// Publish sample frames to a shared-memory ring as well
+    ///
+    /// Readers on this host attach to the ring by port number
+    /// (StShmFrameRing::makeName()) and read frames without a socket
+    /// copy. The ring is replaced by a larger one if a frame does not
+    /// fit a slot.
+    ///
+    /// @param[in] port         server TCP port, which names the ring
+    /// @param[in] slotCount    ring slots (frames readers may hold, plus the latest)
+    /// @param[in] slotBytes    initial max frame bytes per slot
+    ///
+    /// @return 0 if ok, negative error code on any error
+    ///
+    int32_t enableShmTransport(const char* port = ST_INTERFACE_PORT,
+                               uint32_t slotCount = ST_SHM_RING_DEFAULT_SLOTS,
+                               uint64_t slotBytes = ST_SHM_RING_DEFAULT_SLOT_BYTES)
+    {
+        std::lock_guard<std::mutex> lock(mShmCS);
+        return mShmRing.create(StShmFrameRing::makeName(port), slotCount, slotBytes);
+    }
+
+    //----------------------------------------------
+    /// Stop publishing to the shared-memory ring
+    void disableShmTransport(void)
+    {
+        std::lock_guard<std::mutex> lock(mShmCS);
+        mShmRing.close();
+    }
+
+    //----------------------------------------------
+    /// Get shared-memory ring counters
+    void getShmRingStats(StShmRingStats& stats)
+    {
+        std::lock_guard<std::mutex> lock(mShmCS);
+        mShmRing.getStats(stats);
+    }
+
+    //**************************************************************
+    // ResponseHandler methods
+    //**************************************************************
+
+    virtual std::string getDataDictionaryPath(void) { return mConfig.dataDictionaryPath; }
+    virtual std::string getCalibrationDirPath(void) { return mConfig.calibrationDirPath; }
+
+    //----------------------------------------------
+    virtual int32_t readRawValue(StParameter& param, uint32_t* pValue,
+                                 uint32_t index = 0, uint32_t padIndex = 0)
+    {
+        if (nullptr == pValue)
+        {
+            return ST_ERR_NULL_PTR;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        *pValue = getRegister(param, index, padIndex);
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t readRawValueArray(StParameter& param, std::vector<uint32_t>& rawValues,
+                                      uint32_t index, uint32_t count, uint32_t padIndex = 0)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        rawValues.resize(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            rawValues[i] = getRegister(param, index + i, padIndex);
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t writeRawValue(StParameter& param, uint32_t value, uint32_t mask = 0,
+                                  uint32_t index = 0, uint32_t padIndex = 0)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (0 != mask)
+        {
+            value = (getRegister(param, index, padIndex) & ~mask) | (value & mask);
+        }
+        mRegisters[registerKey(param, index, padIndex)] = value;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t startCaptureSet(const std::string& setName,
+                                    const std::string& description,
+                                    const std::string& tags)
+    {
+        if (!setNameIsValid(setName))
+        {
+            return ST_ERR_SET_NAME;
+        }
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStatus.armed)
+        {
+            return ST_ERR_ARMED;
+        }
+        if (nullptr == findSet(setName))
+        {
+            if (0 != STUTIL::makeDirs(mConfig.storageDir, setName))
+            {
+                return ST_ERR_DIR;
+            }
+            SimSet set;
+            set.name = setName;
+            set.timeStamp = STUTIL::Timer::getTimeStampMSec();
+            mSets.push_back(set);
+        }
+        SimSet* pSet = findSet(setName);
+        pSet->description = description;
+        pSet->tags = tags;
+        mCurSet = setName;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t editCaptureSet(const std::string& setName,
+                                   const std::string& description,
+                                   const std::string& tags)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        SimSet* pSet = findSet(setName);
+        if (nullptr == pSet)
+        {
+            return ST_ERR_SET_NOT_FOUND;
+        }
+        pSet->description = description;
+        pSet->tags = tags;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t enableBackgroundSub(bool bEnable)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mBgSub = bEnable;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t batchCorrectRun(const std::string setName, const std::string runName)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return (nullptr == findRun(setName, runName)) ? ST_ERR_RUN_NOT_FOUND : ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Average the frames of a run into its background file
+    virtual int32_t calcBackground(const std::string& setName, const std::string& runName)
+    {
+        StAsyncJobProgress progress;
+        return calcBackgroundJob(setName, runName, progress);
+    }
+
+    //----------------------------------------------
+    /// True while a startCalcBackground() job is queued or running
+    virtual bool calcBackgroundIsBusy(void)
+    {
+        std::vector<StAsyncJobStatus> jobs;
+        mJobs.getAll(jobs);
+        for (const StAsyncJobStatus& job : jobs)
+        {
+            if ((ST_JOB_CALC_BACKGROUND == job.type) && !job.isFinished())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //----------------------------------------------
+    virtual int32_t calcFlatfield(const std::string& setName, const std::string& runName)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return (nullptr == findRun(setName, runName)) ? ST_ERR_RUN_NOT_FOUND : ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t reloadCorr(void) { return ST_ERR_OK; }
+
+    //----------------------------------------------
+    virtual int32_t getRunStats(std::string& setName, std::string& runName, uint32_t& capCnt,
+                                uint32_t& totalFrames, StFrameBuffer& sampleFrame)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            setName = mStatus.setName;
+            runName = mStatus.runName;
+            capCnt = mStatus.capCount;
+            totalFrames = mStatus.frameCount;
+        }
+        // Copy the frame without the lock, so the sim thread never waits for it
+        if (0 != mLastFrame.get(sampleFrame))
+        {
+            sampleFrame = StFrameBuffer(mConfig.systemType);
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual bool runNameExists(const std::string setName, const std::string runName)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return nullptr != findRun(setName, runName);
+    }
+
+    //----------------------------------------------
+    virtual bool setNameIsValid(const std::string setName)
+    {
+        return 0 == STUTIL::checkFileName(setName, ST_SIM_MAX_NAME_LENGTH);
+    }
+
+    //----------------------------------------------
+    virtual bool runNameIsValid(const std::string runName)
+    {
+        return 0 == STUTIL::checkFileName(runName, ST_SIM_MAX_NAME_LENGTH);
+    }
+
+    //----------------------------------------------
+    /// Create the run and arm the sim thread
+    virtual int32_t startCaptureRun(const STRunStatus& runStatus, uint64_t startTime,
+                                    const std::string& configJson)
+    {
+        if (!runNameIsValid(runStatus.runName))
+        {
+            return ST_ERR_RUN_NAME;
+        }
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mStatus.armed)
+        {
+            return ST_ERR_ARMED;
+        }
+        std::string setName = runStatus.setName.empty() ? mCurSet : runStatus.setName;
+        SimSet* pSet = findSet(setName);
+        if (nullptr == pSet)
+        {
+            return ST_ERR_SET_NOT_FOUND;
+        }
+        if (nullptr != findRun(setName, runStatus.runName))
+        {
+            return ST_ERR_RUN_EXISTS;
+        }
+        if (0 != STUTIL::makeDirs(mConfig.storageDir, setName, runStatus.runName))
+        {
+            return ST_ERR_DIR;
+        }
+
+        // Create (empty) frame and config files now, so errors are reported
+        std::ofstream frames(runPath(setName, runStatus.runName, ST_SIM_FRAMES_FILE).c_str(),
+                             std::ios::binary | std::ios::trunc);
+        std::ofstream config(runPath(setName, runStatus.runName, ST_SIM_CONFIG_FILE).c_str(),
+                             std::ios::trunc);
+        config << configJson;
+        if (!frames || !config)
+        {
+            return ST_ERR_FILE_WRITE;
+        }
+
+        SimRun run;
+        run.name = runStatus.runName;
+        run.timeStamp = (0 != startTime) ? startTime : STUTIL::Timer::getTimeStampMSec();
+        run.frameCount = 0;
+        run.frameBytes = 0;
+        run.statsOffset = 0;
+        run.statsBytes = 0;
+        run.capCount = runStatus.capCount;
+        run.capSelect = runStatus.capSelect;
+        run.hasBackground = false;
+        pSet->runs.push_back(run);
+
+        mStatus = runStatus;
+        mStatus.setName = setName;
+        mStatus.armed = true;
+        mStatus.frameCount = 0;
+        mStatus.framesSaved = 0;
+        mStatus.runTime = 0;
+        mStatus.completionCode = ST_SIM_RUN_ACTIVE;
+        mRunStart = STUTIL::Timer::getTimeStampMSec();
+        mRunGen++;
+        lock.unlock();
+        mCond.notify_all();
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t stopCaptureRun(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStatus.armed)
+        {
+            mStatus.armed = false;
+            mStatus.completionCode = ST_SIM_RUN_STOPPED;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t getCaptureRunStatus(STRunStatus& status)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mStatus.armed)
+        {
+            mStatus.runTime = static_cast<uint32_t>(STUTIL::Timer::getTimeStampMSec() - mRunStart);
+        }
+        status = mStatus;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t getServerDataIndex(StDataIndex& index, const std::string& runBaseName,
+                                       const std::string& setBaseName)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        index.clear();
+        for (const SimSet& set : mSets)
+        {
+            if (0 != set.name.compare(0, setBaseName.size(), setBaseName))
+            {
+                continue;
+            }
+            StSetDef setDef;
+            setDef.setName(set.name);
+            setDef.setDescription(set.description);
+            setDef.setTags(set.tags);
+            setDef.setTimeStamp(set.timeStamp);
+            for (const SimRun& run : set.runs)
+            {
+                if (0 != run.name.compare(0, runBaseName.size(), runBaseName))
+                {
+                    continue;
+                }
+                StRunDef runDef;
+                runDef.setName(run.name);
+                runDef.setTimeStamp(run.timeStamp);
+                runDef.setFrameCount(run.frameCount);
+                runDef.setCapCount(run.capCount);
+                runDef.setCapSelect(run.capSelect);
+                setDef.addRun(runDef);
+            }
+            index.addSet(setDef);
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t getRunConfigData(const std::string setName, const std::string runName,
+                                     std::string& json)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (nullptr == findRun(setName, runName))
+            {
+                return ST_ERR_RUN_NOT_FOUND;
+            }
+        }
+        std::ifstream file(runPath(setName, runName, ST_SIM_CONFIG_FILE).c_str());
+        if (!file)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        json.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    virtual int32_t getBackground(const std::string setName, const std::string runName,
+                                  const std::string capNum, StFrameBuffer& frameBuffer)
+    {
+        (void)capNum;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const SimRun* pRun = findRun(setName, runName);
+            if (nullptr == pRun)
+            {
+                return ST_ERR_RUN_NOT_FOUND;
+            }
+            if (!pRun->hasBackground)
+            {
+                return ST_ERR_NO_BACKGROUND;
+            }
+        }
+        return readFrame(runPath(setName, runName, ST_SIM_BACKGROUND_FILE), 0, frameBuffer);
+    }
+
+    //----------------------------------------------
+    virtual int32_t getRunFrame(const std::string setName, const std::string runName,
+                                uint32_t frameNumber, StFrameBuffer& frameBuffer)
+    {
+        return mFrameCache.get(StFrameCacheKey(setName, runName, frameNumber, DT_ANY), frameBuffer);
+    }
+
+    //----------------------------------------------
+    virtual bool isArmed(void)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStatus.armed;
+    }
+
+    //----------------------------------------------
+    virtual void showMsg(const std::string& msg)
+    {
+        printf("SIM: %s\n", msg.c_str());
+    }
+
+private:
+    //----------------------------------------------
+    // Dispatch functor for calcBackground(): accumulate the image
+    // into pSum, or store pSum back into the image
+    struct AccumOp
+    {
+        uint8_t* pImage;
+        std::vector<double>* pSum;
+        bool store;
+
+        template<typename T> int32_t run()
+        {
+            T* pPix = reinterpret_cast<T*>(pImage);
+            std::vector<double>& sum = *pSum;
+            for (size_t i = 0; i < sum.size(); i++)
+            {
+                if (store)
+                {
+                    pPix[i] = static_cast<T>(sum[i]);
+                }
+                else
+                {
+                    sum[i] += static_cast<double>(pPix[i]);
+                }
+            }
+            return ST_ERR_OK;
+        }
+    };
+
+    //----------------------------------------------
+    // Register map key (caller holds mMutex)
+    static uint64_t registerKey(StParameter& param, uint32_t index, uint32_t padIndex)
+    {
+        uint64_t address = param.getAddress() + static_cast<uint64_t>(index) * param.getArrayStride();
+        return (static_cast<uint64_t>(padIndex) << 40) | (address << 8) | (param.getStartBit() & 0xFF);
+    }
+
+    //----------------------------------------------
+    // Stored register value, or the parameter default (caller holds mMutex)
+    uint32_t getRegister(StParameter& param, uint32_t index, uint32_t padIndex)
+    {
+        SimRegisterMap::const_iterator it = mRegisters.find(registerKey(param, index, padIndex));
+        if (it != mRegisters.end())
+        {
+            return it->second;
+        }
+        double scale = param.getScale();
+        double raw = (0.0 != scale) ? ((param.getDefaultValue() - param.getOffset()) / scale)
+                                    : param.getDefaultValue();
+        return (raw > 0.0) ? static_cast<uint32_t>(raw + 0.5) : 0;
+    }
+
+    //----------------------------------------------
+    // Find a set (caller holds mMutex)
+    SimSet* findSet(const std::string& setName)
+    {
+        for (SimSet& set : mSets)
+        {
+            if (set.name == setName)
+            {
+                return &set;
+            }
+        }
+        return nullptr;
+    }
+
+    //----------------------------------------------
+    // Find a run (caller holds mMutex)
+    SimRun* findRun(const std::string& setName, const std::string& runName)
+    {
+        SimSet* pSet = findSet(setName);
+        if (nullptr != pSet)
+        {
+            for (SimRun& run : pSet->runs)
+            {
+                if (run.name == runName)
+                {
+                    return &run;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    //----------------------------------------------
+    // True if the run is being captured (caller holds mMutex)
+    bool isActiveRun(const std::string& setName, const std::string& runName) const
+    {
+        return mStatus.armed && (mStatus.setName == setName) && (mStatus.runName == runName);
+    }
+
+    //----------------------------------------------
+    // Path of a file in a run directory
+    std::string runPath(const std::string& setName, const std::string& runName, const char* fileName) const
+    {
+        return mConfig.storageDir + "/" + setName + "/" + runName + "/" + fileName;
+    }
+
+    //----------------------------------------------
+    // Average the frames of a run into its background file, reporting
+    // progress and stopping if the job is cancelled
+    int32_t calcBackgroundJob(const std::string& setName, const std::string& runName,
+                              StAsyncJobProgress& progress)
+    {
+        SimRun run;
+        StFrameStatsConfig statsConfig;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const SimRun* pRun = findRun(setName, runName);
+            if (nullptr == pRun)
+            {
+                return ST_ERR_RUN_NOT_FOUND;
+            }
+            if (isActiveRun(setName, runName))
+            {
+                return ST_ERR_RUN_ACTIVE;
+            }
+            run = *pRun;
+            statsConfig = mStatsConfig;
+        }
+        if (0 == run.frameCount)
+        {
+            return ST_ERR_FRAME_COUNT;
+        }
+
+        StFrameBuffer frame(mConfig.systemType);
+        std::vector<double> sum;
+        int32_t rtn = ST_ERR_OK;
+        for (uint32_t n = 0; (0 == rtn) && (n < run.frameCount); n++)
+        {
+            rtn = readFrame(runPath(setName, runName, ST_SIM_FRAMES_FILE),
+                            static_cast<uint64_t>(n) * run.frameBytes, frame);
+            if (0 == rtn)
+            {
+                sum.resize(frame.getImagePixelCount(), 0.0);
+                AccumOp op = { frame.getImagePtr(), &sum, false };
+                rtn = dispatchPixelType(frame.getPixelType(), op);
+            }
+            if ((0 == rtn) && !progress.update(n + 1, run.frameCount))
+            {
+                rtn = ST_ERR_JOB_CANCELLED;
+            }
+        }
+        if (0 == rtn)
+        {
+            for (size_t i = 0; i < sum.size(); i++)
+            {
+                sum[i] /= run.frameCount;
+            }
+            AccumOp op = { frame.getImagePtr(), &sum, true };
+            rtn = dispatchPixelType(frame.getPixelType(), op);
+        }
+        if (0 == rtn)
+        {
+            rtn = addFrameStats(frame, statsConfig);    // replace the last frame's statistics
+        }
+        if (0 == rtn)
+        {
+            rtn = writeFrame(runPath(setName, runName, ST_SIM_BACKGROUND_FILE), frame, false);
+        }
+        if (0 == rtn)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            SimRun* pRun = findRun(setName, runName);
+            if (nullptr != pRun)
+            {
+                pRun->hasBackground = true;
+            }
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    // Read a stored run frame (the run frame cache loader)
+    int32_t readRunFrame(const std::string& setName, const std::string& runName,
+                         uint32_t frameNumber, StFrameBuffer& frameBuffer)
+    {
+        uint32_t frameBytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            const SimRun* pRun = findRun(setName, runName);
+            if (nullptr == pRun)
+            {
+                return ST_ERR_RUN_NOT_FOUND;
+            }
+            if (frameNumber >= pRun->frameCount)
+            {
+                return ST_ERR_FRAME_NUMBER;
+            }
+            frameBytes = pRun->frameBytes;
+        }
+        return readFrame(runPath(setName, runName, ST_SIM_FRAMES_FILE),
+                         static_cast<uint64_t>(frameNumber) * frameBytes, frameBuffer);
+    }
+
+    //----------------------------------------------
+    // Read one stored frame record, sizing the buffer from its header
+    // (records carry optional data sections such as frame statistics)
+    static int32_t readFrame(const std::string& path, uint64_t offset, StFrameBuffer& frameBuffer)
+    {
+        std::ifstream file(path.c_str(), std::ios::binary);
+        if (!file)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        StFrameHeader header;
+        if (!file.seekg(static_cast<std::streamoff>(offset)))
+        {
+            return ST_ERR_FILE_SEEK;
+        }
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        {
+            return ST_ERR_FILE_READ;
+        }
+        if ((ST_FRAME_ID != header.id) || (sizeof(header) != header.headerBytes))
+        {
+            return ST_ERR_FRAME_SIZE;
+        }
+        if (frameBuffer.getFrameBytes() != header.frameBytes)
+        {
+            frameBuffer = StFrameBuffer(static_cast<STSystemType>(header.frameType),
+                                        0 == header.telemetryBytes, header.imageBytes,
+                                        header.data1Bytes, header.data2Bytes, header.data3Bytes);
+            if (frameBuffer.getFrameBytes() != header.frameBytes)
+            {
+                return ST_ERR_FRAME_SIZE;
+            }
+        }
+        if (!file.seekg(static_cast<std::streamoff>(offset)))
+        {
+            return ST_ERR_FILE_SEEK;
+        }
+        if (!file.read(reinterpret_cast<char*>(frameBuffer.getBufferPtr()), header.frameBytes))
+        {
+            return ST_ERR_FILE_READ;
+        }
+        return frameBuffer.updateFrameHeader();
+    }
+
+    //----------------------------------------------
+    // Write one frame record (append or replace)
+    static int32_t writeFrame(const std::string& path, StFrameBuffer& frame, bool append)
+    {
+        std::ofstream file(path.c_str(), std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        if (!file.write(reinterpret_cast<const char*>(frame.getBufferPtr()), frame.getFrameBytes()))
+        {
+            return ST_ERR_FILE_WRITE;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    // Sim thread: publish telemetry, and generate, store and publish
+    // frames while armed
+    void simThread(void)
+    {
+        typedef std::chrono::steady_clock Clock;
+        const Clock::duration framePeriod = periodOf(mConfig.frameRateHz);
+        const Clock::duration telemPeriod = periodOf(mConfig.telemetryRateHz);
+
+        StFrameBuffer frame(mConfig.systemType);
+        std::ofstream frames;
+        uint32_t runGen = 0;
+        std::string framesPath;
+        bool noDiskSave = false;
+        Clock::time_point nextFrame = Clock::now();
+        Clock::time_point nextTelem = Clock::now();
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (!mQuit)
+        {
+            Clock::time_point now = Clock::now();
+
+            if ((Clock::duration::zero() != telemPeriod) && (now >= nextTelem))
+            {
+                nextTelem = now + telemPeriod;
+                ServerInterface* pServer = mpServer;
+                lock.unlock();
+                STRawTelemetry telem;
+                mSim.genSimTelemetry(&telem);
+                if (nullptr != pServer)
+                {
+                    pServer->setTelemetry(StFrameBuffer::convertTelemetry(&telem));
+                }
+                lock.lock();
+                continue;
+            }
+
+            if (!mStatus.armed && frames.is_open())
+            {
+                frames.close();
+            }
+
+            if (mStatus.armed && (runGen != mRunGen))
+            {
+                // New run: open its frame file and restart the sequence
+                runGen = mRunGen;
+                framesPath = runPath(mStatus.setName, mStatus.runName, ST_SIM_FRAMES_FILE);
+                noDiskSave = mStatus.noDiskSave;
+                frames.close();
+                frames.clear();
+                if (!noDiskSave)
+                {
+                    frames.open(framesPath.c_str(), std::ios::binary | std::ios::app);
+                }
+                mSim.startCaptureRun();
+                nextFrame = now;
+            }
+
+            if (mStatus.armed && (now >= nextFrame))
+            {
+                // Pace from the schedule, but do not burst to catch up
+                nextFrame += framePeriod;
+                if (nextFrame < now)
+                {
+                    nextFrame = now;
+                }
+                uint32_t frameNumber = mStatus.frameCount;
+                ServerInterface* pServer = mpServer;
+                StFrameStatsConfig statsConfig = mStatsConfig;
+                lock.unlock();
+
+                mSim.genSimFrame(frame);
+                frame.setFrameNumber(frameNumber);
+                addFrameStats(frame, statsConfig);
+                bool saved = !noDiskSave &&
+                    frames.write(reinterpret_cast<const char*>(frame.getBufferPtr()), frame.getFrameBytes()).flush();
+                if (nullptr != pServer)
+                {
+                    pServer->setSampleFrame(frame);
+                }
+                publishShmFrame(frame);
+                mLastFrame.set(frame);
+
+                lock.lock();
+                updateRun(runGen, frame, saved, noDiskSave);
+                continue;
+            }
+
+            Clock::time_point wake = (Clock::duration::zero() != telemPeriod) ? nextTelem : (now + std::chrono::seconds(1));
+            if (mStatus.armed && (nextFrame < wake))
+            {
+                wake = nextFrame;
+            }
+            mCond.wait_until(lock, wake);
+        }
+    }
+
+    //----------------------------------------------
+    // Compute a frame's statistics into its statistics section
+    static int32_t addFrameStats(StFrameBuffer& frame, const StFrameStatsConfig& config)
+    {
+        if (0 == config.flags)
+        {
+            return ST_ERR_OK;
+        }
+        StFrameStats stats;
+        int32_t rtn = computeFrameStats(frame, config, stats);
+        return (0 == rtn) ? setFrameStats(frame, stats) : rtn;
+    }
+
+    //----------------------------------------------
+    // Publish a sample frame to the shared-memory ring, if enabled. A
+    // frame too large for a slot replaces the ring with one that fits;
+    // readers see the old ring closed and attach again.
+    void publishShmFrame(StFrameBuffer& frame)
+    {
+        std::lock_guard<std::mutex> lock(mShmCS);
+        if (!mShmRing.isOpen())
+        {
+            return;
+        }
+        int32_t rtn = mShmRing.publish(frame);
+        if ((ST_ERR_FRAME_SIZE == rtn) && (frame.getFrameBytes() > mShmRing.getSlotBytes()))
+        {
+            std::string name = mShmRing.getName();
+            rtn = mShmRing.create(name, mShmRing.getSlotCount(), frame.getFrameBytes());
+            if (0 == rtn)
+            {
+                mShmRing.publish(frame);
+            }
+        }
+    }
+
+    //----------------------------------------------
+    // Record a generated frame and end the run if a limit was reached
+    // (caller holds mMutex)
+    void updateRun(uint32_t runGen, StFrameBuffer& frame, bool saved, bool noDiskSave)
+    {
+        if (!mStatus.armed || (runGen != mRunGen))
+        {
+            return;         // stopped while the frame was generated
+        }
+        mStatus.frameCount++;
+        mStatus.runTime = static_cast<uint32_t>(STUTIL::Timer::getTimeStampMSec() - mRunStart);
+        if (saved)
+        {
+            mStatus.framesSaved++;
+            SimRun* pRun = findRun(mStatus.setName, mStatus.runName);
+            if (nullptr != pRun)
+            {
+                pRun->frameBytes = frame.getFrameBytes();
+                pRun->statsBytes = frame.getData3Bytes();
+                pRun->statsOffset = (0 != pRun->statsBytes) ?
+                    static_cast<uint32_t>(frame.getData3Ptr() - frame.getBufferPtr()) : 0;
+                pRun->frameCount = mStatus.framesSaved;
+            }
+        }
+        else if (!noDiskSave)
+        {
+            mStatus.armed = false;
+            mStatus.completionCode = ST_SIM_RUN_DISK_ERROR;
+        }
+        if ((0 != mStatus.maxFrames) && (mStatus.frameCount >= mStatus.maxFrames))
+        {
+            mStatus.armed = false;
+            mStatus.completionCode = ST_SIM_RUN_MAX_FRAMES;
+        }
+        else if ((0 != mStatus.maxRunTime) && (mStatus.runTime >= mStatus.maxRunTime))
+        {
+            mStatus.armed = false;
+            mStatus.completionCode = ST_SIM_RUN_MAX_TIME;
+        }
+    }
+
+    //----------------------------------------------
+    // Period of a rate (zero if the rate is not positive)
+    static std::chrono::steady_clock::duration periodOf(double rateHz)
+    {
+        if (rateHz <= 0.0)
+        {
+            return std::chrono::steady_clock::duration::zero();
+        }
+        return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / rateHz));
+    }
+};  // class StSimResponseHandler
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_SIM_RESPONSE_HANDLER_H
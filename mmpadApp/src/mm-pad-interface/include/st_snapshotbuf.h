@@ -0,0 +1,256 @@
+//******************************************************************
+/// @file st_snapshotbuf.h
+/// @brief Lock-free single writer, multi reader snapshot buffer
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, All rights reserved.
+///
+/// SnapshotBuf distributes the latest value of an object (sample frame,
+/// telemetry) from one producer thread to any number of reader threads.
+/// Unlike DoubleBuf, the writer never waits: it does not wait for
+/// readers, locks or a slow network client, and readers always copy a
+/// consistent value. StSimResponseHandler uses it for its last frame.
+/// ServerInterface keeps DoubleBuf, because its layout is fixed by the
+/// prebuilt server library.
+///
+/// The buffer holds SLOTS copies of T. Each slot has a reader pin count
+/// and a state word, which is 2 * publish sequence when stable and odd
+/// while the writer fills it. The protocol is:
+///
+/// - Writer: picks a slot other than the latest, marks it odd, and then
+///   checks the pin count. If a reader has it pinned, the writer restores
+///   the state and tries the next slot. Otherwise it copies the data in,
+///   stores the new even state and publishes (sequence, slot) in one
+///   atomic word.
+/// - Reader: loads the published word, pins that slot, and checks that
+///   the slot state still equals the published sequence. If the slot
+///   changed while it was pinning, it unpins and retries.
+///
+/// Pinning and claiming are both sequentially consistent, so either the
+/// writer sees the pin or the reader sees the claim. A pinned slot is
+/// never written, so a reader copying a large frame holds up nobody.
+/// If every candidate slot is pinned, the writer drops that update and
+/// the previous value stays published. set() reports this and it is
+/// counted. The writer skips the latest slot, and a reader holds at most
+/// one pin, so SLOTS - 2 concurrent readers can never cause a drop.
+///
+/// @note T must be default constructible and copy assignable.
+///
+/// @note The production server still publishes sample frames and
+/// telemetry through ServerInterface's DoubleBuf, so its writer can
+/// still wait on a reader copying out. Only the simulated server uses
+/// SnapshotBuf.
+///
+//******************************************************************
+#ifndef ST_SNAPSHOTBUF_H
+#define ST_SNAPSHOTBUF_H
+
+#include <stdint.h>
+#include <atomic>
+#include "st_errors.h"
+
+namespace ST_INTERFACE
+{
+
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+const uint32_t ST_SNAPSHOT_DEFAULT_SLOTS  = 4;     ///< Default slot count
+const uint32_t ST_SNAPSHOT_READ_RETRIES   = 16;    ///< Reader attempts before reporting busy
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//------------------------------------------------------------------
+/// SnapshotBuf class
+template<typename T, uint32_t SLOTS = ST_SNAPSHOT_DEFAULT_SLOTS>
+class SnapshotBuf
+{
+    static_assert((SLOTS >= 2) && (SLOTS <= 256), "SnapshotBuf needs 2 to 256 slots");
+
+private:
+    //----------------------------------------------
+    /// One buffer slot
+    struct Slot
+    {
+        T data;                         ///< Slot contents
+        std::atomic<uint64_t> state;    ///< 2 * sequence when stable, odd while written
+        std::atomic<uint32_t> readers;  ///< Reader pin count
+
+        Slot() : data(), state(0), readers(0) {}
+    };
+
+    Slot mSlots[SLOTS];                 ///< Buffer slots
+    std::atomic<uint64_t> mLatest;      ///< (sequence << 8) | slot, 0 if nothing published
+    uint64_t mWriteSeq;                 ///< Last sequence published (writer only)
+    std::atomic<uint64_t> mDropped;     ///< Updates dropped because all slots were pinned
+
+public:
+    //----------------------------------------------
+    /// Read pin. Keeps one slot from being rewritten while it exists.
+    class Pin
+    {
+    private:
+        Slot* mpSlot;           ///< Pinned slot (nullptr if none)
+        uint64_t mSeq;          ///< Sequence of the pinned value
+
+        friend class SnapshotBuf;
+        Pin(Slot* pSlot, uint64_t seq) : mpSlot(pSlot), mSeq(seq) {}
+
+    public:
+        Pin() : mpSlot(nullptr), mSeq(0) {}
+        Pin(Pin&& other) : mpSlot(other.mpSlot), mSeq(other.mSeq) { other.mpSlot = nullptr; }
+        Pin& operator=(Pin&& other)
+        {
+            if (this != &other)
+            {
+                release();
+                mpSlot = other.mpSlot;
+                mSeq = other.mSeq;
+                other.mpSlot = nullptr;
+            }
+            return *this;
+        }
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+        ~Pin() { release(); }
+
+        bool isValid() const { return nullptr != mpSlot; }              ///< A value is pinned
+        const T* get() const { return mpSlot ? &mpSlot->data : nullptr; } ///< Pinned value
+        uint64_t getSequence() const { return mSeq; }                   ///< Publish sequence
+
+        //----------------------------------------------
+        /// Unpin the slot
+        void release()
+        {
+            if (nullptr != mpSlot)
+            {
+                mpSlot->readers.fetch_sub(1);
+                mpSlot = nullptr;
+            }
+        }
+    };
+
+    //----------------------------------------------
+    /// Constructor
+    SnapshotBuf(void)
+        : mLatest(0)
+        , mWriteSeq(0)
+        , mDropped(0)
+    {
+    }
+
+    SnapshotBuf(const SnapshotBuf&) = delete;
+    SnapshotBuf& operator=(const SnapshotBuf&) = delete;
+
+    //----------------------------------------------
+    /// Publish a new value (single writer). Never blocks.
+    ///
+    /// @param[in] src     value to copy in
+    ///
+    /// @return true if published, false if dropped because every
+    ///         free slot was pinned by a reader
+    ///
+    bool set(const T& src)
+    {
+        uint64_t latest = mLatest.load();
+        uint32_t latestIdx = (0 == latest) ? (SLOTS - 1) : static_cast<uint32_t>(latest & 0xFF);
+
+        for (uint32_t i = 1; i < SLOTS; i++)
+        {
+            uint32_t idx = (latestIdx + i) % SLOTS;
+            Slot& slot = mSlots[idx];
+
+            // Claim the slot, then make sure no reader pinned it first
+            uint64_t state = slot.state.load();
+            slot.state.store(state | 1);
+            if (0 != slot.readers.load())
+            {
+                slot.state.store(state);
+                continue;
+            }
+
+            slot.data = src;
+            mWriteSeq++;
+            slot.state.store(mWriteSeq * 2);
+            mLatest.store((mWriteSeq << 8) | idx);
+            return true;
+        }
+        mDropped++;
+        return false;
+    }
+
+    //----------------------------------------------
+    /// Pin the latest value
+    ///
+    /// @param[out] pin     pin on the latest value
+    ///
+    /// @return 0 if ok, ST_ERR_NOT_AVAILABLE if nothing has been
+    ///         published, ST_ERR_BUSY if the value kept changing
+    ///         while being pinned (retry later)
+    ///
+    int32_t acquire(Pin& pin)
+    {
+        pin.release();
+        for (uint32_t tries = 0; tries < ST_SNAPSHOT_READ_RETRIES; tries++)
+        {
+            uint64_t latest = mLatest.load();
+            if (0 == latest)
+            {
+                return ST_ERR_NOT_AVAILABLE;
+            }
+            uint64_t seq = latest >> 8;
+            Slot& slot = mSlots[latest & 0xFF];
+
+            slot.readers.fetch_add(1);
+            if (slot.state.load() == (seq * 2))
+            {
+                pin = Pin(&slot, seq);
+                return ST_ERR_OK;
+            }
+            slot.readers.fetch_sub(1);  // Changed while pinning
+        }
+        return ST_ERR_BUSY;
+    }
+
+    //----------------------------------------------
+    /// Copy the latest value out
+    ///
+    /// @param[out] dest    destination object
+    /// @param[out] pSeq    optional publish sequence of the value
+    ///
+    /// @return 0 if ok, else negative error code (see acquire())
+    ///
+    int32_t get(T& dest, uint64_t* pSeq = nullptr)
+    {
+        Pin pin;
+        int32_t rtn = acquire(pin);
+        if (0 == rtn)
+        {
+            dest = *pin.get();
+            if (nullptr != pSeq)
+            {
+                *pSeq = pin.getSequence();
+            }
+        }
+        return rtn;
+    }
+
+    //----------------------------------------------
+    /// Get the sequence of the latest published value (0 if none)
+    uint64_t getSequence(void) const { return mLatest.load() >> 8; }
+
+    //----------------------------------------------
+    /// Get the number of updates dropped because all slots were pinned
+    uint64_t getDroppedCount(void) const { return mDropped.load(); }
+
+};  // class SnapshotBuf
+
+} // namespace ST_INTERFACE
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // ST_SNAPSHOTBUF_H
@@ -41,6 +41,7 @@
 #include "st_servers.h"
 #include "st_if_defs.h"
 #include "st_client_interface.h"
+#include "st_corr_engine.h"
 
 #define DRIVER_VERSION      2
 #define DRIVER_REVISION     9
@@ -73,6 +74,13 @@ typedef enum {
     TMAlignment
 } PilatusTriggerMode;
 
+/** Exposures per image summing modes */
+typedef enum {
+    SumModeOff,
+    SumModeSum,
+    SumModeMean
+} MMPADSumMode_t;
+
 /** Bad pixel structure for Pilatus detector */
 typedef struct {
     int badIndex;
@@ -135,6 +143,15 @@ static const char *driverName = "mmpadDetector";
 
 #define MMPADRunNameString          "RUNNAME"
 #define MMPADSetNameString          "SETNAME"
+#define MMPADDebounceMethodString   "DEBOUNCE_METHOD"
+#define MMPADDebounceStepString     "DEBOUNCE_STEP"
+#define MMPADDebounceFloorString    "DEBOUNCE_FLOOR"
+#define MMPADDebounceThreshString   "DEBOUNCE_THRESHOLD"
+#define MMPADSumModeString          "SUM_MODE"
+#define MMPADSumFramesString        "SUM_FRAMES"
+#define MMPADSumThreadsString       "SUM_THREADS"
+
+#define MMPAD_SUM_THREADS_DEFAULT   4   ///< Default exposures per image summing threads
 
 /** Driver for Dectris Pilatus pixel array detectors using their camserver server over TCP/IP socket */
 class mmpadDetector : public ADDriver {
@@ -206,6 +223,13 @@ protected:
 
     int MMPADRunName;
     int MMPADSetName;
+    int MMPADDebounceMethod;
+    int MMPADDebounceStep;
+    int MMPADDebounceFloor;
+    int MMPADDebounceThresh;
+    int MMPADSumMode;
+    int MMPADSumFrames;
+    int MMPADSumThreads;
 
  private:                                       
     /* These are the methods that are new to this class */
@@ -227,6 +251,8 @@ protected:
     void readBadPixelFile(const char *badPixelFile);
     void readFlatFieldFile(const char *flatFieldFile);
     asynStatus readRawFrame(FILE *imgFile); // -=-= TODO A candidate to put in an NDArray like readTiff() above
+    NDArray *sumImage(NDArray *pImage);
+    void discardPartialSum(const char *reason);
    
     /* Our data */
     int imagesRemaining;
@@ -253,6 +279,7 @@ protected:
     // MMPAD Interface
     ST_INTERFACE::StServers mServers; ///< MMPAD Server management class
     ST_INTERFACE::StClientInterface *mLocalServer; ///< Localhost server
+    ST_INTERFACE::StCorrEngine mCorrEngine; ///< Correction engine: summing accumulator (pilatusTask only) and worker threads
     
 };
 
@@ -1068,6 +1095,7 @@ void mmpadDetector::pilatusTask()
     int itemp;
     int arrayCallbacks;
     int flatFieldValid;
+    int sumMode;
     int aborted = 0;
     int statusParam = 0;
 
@@ -1112,6 +1140,9 @@ void mmpadDetector::pilatusTask()
         acquiring = ADStatusAcquire;
         setIntegerParam(ADStatus, acquiring);
 
+        /* Each acquisition starts a new exposures per image sum */
+        discardPartialSum("new acquisition");
+
         /* Reset the MX settings start angle */
         getDoubleParam(PilatusStartAngle, &startAngle);
         epicsSnprintf(this->toCamserver, sizeof(this->toCamserver), "mxsettings Start_angle %f", startAngle);
@@ -1226,13 +1257,6 @@ void mmpadDetector::pilatusTask()
                     continue;
                 }
 
-                /* We successfully read an image - increment the array counter */
-                getIntegerParam(NDArrayCounter, &imageCounter);
-                imageCounter++;
-                setIntegerParam(NDArrayCounter, imageCounter);
-                /* Call the callbacks to update any changes */
-                callParamCallbacks();
-
                 /* Now assemble the NDArray */
                 getIntegerParam(PilatusFlatFieldValid, &flatFieldValid);
                 if (flatFieldValid) {
@@ -1244,20 +1268,36 @@ void mmpadDetector::pilatusTask()
                         *pData = (epicsInt32)((this->averageFlatField * *pData) / *pFlat);
                     }
                 } 
-                /* Put the frame number and time stamp into the buffer */
-                pImage->uniqueId = imageCounter;
-                pImage->timeStamp = startTime.secPastEpoch + startTime.nsec / 1.e9;
-                updateTimeStamp(&pImage->epicsTS);
-
-                /* Get any attributes that have been defined for this driver */        
-                this->getAttributes(pImage->pAttributeList);
-                
-                /* Call the NDArray callback */
-                asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
-                     "%s:%s: calling NDArray callback\n", driverName, functionName);
-                doCallbacksGenericPointer(pImage, NDArrayData, 0);
-                /* Free the image buffer */
-                pImage->release();
+                /* In summing mode only every SUM_FRAMES'th image is passed on, as a sum or mean */
+                getIntegerParam(MMPADSumMode, &sumMode);
+                if (sumMode != SumModeOff) {
+                    pImage = sumImage(pImage);
+                } else {
+                    discardPartialSum("summing turned off");
+                }
+                if (pImage) {
+                    /* We have an array to pass on - increment the array counter */
+                    getIntegerParam(NDArrayCounter, &imageCounter);
+                    imageCounter++;
+                    setIntegerParam(NDArrayCounter, imageCounter);
+                    /* Call the callbacks to update any changes */
+                    callParamCallbacks();
+
+                    /* Put the frame number and time stamp into the buffer */
+                    pImage->uniqueId = imageCounter;
+                    pImage->timeStamp = startTime.secPastEpoch + startTime.nsec / 1.e9;
+                    updateTimeStamp(&pImage->epicsTS);
+
+                    /* Get any attributes that have been defined for this driver */        
+                    this->getAttributes(pImage->pAttributeList);
+                    
+                    /* Call the NDArray callback */
+                    asynPrint(this->pasynUserSelf, ASYN_TRACE_FLOW, 
+                         "%s:%s: calling NDArray callback\n", driverName, functionName);
+                    doCallbacksGenericPointer(pImage, NDArrayData, 0);
+                    /* Free the image buffer */
+                    pImage->release();
+                }
             }
             if (numImages == 1) {
                 if (triggerMode == TMAlignment) {
@@ -1276,6 +1316,7 @@ void mmpadDetector::pilatusTask()
             
         }
         /* We are done acquiring */
+        discardPartialSum("acquisition ended");
         /* Wait for the 7OK response from camserver in the case of multiple images */
         if ((numImages > 1) && (status == asynSuccess)) {
             /* If arrayCallbacks is 0 we will have gone through the above loop without waiting
@@ -1354,6 +1395,80 @@ asynStatus mmpadDetector::readRawFrame(FILE *imageFile)
 }
 
 
+/** Add an image to the exposures per image sum.
+  * The input image is always released.  Once SUM_FRAMES images have been added this returns
+  * a new NDFloat64 array holding their sum (SUM_MODE=Sum) or mean (SUM_MODE=Mean), otherwise NULL.
+  * Only called from pilatusTask with the lock held; the lock is released while the pixels are
+  * added on the correction engine worker threads, as its accumulator is only used by pilatusTask.
+  * \param[in] pImage NDInt32 image to add */
+NDArray *mmpadDetector::sumImage(NDArray *pImage)
+{
+    const char *functionName = "sumImage";
+    NDArray *pSum = NULL;
+    NDArrayInfo_t arrayInfo;
+    size_t dims[2];
+    int sumMode, sumFrames;
+    int32_t rtn;
+    ST_INTERFACE::StAccumOutput output;
+    ST_INTERFACE::StFrameAccumulator &accumulator = mCorrEngine.getAccumulator();
+
+    getIntegerParam(MMPADSumMode, &sumMode);
+    getIntegerParam(MMPADSumFrames, &sumFrames);
+    if (sumFrames < 1) sumFrames = 1;
+    output = (sumMode == SumModeMean) ? ST_INTERFACE::ST_ACCUM_OUT_MEAN : ST_INTERFACE::ST_ACCUM_OUT_SUM;
+    pImage->getInfo(&arrayInfo);
+
+    /* Reconfigure when the image size or summing parameters change */
+    if ((accumulator.getPixels() != (uint32_t)arrayInfo.nElements) ||
+        (accumulator.getFrameCount() != (uint32_t)sumFrames) ||
+        (accumulator.getOutput() != output)) {
+        discardPartialSum("summing settings changed");
+        accumulator.init((uint32_t)arrayInfo.nElements, sumFrames, ST_INTERFACE::ST_ACCUM_INT64, output);
+    }
+
+    this->unlock();
+    rtn = accumulator.addPixels((const epicsInt32 *)pImage->pData, mCorrEngine.getWorkerPool());
+    this->lock();
+    if (rtn != 0) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+            "%s:%s: error adding image to sum, rtn=%d\n", driverName, functionName, rtn);
+        accumulator.reset();
+    } else if (accumulator.isComplete()) {
+        dims[0] = pImage->dims[0].size;
+        dims[1] = pImage->dims[1].size;
+        pSum = this->pNDArrayPool->alloc(2, dims, NDFloat64, 0, NULL);
+        if (pSum) {
+            this->unlock();
+            accumulator.getResult((epicsFloat64 *)pSum->pData);
+            this->lock();
+        } else {
+            asynPrint(this->pasynUserSelf, ASYN_TRACE_ERROR,
+                "%s:%s: unable to allocate sum image\n", driverName, functionName);
+            accumulator.reset();
+        }
+    }
+    pImage->release();
+    return pSum;
+}
+
+
+/** Discard an incomplete exposures per image sum, logging how many images it held.
+  * \param[in] reason Why the sum is discarded */
+void mmpadDetector::discardPartialSum(const char *reason)
+{
+    const char *functionName = "discardPartialSum";
+    ST_INTERFACE::StFrameAccumulator &accumulator = mCorrEngine.getAccumulator();
+
+    if (accumulator.getAddedCount() == 0) return;
+    if (!accumulator.isComplete()) {
+        asynPrint(this->pasynUserSelf, ASYN_TRACE_WARNING,
+            "%s:%s: %s, discarding partial sum of %u of %u images\n",
+            driverName, functionName, reason, accumulator.getAddedCount(), accumulator.getFrameCount());
+    }
+    accumulator.reset();
+}
+
+
 /** This function is called periodically read the detector status (temperature, humidity, etc.)
     It should not be called if we are acquiring data, to avoid polling camserver when taking data.*/
 asynStatus mmpadDetector::pilatusStatus()
@@ -1505,6 +1620,21 @@ asynStatus mmpadDetector::writeInt32(asynUser *pasynUser, epicsInt32 value)
     {
         int32_t rtn;
         rtn = mLocalServer->setParam<uint32_t>(IMAGE_COUNT_PARAM, value);
+    } else if (function == MMPADDebounceMethod)
+    {
+        int32_t rtn;
+        rtn = mCorrEngine.setDebounceMethod(value);
+        if (rtn == 0) rtn = mLocalServer->setParam<uint32_t>(DEBOUNCE_METHOD_PARAM, value);
+        if (rtn != 0) status = asynError;
+    } else if (function == MMPADSumThreads)
+    {
+        /* Waits for any sum in progress; the pool serializes init() with its work */
+        if (mCorrEngine.setWorkerThreads((uint32_t)value) != 0) {
+            asynPrint(pasynUser, ASYN_TRACE_ERROR,
+                "%s:%s: unable to start %d summing threads\n", driverName, functionName, value);
+            status = asynError;
+        }
+        setIntegerParam(MMPADSumThreads, (int)mCorrEngine.getWorkerThreads());
     } else if (function == PilatusThresholdApply) {
         setThreshold();
     } else if (function == PilatusResetPower) {
@@ -1664,6 +1794,14 @@ asynStatus mmpadDetector::writeFloat64(asynUser *pasynUser, epicsFloat64 value)
     } else if (function == PilatusOmegaIncr) {
         epicsSnprintf(this->toCamserver, sizeof(this->toCamserver), "mxsettings Omega_increment %f", value);
         writeReadCamserver(CAMSERVER_DEFAULT_TIMEOUT);
+    } else if ((function == MMPADDebounceStep) ||
+               (function == MMPADDebounceFloor) ||
+               (function == MMPADDebounceThresh)) {
+        ST_INTERFACE::StDebounceParams debounceParams;
+        getDoubleParam(MMPADDebounceStep, &debounceParams.stepAdu);
+        getDoubleParam(MMPADDebounceFloor, &debounceParams.floor);
+        getDoubleParam(MMPADDebounceThresh, &debounceParams.threshold);
+        mCorrEngine.getDebouncer().setParams(debounceParams);
     } else {
         /* If this parameter belongs to a base class call its method */
         if (function < FIRST_PILATUS_PARAM) status = ADDriver::writeFloat64(pasynUser, value);
@@ -1905,6 +2043,13 @@ mmpadDetector::mmpadDetector(const char *portName, const char *camserverPort,
     createParam(PilatusHeaderStringString,   asynParamOctet,   &PilatusHeaderString);
     createParam(MMPADRunNameString,          asynParamOctet,   &MMPADRunName);
     createParam(MMPADSetNameString,          asynParamOctet,   &MMPADSetName);
+    createParam(MMPADDebounceMethodString,   asynParamInt32,   &MMPADDebounceMethod);
+    createParam(MMPADDebounceStepString,     asynParamFloat64, &MMPADDebounceStep);
+    createParam(MMPADDebounceFloorString,    asynParamFloat64, &MMPADDebounceFloor);
+    createParam(MMPADDebounceThreshString,   asynParamFloat64, &MMPADDebounceThresh);
+    createParam(MMPADSumModeString,          asynParamInt32,   &MMPADSumMode);
+    createParam(MMPADSumFramesString,        asynParamInt32,   &MMPADSumFrames);
+    createParam(MMPADSumThreadsString,       asynParamInt32,   &MMPADSumThreads);
 
     /* Set some default values for parameters */
     status =  setStringParam (ADManufacturer, "Dectris");
@@ -1931,6 +2076,13 @@ mmpadDetector::mmpadDetector(const char *portName, const char *camserverPort,
     status |= setIntegerParam(PilatusNumBadPixels, 0);
     status |= setStringParam (PilatusFlatFieldFile, "");
     status |= setIntegerParam(PilatusFlatFieldValid, 0);
+    status |= setIntegerParam(MMPADDebounceMethod, 0);
+    status |= setDoubleParam (MMPADDebounceStep, 0.0);
+    status |= setDoubleParam (MMPADDebounceFloor, 0.0);
+    status |= setDoubleParam (MMPADDebounceThresh, 0.0);
+    status |= setIntegerParam(MMPADSumMode, SumModeOff);
+    status |= setIntegerParam(MMPADSumFrames, 1);
+    status |= setIntegerParam(MMPADSumThreads, MMPAD_SUM_THREADS_DEFAULT);
 
     setDoubleParam(PilatusThTemp0, 0);
     setDoubleParam(PilatusThTemp1, 0);
@@ -1946,6 +2098,12 @@ mmpadDetector::mmpadDetector(const char *portName, const char *camserverPort,
         return;
     }
 
+    /* Exposures per image summing runs on the correction engine worker threads */
+    if (mCorrEngine.setWorkerThreads(MMPAD_SUM_THREADS_DEFAULT) != 0) {
+        printf("%s:%s unable to start worker threads, summing runs on the image thread\n",
+            driverName, functionName);
+    }
+
     /* Create the thread that updates the images */
     status = (epicsThreadCreate("PilatusDetTask",
                                 epicsThreadPriorityMedium,
@@ -0,0 +1,96 @@
+/* mmpadSimServer.cpp
+ *
+ * Simulated MM-PAD server. Serves StSimData frames, capture runs,
+ * backgrounds and telemetry through the normal server interface, so
+ * the IOC and clients can be exercised without a detector.
+ *
+ * Usage: mmpadSimServer [-d dictionary] [-c calibDir] [-s storageDir]
+ *                       [-r frameRateHz] [-t telemetryRateHz]
+ *
+ * Runs are stored under storageDir, or a new /tmp/mmpad_sim_XXXXXX
+ * directory if none is given.
+ *
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "st_if_server.h"
+#include "st_sim_response_handler.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t simServerVersion = 0x01000000;
+
+static volatile sig_atomic_t quitRequested = 0;
+
+static void onSignal(int sig)
+{
+    (void)sig;
+    quitRequested = 1;
+}
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [-d dictionary] [-c calibDir] [-s storageDir] "
+           "[-r frameRateHz] [-t telemetryRateHz]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    StSimConfig config;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "d:c:s:r:t:h")) != -1) {
+        switch (opt) {
+            case 'd': config.dataDictionaryPath = optarg; break;
+            case 'c': config.calibrationDirPath = optarg; break;
+            case 's': config.storageDir = optarg; break;
+            case 'r': config.frameRateHz = atof(optarg); break;
+            case 't': config.telemetryRateHz = atof(optarg); break;
+            default:
+                usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    StSimResponseHandler *pHandler = new StSimResponseHandler(config);
+    if (pHandler->getStorageDir().empty()) {
+        printf("%s: could not create a storage directory\n", argv[0]);
+        delete pHandler;
+        return 1;
+    }
+
+    ServerInterface *pServer = new ServerInterface();
+    int32_t status = pServer->setResponseHandler(pHandler, simServerVersion, config.systemType, true);
+    if (status == 0) {
+        pHandler->setServer(pServer);
+        // Same-host readers can take live frames from shared memory
+        if (pHandler->enableShmTransport() != 0) {
+            printf("%s: shared-memory frame ring not available\n", argv[0]);
+        }
+        status = pServer->enable(true);
+    }
+    if (status != 0) {
+        printf("%s: could not start the server interface, error %d\n", argv[0], status);
+    } else {
+        printf("%s: serving simulated frames at %.1f Hz, runs stored in %s\n",
+               argv[0], config.frameRateHz, pHandler->getStorageDir().c_str());
+
+        signal(SIGINT, onSignal);
+        signal(SIGTERM, onSignal);
+        while (!quitRequested) {
+            usleep(100000);
+        }
+        printf("%s: shutting down\n", argv[0]);
+        pServer->enable(false);
+    }
+
+    pHandler->setServer(NULL);
+    delete pServer;
+    delete pHandler;
+    return (status == 0) ? 0 : 1;
+}
@@ -90,6 +90,9 @@ const int32_t ST_ERR_NOT_ARMED          = ST_ERR_BASE - 118;    ///< Capture is
 const int32_t ST_ERR_RESP_CLIENT        = ST_ERR_BASE - 119;    ///< incorrect message response client handle
 const int32_t ST_ERR_MSG_CLIENT         = ST_ERR_BASE - 120;    ///< message client handle not found
 const int32_t ST_ERR_COMM_TIMEOUT       = ST_ERR_BASE - 121;    ///< Timeout waiting for server response
+const int32_t ST_ERR_JOB_ID             = ST_ERR_BASE - 122;    ///< Unknown asynchronous job ID
+const int32_t ST_ERR_JOB_CANCELLED      = ST_ERR_BASE - 123;    ///< Asynchronous job was cancelled
+const int32_t ST_ERR_JOB_EXCEPTION      = ST_ERR_BASE - 124;    ///< Asynchronous job threw an exception
 
 // Parameter errors
 const int32_t ST_ERR_PARAM              = ST_ERR_BASE - 200;    ///< Invalid parameter
@@ -136,6 +139,7 @@ const int32_t ST_ERR_INPUT_STREAM       = ST_ERR_BASE - 312;    ///< Could not a
 const int32_t ST_ERR_OUTPUT_STREAM      = ST_ERR_BASE - 313;    ///< Could not access output stream
 const int32_t ST_ERR_SYM_LINK           = ST_ERR_BASE - 314;    ///< Could not create symbolic link
 const int32_t ST_ERR_FILE_SEEK          = ST_ERR_BASE - 315;    ///< Could not seek in file
+const int32_t ST_ERR_FILE_FORMAT        = ST_ERR_BASE - 316;    ///< Invalid or corrupt file format
 
 // File, capture set, capture run names
 const int32_t ST_ERR_NAME_EMPTY         = ST_ERR_BASE - 350;    ///< file name is empty
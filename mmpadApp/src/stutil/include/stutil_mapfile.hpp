@@ -0,0 +1,211 @@
+//******************************************************************
+/// @file stutil_mapfile.hpp
+/// @brief Read-only memory mapped file
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, All rights reserved.
+///
+/// MapFile maps a whole file read-only into the address space. Pages
+/// are loaded by the OS on first touch and shared between processes
+/// mapping the same file, so large calibration tables cost no copy
+/// and no read() at startup.
+///
+/// prefetch() asks the OS to read the mapping ahead so the first frame
+/// does not take page faults.
+///
+//******************************************************************
+#ifndef STUTIL_MAPFILE_HPP
+#define STUTIL_MAPFILE_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include "st_errors.h"
+
+#ifdef _WIN32
+    #include "stutil_platform.h"
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace STUTIL
+{
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Read-only file mapping
+class MapFile
+{
+private:
+    const uint8_t* mpData;      ///< Start of the mapping
+    size_t mSize;               ///< Mapping size in bytes
+    std::string mPath;          ///< Mapped file path
+#ifdef _WIN32
+    HANDLE mFile;               ///< File handle
+    HANDLE mMapping;            ///< File mapping handle
+#endif
+
+public:
+    //----------------------------------------------
+    /// Constructor
+    MapFile()
+        : mpData(nullptr), mSize(0)
+#ifdef _WIN32
+        , mFile(INVALID_HANDLE_VALUE), mMapping(nullptr)
+#endif
+    {
+    }
+
+    //----------------------------------------------
+    /// Destructor - unmaps the file
+    ~MapFile()
+    {
+        close();
+    }
+
+    MapFile(const MapFile&) = delete;
+    MapFile& operator=(const MapFile&) = delete;
+
+    //----------------------------------------------
+    /// Map a file
+    ///
+    /// @param[in] path     file to map
+    ///
+    /// @return 0 if ok, else negative error code
+    ///
+    int32_t open(const std::string& path)
+    {
+        close();
+#ifdef _WIN32
+        mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (INVALID_HANDLE_VALUE == mFile)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(mFile, &size) || (0 == size.QuadPart))
+        {
+            close();
+            return ST_ERR_FILE_READ;
+        }
+        mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (nullptr == mMapping)
+        {
+            close();
+            return ST_ERR_FILE_READ;
+        }
+        mpData = static_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+        if (nullptr == mpData)
+        {
+            close();
+            return ST_ERR_FILE_READ;
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return ST_ERR_FILE_OPEN;
+        }
+        struct stat st;
+        if ((0 != fstat(fd, &st)) || (st.st_size <= 0))
+        {
+            ::close(fd);
+            return ST_ERR_FILE_READ;
+        }
+        void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);    // The mapping keeps its own reference
+        if (MAP_FAILED == p)
+        {
+            return ST_ERR_FILE_READ;
+        }
+        mpData = static_cast<const uint8_t*>(p);
+        mSize = static_cast<size_t>(st.st_size);
+#endif
+        mPath = path;
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Unmap the file
+    void close()
+    {
+#ifdef _WIN32
+        if (nullptr != mpData)
+        {
+            UnmapViewOfFile(mpData);
+        }
+        if (nullptr != mMapping)
+        {
+            CloseHandle(mMapping);
+            mMapping = nullptr;
+        }
+        if (INVALID_HANDLE_VALUE != mFile)
+        {
+            CloseHandle(mFile);
+            mFile = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (nullptr != mpData)
+        {
+            munmap(const_cast<uint8_t*>(mpData), mSize);
+        }
+#endif
+        mpData = nullptr;
+        mSize = 0;
+        mPath.clear();
+    }
+
+    //----------------------------------------------
+    /// Ask the OS to read the whole mapping ahead
+    void prefetch() const
+    {
+#ifndef _WIN32
+        if (nullptr != mpData)
+        {
+            madvise(const_cast<uint8_t*>(mpData), mSize, MADV_WILLNEED);
+        }
+#endif
+    }
+
+    //----------------------------------------------
+    /// Ask the OS to read part of the mapping ahead
+    ///
+    /// @param[in] offset   start of the range
+    /// @param[in] bytes    range length (clipped to the mapping)
+    ///
+    void prefetch(size_t offset, size_t bytes) const
+    {
+#ifndef _WIN32
+        if ((nullptr != mpData) && (offset < mSize))
+        {
+            // madvise() needs a page-aligned start
+            size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t start = offset - (offset % page);
+            size_t end = (bytes < (mSize - offset)) ? (offset + bytes) : mSize;
+            madvise(const_cast<uint8_t*>(mpData) + start, end - start, MADV_WILLNEED);
+        }
+#else
+        (void)offset;
+        (void)bytes;
+#endif
+    }
+
+    bool isOpen() const { return nullptr != mpData; }       ///< A file is mapped
+    const uint8_t* data() const { return mpData; }          ///< Start of the mapping
+    size_t size() const { return mSize; }                   ///< Mapping size in bytes
+    const std::string& getPath() const { return mPath; }    ///< Mapped file path
+};
+
+} // namespace STUTIL
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // STUTIL_MAPFILE_HPP
@@ -0,0 +1,377 @@
+//******************************************************************
+/// @file stutil_workpool.hpp
+/// @brief Persistent worker thread pool for data-parallel frame processing
+/// @author      Sydor Technologies
+/// @date        10/18/2026
+/// @copyright   Copyright (c) 2026 Sydor Technologies, All rights reserved.
+///
+/// WorkPool keeps a fixed set of worker threads alive for the life of
+/// the pool so per-frame work does not pay thread creation costs.
+///
+/// parallelFor() splits an index range [0, count) into tiles of
+/// 'grain' indices. Workers (and the calling thread) claim tiles
+/// dynamically until the range is exhausted, then parallelFor()
+/// returns. Only one parallelFor() may be active at a time; calls
+/// from multiple threads are serialized.
+///
+/// A parallelFor() on the same pool from inside a tile function runs
+/// its whole range serially on the calling thread instead of waiting
+/// for the outer job. init() and shutdown() must not be called from a
+/// tile function.
+///
+/// An exception thrown by a tile function stops the remaining tiles
+/// from being started, and the first one is rethrown by parallelFor()
+/// once the tiles already running have finished.
+///
+/// Worker threads may optionally be pinned to a list of CPU cores.
+///
+/// @note A pool with a thread count of 0 or 1 runs everything on the
+/// calling thread.
+///
+//******************************************************************
+#ifndef STUTIL_WORKPOOL_HPP
+#define STUTIL_WORKPOOL_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "st_errors.h"
+
+#ifdef _WIN32
+    #include "stutil_platform.h"
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace STUTIL
+{
+//******************************************************************
+// Definitions and Constants
+//******************************************************************
+
+#define STUTIL_WORKPOOL_MAX_THREADS 64     ///< Upper limit on pool size
+
+//******************************************************************
+// Data structures, enumerations and type definitions
+//******************************************************************
+
+/// Tile function: process indices [begin, end)
+typedef std::function<void(size_t begin, size_t end)> WorkPoolFunc;
+
+//******************************************************************
+// Class Definitions
+//******************************************************************
+
+//----------------------------------------------
+/// Persistent worker thread pool
+class WorkPool
+{
+private:
+    std::vector<std::thread> mThreads;      ///< Worker threads (thread count - 1)
+    std::vector<int>        mCpuList;       ///< Affinity list (empty = no pinning)
+    std::mutex              mRunLock;       ///< Serializes parallelFor() callers
+    std::mutex              mLock;          ///< Protects job state below
+    std::condition_variable mStartCv;       ///< Signals workers to start a job
+    std::condition_variable mDoneCv;        ///< Signals caller that workers finished
+    uint64_t                mGeneration;    ///< Incremented for every new job
+    uint32_t                mActive;        ///< Workers still running the current job
+    bool                    mStop;          ///< Shut down request
+    const WorkPoolFunc*     mPFunc;         ///< Current job
+    size_t                  mCount;         ///< Current job index count
+    size_t                  mGrain;         ///< Current job tile size
+    std::atomic<size_t>     mNext;          ///< Next unclaimed index
+    std::exception_ptr      mError;         ///< First exception thrown by the current job
+    std::atomic<uint32_t>   mThreadCount;   ///< Total thread count, including the caller
+
+public:
+    //----------------------------------------------
+    /// Constructor - creates an empty (caller only) pool
+    WorkPool()
+        : mGeneration(0), mActive(0), mStop(false), mPFunc(nullptr),
+          mCount(0), mGrain(1), mNext(0), mThreadCount(1)
+    {
+    }
+
+    //----------------------------------------------
+    /// Destructor - joins all worker threads
+    ~WorkPool()
+    {
+        shutdown();
+    }
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    //----------------------------------------------
+    /// (Re)start the pool
+    ///
+    /// @param[in] threadCount  total threads including the calling thread.
+    ///                         0 selects std::thread::hardware_concurrency(),
+    ///                         limited to STUTIL_WORKPOOL_MAX_THREADS
+    /// @param[in] cpuList      cores to pin workers to, assigned round-robin.
+    ///                         Empty for no pinning.
+    ///
+    /// @return 0 if ok, ST_ERR_PARAM if an explicit threadCount is above
+    ///         STUTIL_WORKPOOL_MAX_THREADS, else negative error code
+    ///
+    int32_t init(uint32_t threadCount, const std::vector<int>& cpuList = std::vector<int>())
+    {
+        std::lock_guard<std::mutex> runLock(mRunLock);
+
+        if (0 == threadCount)
+        {
+            threadCount = std::thread::hardware_concurrency();
+            if (0 == threadCount)
+            {
+                threadCount = 1;
+            }
+            else if (threadCount > STUTIL_WORKPOOL_MAX_THREADS)
+            {
+                threadCount = STUTIL_WORKPOOL_MAX_THREADS;
+            }
+        }
+        else if (threadCount > STUTIL_WORKPOOL_MAX_THREADS)
+        {
+            return ST_ERR_PARAM;
+        }
+
+        stopWorkers();
+        mCpuList = cpuList;
+        mStop = false;
+
+        try
+        {
+            for (uint32_t i = 1; i < threadCount; i++)
+            {
+                mThreads.push_back(std::thread(&WorkPool::workerMain, this, mGeneration));
+                if (!mCpuList.empty())
+                {
+                    setAffinity(mThreads.back(), mCpuList[(i - 1) % mCpuList.size()]);
+                }
+            }
+            mThreadCount.store(threadCount);
+        }
+        catch (...)
+        {
+            stopWorkers();
+            return ST_ERR_THREAD_CREATE;
+        }
+        return ST_ERR_OK;
+    }
+
+    //----------------------------------------------
+    /// Stop and join all worker threads
+    void shutdown()
+    {
+        std::lock_guard<std::mutex> runLock(mRunLock);
+        stopWorkers();
+    }
+
+    //----------------------------------------------
+    /// Return the total thread count, including the calling thread
+    uint32_t getThreadCount()
+    {
+        return mThreadCount.load();
+    }
+
+    //----------------------------------------------
+    /// Return the configured affinity list
+    std::vector<int> getCpuList()
+    {
+        std::lock_guard<std::mutex> runLock(mRunLock);
+        return mCpuList;
+    }
+
+    //----------------------------------------------
+    /// Run func over [0, count) in tiles of grain indices
+    ///
+    /// Blocks until all tiles have completed. The calling thread
+    /// processes tiles as well. Rethrows the first exception thrown by
+    /// func.
+    ///
+    /// @param[in] count    number of indices (e.g. image rows)
+    /// @param[in] grain    indices per tile
+    /// @param[in] func     tile function, called with [begin, end)
+    ///
+    void parallelFor(size_t count, size_t grain, const WorkPoolFunc& func)
+    {
+        if (0 == count)
+        {
+            return;
+        }
+        if (0 == grain)
+        {
+            grain = 1;
+        }
+
+        // Nested call from one of our own tiles: the workers are busy
+        // with the outer job, so run this one here
+        if (this == currentPool())
+        {
+            func(0, count);
+            return;
+        }
+
+        std::lock_guard<std::mutex> runLock(mRunLock);
+
+        // Small jobs or an empty pool: don't wake anybody
+        if (mThreads.empty() || (count <= grain))
+        {
+            PoolScope scope(this);
+            func(0, count);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mPFunc = &func;
+            mCount = count;
+            mGrain = grain;
+            mNext.store(0);
+            mActive = static_cast<uint32_t>(mThreads.size());
+            mGeneration++;
+        }
+        mStartCv.notify_all();
+
+        runTiles();
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mLock);
+            mDoneCv.wait(lock, [this]{ return 0 == mActive; });
+            mPFunc = nullptr;
+            error = mError;
+            mError = nullptr;
+        }
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    //----------------------------------------------
+    /// Claim and process tiles until none remain
+    void runTiles()
+    {
+        PoolScope scope(this);
+        size_t begin;
+        while ((begin = mNext.fetch_add(mGrain)) < mCount)
+        {
+            size_t end = begin + mGrain;
+            try
+            {
+                (*mPFunc)(begin, (end < mCount) ? end : mCount);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mLock);
+                if (!mError)
+                {
+                    mError = std::current_exception();
+                }
+                mNext.store(mCount);    // Don't start any more tiles
+            }
+        }
+    }
+
+    //----------------------------------------------
+    /// Return the pool whose tiles the calling thread is running
+    static const WorkPool*& currentPool()
+    {
+        static thread_local const WorkPool* pPool = nullptr;
+        return pPool;
+    }
+
+    //----------------------------------------------
+    /// Marks the calling thread as running tiles of a pool
+    struct PoolScope
+    {
+        const WorkPool* pOuter;
+        explicit PoolScope(const WorkPool* pPool) : pOuter(currentPool()) { currentPool() = pPool; }
+        ~PoolScope() { currentPool() = pOuter; }
+    };
+
+    //----------------------------------------------
+    /// Worker thread main loop
+    void workerMain(uint64_t generation)
+    {
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mLock);
+                mStartCv.wait(lock, [this, generation]{ return mStop || (mGeneration != generation); });
+                if (mStop)
+                {
+                    return;
+                }
+                generation = mGeneration;
+            }
+
+            runTiles();
+
+            std::lock_guard<std::mutex> lock(mLock);
+            if (0 == --mActive)
+            {
+                mDoneCv.notify_one();
+            }
+        }
+    }
+
+    //----------------------------------------------
+    /// Signal and join workers (mRunLock must be held)
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mLock);
+            mStop = true;
+        }
+        mStartCv.notify_all();
+        for (auto& t : mThreads)
+        {
+            if (t.joinable())
+            {
+                t.join();
+            }
+        }
+        mThreads.clear();
+        mThreadCount.store(1);
+    }
+
+    //----------------------------------------------
+    /// Pin a thread to a single core (best effort)
+    static void setAffinity(std::thread& t, int cpu)
+    {
+        if (cpu < 0)
+        {
+            return;
+        }
+#ifdef _WIN32
+        if (cpu < 64)
+        {
+            SetThreadAffinityMask(t.native_handle(), static_cast<DWORD_PTR>(1) << cpu);
+        }
+#elif defined(__linux__)
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        CPU_SET(cpu, &cpuSet);
+        pthread_setaffinity_np(t.native_handle(), sizeof(cpuSet), &cpuSet);
+#else
+        (void)t;
+#endif
+    }
+};
+
+} // namespace STUTIL
+
+//******************************************************************
+// End of file
+//******************************************************************
+#endif // STUTIL_WORKPOOL_HPP
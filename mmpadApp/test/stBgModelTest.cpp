@@ -0,0 +1,179 @@
+/* stBgModelTest.cpp
+ *
+ * Unit tests for the streaming background estimator
+ * (st_background_model.h): EMA and window estimates against a direct
+ * computation, the window sum over many wraps with large pixel values,
+ * the publish interval, held snapshots staying unchanged, snapshot
+ * buffer reuse and init() argument checks.
+ *
+ */
+
+#include <math.h>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_background_model.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t width = 16;
+static const uint32_t height = 8;
+static const uint32_t pixels = width * height;
+
+/* Frame n, pixel i */
+static int32_t pixelValue(uint32_t n, uint32_t i)
+{
+    return static_cast<int32_t>((n * 131 + i * 17) % 251) - 100;
+}
+
+static void fillFrame(uint32_t n, std::vector<int32_t>& frame)
+{
+    frame.resize(pixels);
+    for (uint32_t i = 0; i < pixels; i++) frame[i] = pixelValue(n, i);
+}
+
+static void testEma(void)
+{
+    StBackgroundModel model;
+    std::vector<int32_t> frame;
+    std::vector<double> expect(pixels);
+    const double alpha = 0.25;
+
+    testOk1(model.init(width, height, ST_BG_MODEL_EMA, alpha) == 0);
+    testOk(!model.getSnapshot(), "nothing published before the first frame");
+    for (uint32_t n = 0; n < 10; n++) {
+        fillFrame(n, frame);
+        model.addPixels(frame.data());
+        for (uint32_t i = 0; i < pixels; i++) {
+            expect[i] = (n == 0) ? frame[i] : expect[i] + alpha * (frame[i] - expect[i]);
+        }
+    }
+    StBgSnapshot snap = model.getSnapshot();
+    bool match = snap && (snap->size() == pixels);
+    for (uint32_t i = 0; match && (i < pixels); i++) {
+        if (fabs((*snap)[i] - expect[i]) > 1e-9) match = false;
+    }
+    testOk(match, "EMA matches the direct computation");
+    testOk1(model.getUpdateCount() == 10);
+}
+
+static void testWindow(void)
+{
+    const uint32_t window = 5;
+    StBackgroundModel model;
+    std::vector<int32_t> frame;
+
+    testOk1(model.init(width, height, ST_BG_MODEL_WINDOW, 0.0, window) == 0);
+
+    /* Partly filled window: mean of the frames so far */
+    for (uint32_t n = 0; n < 3; n++) {
+        fillFrame(n, frame);
+        model.addPixels(frame.data());
+    }
+    StBgSnapshot snap = model.getSnapshot();
+    double mean = (pixelValue(0, 7) + pixelValue(1, 7) + pixelValue(2, 7)) / 3.0;
+    testOk(snap && fabs((*snap)[7] - mean) < 1e-9, "mean of a partly filled window");
+
+    /* Many wraps: mean of the last 'window' frames */
+    uint32_t last = 0;
+    for (uint32_t n = 3; n < 203; n++) {
+        fillFrame(n, frame);
+        model.addPixels(frame.data());
+        last = n;
+    }
+    snap = model.getSnapshot();
+    bool match = true;
+    for (uint32_t i = 0; i < pixels; i++) {
+        double sum = 0.0;
+        for (uint32_t n = last + 1 - window; n <= last; n++) sum += pixelValue(n, i);
+        if (fabs((*snap)[i] - sum / window) > 1e-9) match = false;
+    }
+    testOk(match, "sliding window mean after 40 wraps");
+}
+
+static void testWindowDrift(void)
+{
+    /* Large and small values whose sum is not exact even in double */
+    const uint32_t window = 4;
+    StBackgroundModel model;
+    std::vector<float> frame(pixels);
+
+    model.init(width, height, ST_BG_MODEL_WINDOW, 0.0, window);
+    for (uint32_t n = 0; n < 1000; n++) {
+        float v = (n % 2) ? 1.0e20f : 0.1f * static_cast<float>(n % 7);
+        for (uint32_t i = 0; i < pixels; i++) frame[i] = v;
+        model.addPixels(frame.data());
+    }
+    /* A full window of small values: the sum must come back to them */
+    for (uint32_t n = 0; n < window; n++) {
+        for (uint32_t i = 0; i < pixels; i++) frame[i] = 1.5f;
+        model.addPixels(frame.data());
+    }
+    StBgSnapshot snap = model.getSnapshot();
+    testOk(snap && (*snap)[0] == 1.5 && (*snap)[pixels - 1] == 1.5,
+           "window sum does not drift (%g)", snap ? (*snap)[0] : 0.0);
+}
+
+static void testSnapshots(void)
+{
+    StBackgroundModel model;
+    std::vector<int32_t> frame;
+
+    model.init(width, height, ST_BG_MODEL_EMA, 1.0, 16, 3);
+    for (uint32_t n = 0; n < 2; n++) {
+        fillFrame(n, frame);
+        model.addPixels(frame.data());
+    }
+    testOk(!model.getSnapshot(), "no snapshot before publishInterval frames");
+    fillFrame(2, frame);
+    model.addPixels(frame.data());
+    StBgSnapshot held = model.getSnapshot();
+    testOk1(held && (*held)[3] == pixelValue(2, 3));
+
+    /* A held snapshot never changes; released buffers are reused */
+    const double *pHeld = held->data();
+    const double *pSecond = NULL;
+    bool unchanged = true;
+    bool reused = false;
+    for (uint32_t n = 3; n < 30; n++) {
+        fillFrame(n, frame);
+        model.addPixels(frame.data());
+        if ((*held)[3] != pixelValue(2, 3)) unchanged = false;
+        if ((n + 1) % 3 == 0) {
+            StBgSnapshot snap = model.getSnapshot();
+            if (snap->data() == pHeld) unchanged = false;
+            if (pSecond == NULL) pSecond = snap->data();
+            else if (snap->data() == pSecond) reused = true;
+        }
+    }
+    testOk(unchanged, "held snapshot unchanged and never rewritten");
+    testOk(reused, "released snapshot buffers are reused");
+}
+
+static void testInit(void)
+{
+    StBackgroundModel model;
+    std::vector<int32_t> frame;
+
+    testOk1(model.init(0, height) == ST_ERR_DIMENSION);
+    testOk1(model.init(width, height, ST_BG_MODEL_EMA, 0.0) == ST_ERR_PARAM);
+    testOk1(model.init(width, height, ST_BG_MODEL_WINDOW, 0.0, ST_BG_MODEL_MAX_WINDOW + 1) == ST_ERR_PARAM);
+
+    /* Frames before init() are ignored */
+    fillFrame(0, frame);
+    model.addPixels(frame.data());
+    testOk1(model.getUpdateCount() == 0 && !model.getSnapshot());
+}
+
+MAIN(stBgModelTest)
+{
+    testPlan(16);
+    testEma();
+    testWindow();
+    testWindowDrift();
+    testSnapshots();
+    testInit();
+    return testDone();
+}
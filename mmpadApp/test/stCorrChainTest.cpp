@@ -0,0 +1,173 @@
+/* stCorrChainTest.cpp
+ *
+ * Unit tests for the fused correction chains (st_corr_chain.h): chain
+ * selection, and every geocorrection/debounce/background combination
+ * checked against the same steps run as separate passes in the order
+ * applyCorrections() uses (geocorrection, debounce, background).
+ *
+ */
+
+#include <math.h>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_corr_chain.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t srcWidth = 8;
+static const uint32_t srcHeight = 6;
+static const uint32_t outWidth = 7;
+static const uint32_t outHeight = 9;
+
+/* A small remap with one, two and zero terms per output pixel */
+static void buildRemap(StRemapTable& remap)
+{
+    std::vector<StRemapTerm> terms;
+    uint32_t srcPixels = srcWidth * srcHeight;
+    for (uint32_t o = 0; o < outWidth * outHeight; o++) {
+        if (o % 5 == 4) continue;
+        StRemapTerm t = { o, (o * 7) % srcPixels, 0.75f };
+        terms.push_back(t);
+        if (o % 2) {
+            StRemapTerm t2 = { o, (o * 3 + 1) % srcPixels, 0.25f };
+            terms.push_back(t2);
+        }
+    }
+    remap.build(srcWidth, srcHeight, outWidth, outHeight, terms);
+}
+
+/* The same steps as separate full-image passes */
+template<typename D>
+static void unfused(const int32_t *pSrc, bool geo, StChainDebounce deb, StChainBg bg,
+                    const StRemapTable& remap, const StCorrChainArgs& args, std::vector<D>& out)
+{
+    uint32_t count = outWidth * outHeight;
+    std::vector<uint8_t> scratch;
+    out.assign(count, 0);
+    if (geo) {
+        remap.applyRows(pSrc, out.data(), 0, outHeight);
+    } else {
+        for (uint32_t o = 0; o < count; o++) out[o] = static_cast<D>(pSrc[o]);
+    }
+    if (ST_CHAIN_DEBOUNCE_STEP == deb) {
+        debounceStepKernel<D>(out.data(), outWidth, outHeight, args.debounce, scratch);
+    } else if (ST_CHAIN_DEBOUNCE_CLAMP == deb) {
+        debounceClampKernel<D>(out.data(), outWidth, outHeight, args.debounce, scratch);
+    }
+    for (uint32_t o = 0; o < count; o++) {
+        if (ST_CHAIN_BG_FLOAT == bg) out[o] -= static_cast<D>(args.pBgF[o]);
+        else if (ST_CHAIN_BG_DOUBLE == bg) out[o] -= static_cast<D>(args.pBgD[o]);
+    }
+}
+
+/* Run every combination for one output type; returns the number of mismatches */
+template<typename D>
+static uint32_t compareAll(STDataType destType, double tolerance)
+{
+    StRemapTable remap;
+    buildRemap(remap);
+
+    /* Source covers both geometries; values straddle the debounce limits */
+    uint32_t count = outWidth * outHeight;
+    std::vector<int32_t> src(count);
+    std::vector<float> bgF(count);
+    std::vector<double> bgD(count);
+    for (uint32_t i = 0; i < count; i++) {
+        src[i] = static_cast<int32_t>((i * 37) % 61) - 30;
+        bgF[i] = static_cast<float>(i % 9) * 0.5f;
+        bgD[i] = static_cast<double>(i % 11) * 0.25;
+    }
+
+    StCorrChainArgs args = {};
+    args.pSrc = src.data();
+    args.width = outWidth;
+    args.pRemap = &remap;
+    args.pBgF = bgF.data();
+    args.pBgD = bgD.data();
+    args.debounce.stepAdu = 20.0;
+    args.debounce.floor = -4.0;
+
+    uint32_t bad = 0;
+    for (int geo = 0; geo < 2; geo++) {
+        for (int deb = 0; deb < ST_CHAIN_DEBOUNCE_COUNT; deb++) {
+            for (int bg = 0; bg < ST_CHAIN_BG_COUNT; bg++) {
+                StChainDebounce d = static_cast<StChainDebounce>(deb);
+                StChainBg b = static_cast<StChainBg>(bg);
+                std::vector<D> expect;
+                unfused<D>(src.data(), geo != 0, d, b, remap, args, expect);
+
+                /* Fused, in two row tiles */
+                std::vector<D> out(count, static_cast<D>(-999));
+                args.pDest = out.data();
+                StCorrChainFunc chain = selectCorrChain(DT_INT32, destType, geo != 0, d, b);
+                if (nullptr == chain) {
+                    bad++;
+                    continue;
+                }
+                chain(args, 0, 4);
+                chain(args, 4, outHeight);
+                for (uint32_t o = 0; o < count; o++) {
+                    if (fabs(static_cast<double>(out[o]) - static_cast<double>(expect[o])) > tolerance) {
+                        testDiag("geo %d deb %d bg %d pixel %u: fused %g, separate %g", geo, deb, bg, o,
+                                 static_cast<double>(out[o]), static_cast<double>(expect[o]));
+                        bad++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return bad;
+}
+
+static void testSelect(void)
+{
+    StChainDebounce deb = ST_CHAIN_DEBOUNCE_COUNT;
+
+    testOk1(getChainDebounce(false, ST_DEBOUNCE_NEIGHBOR, deb) && deb == ST_CHAIN_DEBOUNCE_NONE);
+    testOk1(getChainDebounce(true, ST_DEBOUNCE_STEP, deb) && deb == ST_CHAIN_DEBOUNCE_STEP);
+    testOk1(getChainDebounce(true, ST_DEBOUNCE_CLAMP, deb) && deb == ST_CHAIN_DEBOUNCE_CLAMP);
+    testOk(!getChainDebounce(true, ST_DEBOUNCE_NEIGHBOR, deb), "neighbor debounce is not fused");
+
+    testOk1(selectCorrChain(DT_UINT16, DT_FLOAT, true, ST_CHAIN_DEBOUNCE_STEP, ST_CHAIN_BG_FLOAT) != nullptr);
+    testOk1(selectCorrChain(DT_INT32, DT_DOUBLE, false, ST_CHAIN_DEBOUNCE_NONE, ST_CHAIN_BG_DOUBLE) != nullptr);
+    testOk(selectCorrChain(DT_INT32, DT_INT32, true, ST_CHAIN_DEBOUNCE_NONE, ST_CHAIN_BG_NONE) == nullptr,
+           "integer output is not supported");
+    testOk1(selectCorrChain(DT_INT32, DT_DOUBLE, true, ST_CHAIN_DEBOUNCE_COUNT, ST_CHAIN_BG_NONE) == nullptr);
+    testOk1(selectCorrChain(DT_INT32, DT_DOUBLE, true, ST_CHAIN_DEBOUNCE_NONE, ST_CHAIN_BG_COUNT) == nullptr);
+
+    /* Each combination is its own instantiation */
+    testOk1(selectCorrChain(DT_INT32, DT_DOUBLE, true, ST_CHAIN_DEBOUNCE_STEP, ST_CHAIN_BG_DOUBLE) !=
+            selectCorrChain(DT_INT32, DT_DOUBLE, true, ST_CHAIN_DEBOUNCE_STEP, ST_CHAIN_BG_FLOAT));
+}
+
+static void testOrder(void)
+{
+    /* -3 is above the -step/2 fold limit, -3 - 5 is below it */
+    int32_t src = -3;
+    double bg = 5.0;
+    double out = 0.0;
+    StCorrChainArgs args = {};
+    args.pSrc = &src;
+    args.pDest = &out;
+    args.width = 1;
+    args.pBgD = &bg;
+    args.debounce.stepAdu = 10.0;
+
+    StCorrChainFunc chain = selectCorrChain(DT_INT32, DT_DOUBLE, false, ST_CHAIN_DEBOUNCE_STEP, ST_CHAIN_BG_DOUBLE);
+    chain(args, 0, 1);
+    testOk(out == -8.0, "debounce runs before background subtraction (%g)", out);
+}
+
+MAIN(stCorrChainTest)
+{
+    testPlan(13);
+    testSelect();
+    testOrder();
+    testOk(compareAll<double>(DT_DOUBLE, 0.0) == 0, "double chains match the separate passes");
+    testOk(compareAll<float>(DT_FLOAT, 1e-5) == 0, "float chains match the separate passes");
+    return testDone();
+}
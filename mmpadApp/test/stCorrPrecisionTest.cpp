@@ -0,0 +1,121 @@
+/* stCorrPrecisionTest.cpp
+ *
+ * Unit tests for the float precision mode (st_corr_precision.h):
+ * raw pixel values below 2^24 round-trip through float exactly, a
+ * geocorrection/background/gain chain evaluated in float stays within
+ * corrFloatErrorBound() of the double chain, narrowing clamps to the
+ * finite float range, and the comparison reports the deviation.
+ *
+ */
+
+#include <math.h>
+#include <float.h>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_corr_precision.h"
+
+using namespace ST_INTERFACE;
+
+static void testPixelType(void)
+{
+    testOk1(getCorrPixelType(ST_CORR_PRECISION_DOUBLE) == DT_DOUBLE);
+    testOk1(getCorrPixelType(ST_CORR_PRECISION_FLOAT) == DT_FLOAT);
+}
+
+static void testRoundTrip(void)
+{
+    /* Integer raw values up to 2^24 are exact in float */
+    const double exact[] = { 0.0, 1.0, -1.0, 65535.0, 1048575.0, 16777216.0, -16777216.0 };
+    bool ok = true;
+    for (size_t i = 0; i < sizeof(exact) / sizeof(exact[0]); i++) {
+        if (static_cast<double>(corrToFloat(exact[i])) != exact[i]) ok = false;
+    }
+    testOk(ok, "integers up to 2^24 round-trip exactly");
+    testOk1(static_cast<double>(corrToFloat(16777217.0)) != 16777217.0);
+
+    /* Arbitrary values round-trip within one unit roundoff */
+    double worst = 0.0;
+    for (int i = 1; i < 1000; i++) {
+        double v = 1.0e-3 * i * i + 0.1234567 * i;
+        double err = fabs(static_cast<double>(corrToFloat(v)) - v) / fabs(v);
+        if (err > worst) worst = err;
+    }
+    testOk(worst <= ST_CORR_FLOAT_UNIT_ROUNDOFF, "round-trip error %g <= 2^-24", worst);
+}
+
+/* out = (sum_k(w_k * x_k) - bg) * gain evaluated as in the pipeline */
+template<typename T>
+static T chain(const double* w, const double* x, uint32_t terms, double bg, double gain)
+{
+    T sum = 0;
+    for (uint32_t k = 0; k < terms; k++) {
+        sum += static_cast<T>(w[k]) * static_cast<T>(x[k]);
+    }
+    return (sum - static_cast<T>(bg)) * static_cast<T>(gain);
+}
+
+static void testErrorBound(void)
+{
+    const uint32_t terms = 4;
+    const size_t count = 2000;
+    std::vector<double> ref(count);
+    std::vector<float> flt(count);
+    bool within = true;
+    for (size_t i = 0; i < count; i++) {
+        double w[terms] = { 0.1 + 0.0001 * i, 0.3, 0.25 - 0.00005 * i, 0.35 };
+        double x[terms] = { 1000.3 + 977.0 * i, 50.7 * i, 1999999.1 - 3.0 * i, 12.5 };
+        double bg = 321.123 + 0.01 * i;
+        double gain = 0.97 + 0.00003 * i;
+        ref[i] = chain<double>(w, x, terms, bg, gain);
+        flt[i] = chain<float>(w, x, terms, bg, gain);
+
+        double magnitude = bg;
+        for (uint32_t k = 0; k < terms; k++) magnitude += fabs(w[k] * x[k]);
+        magnitude *= fabs(gain);
+        if (fabs(static_cast<double>(flt[i]) - ref[i]) > corrFloatErrorBound(magnitude, terms)) {
+            within = false;
+        }
+    }
+    testOk(within, "float chain within corrFloatErrorBound() of the double chain");
+
+    double maxAbs = -1.0;
+    double maxRel = -1.0;
+    testOk1(compareCorrPixels(ref.data(), flt.data(), count, maxAbs, maxRel) == ST_ERR_OK);
+    testOk(maxAbs > 0.0 && maxAbs < 1.0, "largest deviation %g ADU is below 1 ADU", maxAbs);
+    testOk(maxRel <= corrFloatErrorBound(1.0, terms), "relative deviation %g within the bound", maxRel);
+
+    /* The bound is under 1 ADU at the documented 2e6 ADU limit */
+    testOk1(corrFloatErrorBound(2.0e6, terms) < 1.0);
+    testOk1(corrFloatErrorBound(-2.0e6, 0) == corrFloatErrorBound(2.0e6, 0));
+}
+
+static void testClamp(void)
+{
+    testOk1(corrToFloat(1.0e300) == FLT_MAX);
+    testOk1(corrToFloat(-1.0e300) == -FLT_MAX);
+    testOk1(corrToFloat(static_cast<double>(FLT_MAX)) == FLT_MAX);
+    testOk1(isnan(corrToFloat(NAN)));
+
+    const double src[4] = { 1.0e39, -1.0e39, 2.5, -7.0 };
+    float dest[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    corrToFloatPixels(src, dest, 4);
+    testOk(dest[0] == FLT_MAX && dest[1] == -FLT_MAX && dest[2] == 2.5f && dest[3] == -7.0f,
+           "run narrowing clamps only out of range pixels");
+
+    double maxAbs = 0.0;
+    double maxRel = 0.0;
+    testOk1(compareCorrPixels(src, nullptr, 4, maxAbs, maxRel) == ST_ERR_NULL_PTR);
+}
+
+MAIN(stCorrPrecisionTest)
+{
+    testPlan(17);
+    testPixelType();
+    testRoundTrip();
+    testErrorBound();
+    testClamp();
+    return testDone();
+}
@@ -0,0 +1,132 @@
+/* stDictCacheTest.cpp
+ *
+ * Unit tests for the binary data dictionary snapshot encoding
+ * (st_dict_cache.h): writer/reader round trip, bounds checks on
+ * short or damaged payloads, checksum and snapshot file names.
+ *
+ */
+
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_dict_cache.h"
+
+using namespace ST_INTERFACE;
+
+static std::string makePayload(void)
+{
+    StDictWriter w;
+    std::vector<std::string> strs;
+    strs.push_back("alpha");
+    strs.push_back("");
+    strs.push_back("gamma");
+
+    w.put<uint32_t>(0x12345678);
+    w.put<double>(-2.5);
+    w.put<uint8_t>(1);
+    w.putStr("Sensor_Temp");
+    w.putStrs(strs);
+    return w.getBuffer();
+}
+
+static void testRoundTrip(void)
+{
+    std::string payload = makePayload();
+    StDictReader r(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+
+    testOk1(r.get<uint32_t>() == 0x12345678);
+    testOk1(r.get<double>() == -2.5);
+    testOk1(r.get<uint8_t>() == 1);
+    testOk1(r.getStr() == "Sensor_Temp");
+    std::vector<std::string> strs = r.getStrs();
+    testOk(strs.size() == 3 && strs[0] == "alpha" && strs[1].empty() && strs[2] == "gamma",
+           "string list round trip");
+    testOk(r.isOk() && r.atEnd(), "whole payload consumed");
+}
+
+static void testShortPayload(void)
+{
+    std::string payload = makePayload();
+
+    // Every truncation must fail cleanly, never read past the end
+    bool allFailed = true;
+    for (size_t len = 0; len < payload.size(); len++) {
+        StDictReader r(reinterpret_cast<const uint8_t*>(payload.data()), len);
+        r.get<uint32_t>();
+        r.get<double>();
+        r.get<uint8_t>();
+        r.getStr();
+        r.getStrs();
+        if (r.isOk()) allFailed = false;
+    }
+    testOk(allFailed, "every truncated payload is rejected");
+
+    // A failed read returns zero and leaves the reader failed
+    uint8_t two[2] = { 1, 2 };
+    StDictReader r(two, sizeof(two));
+    testOk1(r.get<uint32_t>() == 0);
+    testOk1(!r.isOk() && !r.atEnd());
+    testOk1(r.get<uint8_t>() == 0);
+
+    StDictReader n(nullptr, 16);
+    testOk(!n.isOk(), "null payload is not ok");
+}
+
+static void testBadCounts(void)
+{
+    // String length larger than the payload
+    StDictWriter w;
+    w.put<uint32_t>(1000);
+    w.put<uint32_t>(0);
+    StDictReader r(reinterpret_cast<const uint8_t*>(w.getBuffer().data()), w.getBuffer().size());
+    testOk1(r.getStr().empty() && !r.isOk());
+
+    // A huge list count must not allocate or loop
+    StDictWriter wl;
+    wl.put<uint32_t>(0xFFFFFFFF);
+    wl.putStr("x");
+    StDictReader rl(reinterpret_cast<const uint8_t*>(wl.getBuffer().data()), wl.getBuffer().size());
+    testOk1(rl.getStrs().empty() && !rl.isOk());
+}
+
+static void testChecksum(void)
+{
+    // FNV-1a 64 reference values
+    testOk1(stDictChecksum("", 0) == 0xcbf29ce484222325ull);
+    testOk1(stDictChecksum("a", 1) == 0xaf63dc4c8601ec8cull);
+    testOk1(stDictChecksum("foobar", 6) == 0x85944171f73967e8ull);
+
+    std::string payload = makePayload();
+    uint64_t sum = stDictChecksum(payload.data(), payload.size());
+    payload[payload.size() / 2] ^= 0x01;
+    testOk(sum != stDictChecksum(payload.data(), payload.size()), "one bit flip changes the checksum");
+}
+
+static void testPaths(void)
+{
+    testOk1(sizeof(StDictCacheHeader) == 48);
+    testOk1(makeDictCachePath("", 3, "2026-10-18").empty());
+    testOk1(makeDictCachePath("/tmp/cache", 3, "2026-10-18") == "/tmp/cache/st_dict_3_2026-10-18.bin");
+    testOk1(makeDictCachePath("/tmp/cache/", 3, "2026-10-18") == "/tmp/cache/st_dict_3_2026-10-18.bin");
+    testOk1(makeDictCachePath("c", 12, "10/18/26 9:00") == "c/st_dict_12_10_18_26_9_00.bin");
+
+    setenv(ST_DICT_CACHE_DIR_ENV, "/var/cache/mmpad", 1);
+    testOk1(getDefaultDictCacheDir() == "/var/cache/mmpad");
+    unsetenv(ST_DICT_CACHE_DIR_ENV);
+    testOk1(getDefaultDictCacheDir().empty());
+}
+
+MAIN(stDictCacheTest)
+{
+    testPlan(24);
+    testRoundTrip();
+    testShortPayload();
+    testBadCounts();
+    testChecksum();
+    testPaths();
+    return testDone();
+}
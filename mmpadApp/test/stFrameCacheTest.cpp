@@ -0,0 +1,241 @@
+/* stFrameCacheTest.cpp
+ *
+ * Unit tests for the run frame cache (st_frame_cache.h): hits and
+ * misses, least recently used eviction within the byte budget, run
+ * invalidation, sequential read-ahead that stops at the end of a run,
+ * and concurrent readers of one frame sharing a single load.
+ *
+ */
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_frame_cache.h"
+
+using namespace ST_INTERFACE;
+
+/* Stand-in for StFrameBuffer: a frame number and a byte size */
+struct TestFrame
+{
+    uint32_t frameNumber;
+    uint32_t bytes;
+
+    TestFrame() : frameNumber(UINT32_MAX), bytes(0) {}
+    uint32_t getFrameBytes(void) const { return bytes; }
+};
+
+typedef StFrameCacheT<TestFrame> TestCache;
+
+static const uint32_t frameBytes = 1000;
+static const size_t entryBytes = frameBytes + ST_FRAME_CACHE_ENTRY_BYTES;
+
+/* Loader over a run of runFrames frames that counts its calls */
+struct TestLoader
+{
+    std::atomic<uint32_t> calls;
+    uint32_t runFrames;
+    uint32_t delayMs;
+
+    TestLoader() : calls(0), runFrames(100), delayMs(0) {}
+
+    int32_t operator()(const StFrameCacheKey& key, TestFrame& frame)
+    {
+        calls++;
+        if (delayMs) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+        }
+        if (key.frameNumber >= runFrames) return ST_ERR_FRAME_NUMBER;
+        frame.frameNumber = key.frameNumber;
+        frame.bytes = frameBytes;
+        return ST_ERR_OK;
+    }
+};
+
+static TestCache::Loader bind(TestLoader& loader)
+{
+    return [&loader](const StFrameCacheKey& key, TestFrame& frame) { return loader(key, frame); };
+}
+
+static StFrameCacheKey key(uint32_t frame, const char *run = "run1")
+{
+    return StFrameCacheKey("set1", run, frame, DT_ANY);
+}
+
+static void testHitMissEvict(void)
+{
+    TestLoader loader;
+    TestCache cache(bind(loader));
+    TestFrame frame;
+    StFrameCacheStats stats;
+
+    /* Room for three frames, no read-ahead */
+    testOk1(cache.setLimits(3 * entryBytes, 0) == 0);
+    testOk1(cache.setLimits(0, ST_FRAME_CACHE_MAX_AHEAD + 1) == ST_ERR_PARAM);
+
+    testOk1(cache.get(key(5), frame) == 0 && frame.frameNumber == 5);
+    testOk1(cache.get(key(5), frame) == 0 && frame.frameNumber == 5);
+    testOk(loader.calls == 1, "second read of a frame is a hit");
+
+    cache.get(key(6), frame);
+    cache.get(key(7), frame);
+    cache.get(key(5), frame);       /* 5 is now the most recently used */
+    cache.get(key(8), frame);       /* evicts 6 */
+    cache.getStats(stats);
+    testOk1(stats.frames == 3 && stats.bytes == 3 * entryBytes && stats.evictions == 1);
+
+    uint32_t calls = loader.calls;
+    cache.get(key(5), frame);
+    cache.get(key(7), frame);
+    testOk(loader.calls == calls, "recently used frames kept");
+    cache.get(key(6), frame);
+    testOk(loader.calls == calls + 1, "least recently used frame evicted");
+
+    /* The same frame of another run is a different entry */
+    cache.get(key(5, "run2"), frame);
+    testOk1(loader.calls == calls + 2);
+
+    /* Load errors are returned and not cached */
+    calls = loader.calls;
+    testOk1(cache.get(key(500), frame) == ST_ERR_FRAME_NUMBER);
+    testOk1(cache.get(key(500), frame) == ST_ERR_FRAME_NUMBER && loader.calls == calls + 2);
+
+    cache.getStats(stats);
+    testOk1(stats.hits == 4 && stats.misses == 8 && stats.loadErrors == 2);
+    testOk1(stats.maxBytes == 3 * entryBytes && stats.bytes <= stats.maxBytes);
+
+    cache.resetStats();
+    cache.getStats(stats);
+    testOk(stats.hits == 0 && stats.misses == 0 && stats.frames == 3, "reset keeps the frames");
+
+    /* Shrinking the budget evicts at once; 0 disables caching */
+    cache.setLimits(entryBytes, 0);
+    cache.getStats(stats);
+    testOk1(stats.frames == 1);
+    cache.setLimits(0, 0);
+    calls = loader.calls;
+    cache.get(key(1), frame);
+    cache.get(key(1), frame);
+    testOk(loader.calls == calls + 2 && frame.frameNumber == 1, "zero budget loads every time");
+}
+
+static void testInvalidate(void)
+{
+    TestLoader loader;
+    TestCache cache(bind(loader));
+    TestFrame frame;
+    StFrameCacheStats stats;
+
+    cache.setLimits(10 * entryBytes, 0);
+    cache.get(key(1), frame);
+    cache.get(key(2), frame);
+    cache.get(key(1, "run2"), frame);
+    cache.invalidate("set1", "run1");
+    cache.getStats(stats);
+    testOk(stats.frames == 1 && stats.bytes == entryBytes, "only the invalidated run dropped");
+
+    uint32_t calls = loader.calls;
+    cache.get(key(1), frame);
+    cache.get(key(1, "run2"), frame);
+    testOk1(loader.calls == calls + 1);
+
+    cache.clear();
+    cache.getStats(stats);
+    testOk1(stats.frames == 0 && stats.bytes == 0);
+}
+
+/* Wait until the read-ahead thread has loaded 'count' frames */
+static bool waitPrefetched(TestCache& cache, uint64_t count)
+{
+    StFrameCacheStats stats;
+    for (int i = 0; i < 400; i++) {
+        cache.getStats(stats);
+        if (stats.prefetched + stats.loadErrors >= count) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+static void testReadAhead(void)
+{
+    TestLoader loader;
+    loader.runFrames = 10;
+    TestCache cache(bind(loader));
+    TestFrame frame;
+    StFrameCacheStats stats;
+
+    cache.setLimits(64 * entryBytes, 4);
+
+    /* Random access does not read ahead */
+    cache.get(key(0), frame);
+    cache.get(key(5), frame);
+    cache.get(key(2), frame);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    cache.getStats(stats);
+    testOk(stats.prefetched == 0 && loader.calls == 3, "no read-ahead for random access");
+
+    /* 2, 3, 4 in a row triggers read-ahead of 5..8 (5 is already held) */
+    cache.get(key(3), frame);
+    cache.get(key(4), frame);
+    testOk1(waitPrefetched(cache, 3));
+    uint32_t calls = loader.calls;
+    bool ok = true;
+    for (uint32_t n = 5; n < 9; n++) {
+        ok = ok && (cache.get(key(n), frame) == 0) && (frame.frameNumber == n);
+    }
+    cache.getStats(stats);
+    testOk(ok && stats.prefetchHits == 3, "sequential reads served by read-ahead");
+
+    /* Read-ahead stops at the first frame past the end of the run */
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    cache.getStats(stats);
+    uint64_t errors = stats.loadErrors;
+    testOk(errors >= 1, "read-ahead reached the end of the run");
+    testOk1(cache.get(key(9), frame) == 0 && frame.frameNumber == 9);
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    cache.getStats(stats);
+    testOk(stats.loadErrors == errors, "no read-ahead past the end once it is known");
+    testOk1(cache.get(key(10), frame) == ST_ERR_FRAME_NUMBER);
+    testDiag("loader calls %u, including %u after the sequential run", loader.calls.load(),
+             loader.calls.load() - calls);
+}
+
+static void testSharedLoad(void)
+{
+    const uint32_t readers = 6;
+    TestLoader loader;
+    loader.delayMs = 50;
+    TestCache cache(bind(loader));
+    std::atomic<uint32_t> good(0);
+    StFrameCacheStats stats;
+
+    cache.setLimits(10 * entryBytes, 0);
+    std::vector<std::thread> threads;
+    for (uint32_t r = 0; r < readers; r++) {
+        threads.push_back(std::thread([&]() {
+            TestFrame frame;
+            if ((cache.get(key(3), frame) == 0) && (frame.frameNumber == 3)) good++;
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    cache.getStats(stats);
+    testOk(good == readers, "every reader gets the frame");
+    testOk(loader.calls == 1, "one load for %u concurrent readers", readers);
+    testOk1(stats.misses == 1 && (stats.hits == readers - 1) && stats.waits >= 1);
+}
+
+MAIN(stFrameCacheTest)
+{
+    testPlan(29);
+    testHitMissEvict();
+    testInvalidate();
+    testReadAhead();
+    testSharedLoad();
+    return testDone();
+}
@@ -0,0 +1,155 @@
+/* stKeckCapStackTest.cpp
+ *
+ * Unit tests for the KeckPAD cap stack corrector (st_keck_capstack.h):
+ * a known stack decodes to (raw - bg) * gain for every cap count, the
+ * planar and interleaved outputs agree, a pixel sub-range touches only
+ * that range, the worker pool path matches the single-threaded pass,
+ * and bad cap counts, indexes and ranges are rejected.
+ *
+ */
+
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_keck_capstack.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t pixels = 41;
+
+/* A stack of caps raw images with per-cap background c+1 and gain (c+1)/2 */
+struct Stack
+{
+    std::vector<std::vector<KKRawPixel>> raw;
+    std::vector<const KKRawPixel*> ppRaw;
+
+    Stack(StKeckCapStack& stack, uint32_t caps, uint32_t count)
+        : raw(caps), ppRaw(caps)
+    {
+        stack.init(caps, count);
+        for (uint32_t c = 0; c < caps; c++) {
+            raw[c].resize(count);
+            for (uint32_t p = 0; p < count; p++) {
+                raw[c][p] = static_cast<KKRawPixel>(100 * c + (p % 1000) + 10);
+            }
+            ppRaw[c] = raw[c].data();
+            stack.setCapBackground(c, static_cast<float>(c + 1));
+            stack.setCapGain(c, 0.5f * static_cast<float>(c + 1));
+        }
+    }
+
+    /* Known corrected value: exact in float for these inputs */
+    float expect(uint32_t c, uint32_t p) const
+    {
+        return (static_cast<float>(raw[c][p]) - static_cast<float>(c + 1)) *
+               (0.5f * static_cast<float>(c + 1));
+    }
+};
+
+static void testKnownStack(void)
+{
+    bool planarOk = true;
+    bool interleavedOk = true;
+    for (uint32_t caps = 1; caps <= KK_MAX_CAPACITOR_COUNT; caps++) {
+        StKeckCapStack stack;
+        Stack in(stack, caps, pixels);
+
+        std::vector<std::vector<float>> out(caps, std::vector<float>(pixels, -1.0f));
+        std::vector<float*> ppOut(caps);
+        for (uint32_t c = 0; c < caps; c++) ppOut[c] = out[c].data();
+        std::vector<double> inter(static_cast<size_t>(caps) * pixels, -1.0);
+
+        if (stack.process(in.ppRaw.data(), ppOut.data()) != ST_ERR_OK) planarOk = false;
+        if (stack.processInterleaved(in.ppRaw.data(), inter.data()) != ST_ERR_OK) interleavedOk = false;
+        for (uint32_t c = 0; c < caps; c++) {
+            for (uint32_t p = 0; p < pixels; p++) {
+                if (out[c][p] != in.expect(c, p)) planarOk = false;
+                if (inter[p * caps + c] != static_cast<double>(in.expect(c, p))) interleavedOk = false;
+            }
+        }
+    }
+    testOk(planarOk, "planar output is (raw - bg) * gain for 1..8 caps");
+    testOk(interleavedOk, "interleaved output is (raw - bg) * gain for 1..8 caps");
+
+    /* Spot check one pixel by hand: cap 2, pixel 5 -> (215 - 3) * 1.5 */
+    StKeckCapStack stack;
+    Stack in(stack, 3, pixels);
+    std::vector<float> out0(pixels), out1(pixels), out2(pixels);
+    float* ppOut[3] = { out0.data(), out1.data(), out2.data() };
+    testOk1(stack.process(in.ppRaw.data(), ppOut) == ST_ERR_OK);
+    testOk1(out2[5] == 318.0f);
+}
+
+static void testRange(void)
+{
+    StKeckCapStack stack;
+    Stack in(stack, 2, pixels);
+    std::vector<float> out0(pixels, -1.0f), out1(pixels, -1.0f);
+    float* ppOut[2] = { out0.data(), out1.data() };
+
+    testOk1(stack.process(in.ppRaw.data(), ppOut, 10, 20) == ST_ERR_OK);
+    bool ok = true;
+    for (uint32_t p = 0; p < pixels; p++) {
+        bool inside = (p >= 10) && (p < 20);
+        if (inside && ((out0[p] != in.expect(0, p)) || (out1[p] != in.expect(1, p)))) ok = false;
+        if (!inside && ((out0[p] != -1.0f) || (out1[p] != -1.0f))) ok = false;
+    }
+    testOk(ok, "sub-range writes only [begin, end)");
+}
+
+static void testPool(void)
+{
+    const uint32_t count = 3 * ST_KECK_CAPSTACK_TILE_PIXELS + 17;
+    const uint32_t caps = 4;
+    StKeckCapStack stack;
+    Stack in(stack, caps, count);
+
+    std::vector<std::vector<float>> serial(caps, std::vector<float>(count));
+    std::vector<std::vector<float>> pooled(caps, std::vector<float>(count));
+    std::vector<float*> ppSerial(caps), ppPooled(caps);
+    for (uint32_t c = 0; c < caps; c++) {
+        ppSerial[c] = serial[c].data();
+        ppPooled[c] = pooled[c].data();
+    }
+
+    STUTIL::WorkPool pool;
+    testOk1(pool.init(4) == 0);
+    testOk1(stack.processParallel(in.ppRaw.data(), ppSerial.data(), nullptr) == ST_ERR_OK);
+    testOk1(stack.processParallel(in.ppRaw.data(), ppPooled.data(), &pool) == ST_ERR_OK);
+    testOk(serial == pooled, "pooled pass matches the single-threaded pass");
+    testOk1(pooled[3][count - 1] == in.expect(3, count - 1));
+}
+
+static void testErrors(void)
+{
+    StKeckCapStack stack;
+    testOk1(stack.init(0, pixels) == ST_ERR_CAP_COUNT);
+    testOk1(stack.init(KK_MAX_CAPACITOR_COUNT + 1, pixels) == ST_ERR_CAP_COUNT);
+    testOk1(stack.init(2, 0) == ST_ERR_DIMENSION);
+
+    Stack in(stack, 2, pixels);
+    std::vector<float> out0(pixels), out1(pixels);
+    float* ppOut[2] = { out0.data(), out1.data() };
+    testOk1(stack.setCapBackground(2, 1.0f) == ST_ERR_INDEX);
+    testOk1(stack.setCapGain(2, 1.0f) == ST_ERR_INDEX);
+    testOk1(stack.process(in.ppRaw.data(), ppOut, 0, pixels + 1) == ST_ERR_INDEX);
+    testOk1(stack.process(in.ppRaw.data(), ppOut, 20, 10) == ST_ERR_INDEX);
+    testOk1(stack.process(static_cast<const KKRawPixel* const*>(nullptr), ppOut) == ST_ERR_NULL_PTR);
+
+    /* An uninitialized corrector has no caps */
+    StKeckCapStack empty;
+    STUTIL::WorkPool pool;
+    testOk1(empty.processParallel(in.ppRaw.data(), ppOut, &pool) == ST_ERR_CAP_COUNT);
+}
+
+MAIN(stKeckCapStackTest)
+{
+    testPlan(20);
+    testKnownStack();
+    testRange();
+    testPool();
+    testErrors();
+    return testDone();
+}
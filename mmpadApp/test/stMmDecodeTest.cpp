@@ -0,0 +1,151 @@
+/* stMmDecodeTest.cpp
+ *
+ * Unit tests for the MM-PAD digital/analog decode (st_mm_decode.h): a
+ * frame mixing analog-only pixels with digital overflow counts decodes
+ * to a hand-computed reference in float and double, tables loaded from
+ * a mapped calibration file give the same frame, a pixel sub-range
+ * touches only that range, and bad tables and files are rejected.
+ *
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_mm_decode.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t width = 4;
+static const uint32_t height = 3;
+static const uint32_t pixels = width * height;
+static const uint32_t bits = ST_MM_DECODE_ANALOG_BITS;
+
+/* Per-pixel tables and a raw frame in mixed mode: even pixels carry only
+ * an analog residual, odd pixels also carry digital overflow counts */
+struct Calib
+{
+    std::vector<float> pedestal;
+    std::vector<float> gain;
+    std::vector<float> scale;
+    std::vector<MXRawPixel> raw;
+    std::vector<double> reference;
+
+    Calib() : pedestal(pixels), gain(pixels), scale(pixels), raw(pixels), reference(pixels)
+    {
+        for (uint32_t i = 0; i < pixels; i++) {
+            pedestal[i] = 100.0f + 2.0f * i;
+            gain[i] = 0.5f + 0.125f * i;
+            scale[i] = 12000.0f + 16.0f * i;
+            uint32_t analog = 1000u + 997u * i;
+            uint32_t digital = (i & 1) ? (i * 3 + 1) : 0;
+            raw[i] = static_cast<MXRawPixel>((digital << bits) | analog);
+            /* Reference decode, written out independently of the kernel */
+            reference[i] = (static_cast<double>(analog) - pedestal[i]) * gain[i] +
+                           static_cast<double>(digital) * scale[i];
+        }
+    }
+};
+
+static bool matches(const std::vector<double>& reference, const std::vector<float>& out, double tol)
+{
+    for (size_t i = 0; i < reference.size(); i++) {
+        if (fabs(static_cast<double>(out[i]) - reference[i]) > tol * fabs(reference[i])) return false;
+    }
+    return true;
+}
+
+static void testMixedDecode(void)
+{
+    Calib cal;
+    StMmDecode decode;
+    testOk1(!decode.isValid());
+    testOk1(decode.setTables(width, height, bits, cal.pedestal, cal.gain, cal.scale) == ST_ERR_OK);
+    testOk1(decode.isValid() && !decode.isMapped() && decode.getAnalogBits() == bits);
+
+    std::vector<double> outD(pixels, -1.0);
+    decode.decodePixels(cal.raw.data(), outD.data(), 0, pixels);
+    testOk(outD == cal.reference, "double decode matches the reference frame");
+
+    std::vector<float> outF(pixels, -1.0f);
+    decode.decodePixels(cal.raw.data(), outF.data(), 0, pixels);
+    testOk(matches(cal.reference, outF, 1.0e-6), "float decode within float rounding of the reference");
+
+    /* Pixel 0: analog 1000 only -> (1000 - 100) * 0.5 */
+    testOk1(outD[0] == 450.0);
+    /* Pixel 1: 4 overflow counts plus analog 1997 -> (1997 - 102) * 0.625 + 4 * 12016 */
+    testOk1(outD[1] == 1184.375 + 48064.0);
+
+    /* Sub-range only writes [begin, end) */
+    std::vector<double> part(pixels, -1.0);
+    decode.decodePixels(cal.raw.data(), part.data(), 3, 7);
+    bool ok = true;
+    for (uint32_t i = 0; i < pixels; i++) {
+        bool inside = (i >= 3) && (i < 7);
+        if (inside ? (part[i] != cal.reference[i]) : (part[i] != -1.0)) ok = false;
+    }
+    testOk(ok, "sub-range decode");
+}
+
+static void testCalibrationFile(void)
+{
+    Calib cal;
+    std::string path = std::string("/tmp/stMmDecodeTest_") + std::to_string(getpid()) + ".cal";
+    testOk1(StMmDecode::writeFile(path, width, height, bits, cal.pedestal, cal.gain, cal.scale) ==
+            ST_ERR_OK);
+
+    StMmDecode decode;
+    testOk1(decode.load(path) == ST_ERR_OK);
+    testOk1(decode.isMapped() && decode.getWidth() == width && decode.getHeight() == height);
+
+    std::vector<double> out(pixels, -1.0);
+    decode.decodePixels(cal.raw.data(), out.data(), 0, pixels);
+    testOk(out == cal.reference, "mapped tables decode the reference frame");
+
+    decode.clear();
+    testOk1(!decode.isValid() && !decode.isMapped());
+
+    /* Truncated file: the header promises more table data than present */
+    testOk1(truncate(path.c_str(), sizeof(StMmDecodeFileHeader) + 4 * sizeof(float)) == 0);
+    testOk1(decode.load(path) == ST_ERR_LENGTH && !decode.isValid());
+
+    /* Bad magic */
+    std::vector<float> one(1, 1.0f);
+    StMmDecode::writeFile(path, 1, 1, bits, one, one, one);
+    FILE *fp = fopen(path.c_str(), "r+b");
+    if (fp) {
+        uint32_t bad = 0;
+        fwrite(&bad, sizeof(bad), 1, fp);
+        fclose(fp);
+    }
+    testOk1(decode.load(path) == ST_ERR_DATA);
+
+    unlink(path.c_str());
+    testOk1(decode.load(path) != ST_ERR_OK);
+}
+
+static void testBadTables(void)
+{
+    Calib cal;
+    StMmDecode decode;
+    std::vector<float> shortTable(pixels - 1);
+    testOk1(decode.setTables(width, height, bits, cal.pedestal, shortTable, cal.scale) == ST_ERR_LENGTH);
+    testOk1(decode.setTables(0, height, bits, cal.pedestal, cal.gain, cal.scale) == ST_ERR_DIMENSION);
+    testOk1(decode.setTables(width, height, 0, cal.pedestal, cal.gain, cal.scale) == ST_ERR_DIMENSION);
+    testOk1(decode.setTables(width, height, 32, cal.pedestal, cal.gain, cal.scale) == ST_ERR_DIMENSION);
+    testOk1(!decode.isValid());
+}
+
+MAIN(stMmDecodeTest)
+{
+    testPlan(22);
+    testMixedDecode();
+    testCalibrationFile();
+    testBadTables();
+    return testDone();
+}
@@ -0,0 +1,100 @@
+/* stPixelKernelsTest.cpp
+ *
+ * Unit tests for the compile-time pixel type dispatch (st_pixel_kernels.h):
+ * each runtime STDataType reaches the matching typed kernel, unknown
+ * types are rejected, and the scale, accumulate, subtract and convert
+ * operations match a plain per-pixel loop for mixed operand types.
+ *
+ */
+
+#include <math.h>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_pixel_kernels.h"
+
+using namespace ST_INTERFACE;
+
+static const size_t count = 37;
+
+/* Records the size of the type it was run with */
+struct SizeOp
+{
+    size_t size;
+    template<typename T> int32_t run() { size = sizeof(T); return ST_ERR_OK; }
+};
+
+static void testDispatch(void)
+{
+    SizeOp op = { 0 };
+
+    testOk1(dispatchPixelType(DT_UINT16, op) == ST_ERR_OK && op.size == 2);
+    testOk1(dispatchPixelType(DT_INT64, op) == ST_ERR_OK && op.size == 8);
+    testOk1(dispatchPixelType(DT_FLOAT, op) == ST_ERR_OK && op.size == 4);
+    testOk1(dispatchPixelType(DT_INT8, op) == ST_ERR_OK && op.size == 1);
+    testOk(dispatchPixelType(static_cast<STDataType>(-1), op) == ST_ERR_DATA_TYPE,
+           "unknown pixel type rejected");
+
+    std::vector<int32_t> src(count, 1);
+    std::vector<double> dest(count);
+    testOk1(convertPixels(src.data(), static_cast<STDataType>(-1), dest.data(), DT_DOUBLE, count) ==
+            ST_ERR_DATA_TYPE);
+    testOk1(convertPixels(src.data(), DT_INT32, nullptr, DT_DOUBLE, count) == ST_ERR_NULL_PTR);
+}
+
+static void testKernels(void)
+{
+    std::vector<uint16_t> u16(count);
+    std::vector<int32_t> i32(count);
+    std::vector<float> f32(count);
+    std::vector<double> f64(count);
+    for (size_t i = 0; i < count; i++) {
+        u16[i] = static_cast<uint16_t>(i * 100);
+        i32[i] = static_cast<int32_t>(i * 3) - 50;
+        f32[i] = static_cast<float>(i) * 0.5f;
+    }
+
+    /* Convert uint16 to double */
+    testOk1(convertPixels(u16.data(), DT_UINT16, f64.data(), DT_DOUBLE, count) == ST_ERR_OK);
+    bool match = true;
+    for (size_t i = 0; i < count; i++) {
+        if (f64[i] != static_cast<double>(u16[i])) match = false;
+    }
+    testOk(match, "uint16 to double conversion");
+
+    /* Accumulate uint16 into int32 */
+    std::vector<int32_t> acc(i32);
+    StAccumulateOp accOp = { u16.data(), acc.data(), count };
+    testOk1(dispatchPixelTypes(DT_UINT16, DT_INT32, accOp) == ST_ERR_OK);
+    match = true;
+    for (size_t i = 0; i < count; i++) {
+        if (acc[i] != i32[i] + static_cast<int32_t>(u16[i])) match = false;
+    }
+    testOk(match, "uint16 accumulated into int32");
+
+    /* Subtract a float background from double pixels, in place */
+    std::vector<double> expect(f64);
+    for (size_t i = 0; i < count; i++) expect[i] -= static_cast<double>(f32[i]);
+    StSubtractOp subOp = { f64.data(), f32.data(), f64.data(), count };
+    testOk1(dispatchPixelTypes(DT_DOUBLE, DT_FLOAT, subOp) == ST_ERR_OK);
+    match = true;
+    for (size_t i = 0; i < count; i++) {
+        if (fabs(f64[i] - expect[i]) > 1e-12) match = false;
+    }
+    testOk(match, "float background subtracted in place");
+
+    /* Scale float pixels */
+    StScaleOp scaleOp = { f32.data(), count, 4.0 };
+    testOk1(dispatchPixelType(DT_FLOAT, scaleOp) == ST_ERR_OK);
+    testOk1(f32[3] == 6.0f && f32[count - 1] == static_cast<float>(count - 1) * 2.0f);
+}
+
+MAIN(stPixelKernelsTest)
+{
+    testPlan(15);
+    testDispatch();
+    testKernels();
+    return testDone();
+}
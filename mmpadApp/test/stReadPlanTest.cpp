@@ -0,0 +1,239 @@
+/* stReadPlanTest.cpp
+ *
+ * Unit tests for the coalesced register read planner (st_read_plan.h):
+ * shared and neighbouring registers are merged into bursts, only memory
+ * mapped registers are coalesced, burst words come back as the fields
+ * of each parameter, handlers without the burst capability (or that
+ * decline it) read every parameter on their own with the same result,
+ * and bad requests and burst errors are reported.
+ *
+ */
+
+#include <map>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_read_plan.h"
+
+using namespace ST_INTERFACE;
+
+/* The register layout accessors of StParameter used by the planner */
+struct TestParam
+{
+    STDataDomain domain;
+    STDataSubDomain subDomain;
+    uint32_t address;
+    uint32_t nBytes;
+    uint32_t stride;
+    uint32_t startBit;
+    uint32_t nBits;
+    uint32_t dimension;
+
+    STDataDomain getDomain(void) { return domain; }
+    STDataSubDomain getSubDomain(void) { return subDomain; }
+    uint32_t getAddress(void) { return address; }
+    uint32_t getNBytes(void) { return nBytes; }
+    uint32_t getArrayStride(void) { return stride; }
+    uint32_t getStartBit(void) { return startBit; }
+    uint32_t getNBits(void) { return nBits; }
+    uint32_t getDimension(void) { return dimension; }
+};
+
+typedef StReadPlanT<TestParam> TestPlan;
+typedef TestPlan::Request TestRequest;
+
+static TestParam param(STDataDomain domain, uint32_t address, uint32_t startBit = 0, uint32_t nBits = 32,
+                       uint32_t dimension = 1, STDataSubDomain subDomain = DS_NONE)
+{
+    TestParam p = { domain, subDomain, address, 4, 4, startBit, nBits, dimension };
+    return p;
+}
+
+/* Register file read one parameter at a time, as readRawValueArray() does */
+class RegisterHandler
+{
+public:
+    std::map<uint64_t, uint32_t> regs;
+    uint32_t valueCalls;
+
+    RegisterHandler() : valueCalls(0) {}
+    virtual ~RegisterHandler() {}
+
+    uint32_t reg(STDataDomain domain, uint32_t address)
+    {
+        return regs[(static_cast<uint64_t>(domain) << 32) | address];
+    }
+
+    int32_t readRawValueArray(TestParam& p, std::vector<uint32_t>& values, uint32_t index,
+                              uint32_t count, uint32_t padIndex = 0)
+    {
+        (void)padIndex;
+        valueCalls++;
+        StReadField field = TestPlan::makeField(p);
+        values.resize(count);
+        for (uint32_t e = 0; e < count; e++) {
+            values[e] = field.extract(reg(p.domain, p.address + (index + e) * p.stride));
+        }
+        return ST_ERR_OK;
+    }
+};
+
+/* Register file that can also read ranges */
+class BurstHandler : public RegisterHandler, public StRawBurstReader
+{
+public:
+    uint32_t burstCalls;
+    int32_t burstRtn;
+    uint32_t shortBy;
+
+    BurstHandler() : burstCalls(0), burstRtn(ST_ERR_OK), shortBy(0) {}
+
+    int32_t readRawBurst(STDataDomain domain, uint32_t address, uint32_t count,
+                         std::vector<uint32_t>& rawValues, uint32_t padIndex = 0)
+    {
+        (void)padIndex;
+        burstCalls++;
+        if (ST_ERR_OK != burstRtn) return burstRtn;
+        rawValues.resize(count - shortBy);
+        for (uint32_t i = 0; i < rawValues.size(); i++) {
+            rawValues[i] = reg(domain, address + 4 * i);
+        }
+        return ST_ERR_OK;
+    }
+};
+
+/* Fill every handler register with a distinct pattern */
+static void fill(RegisterHandler& handler)
+{
+    for (uint32_t a = 0x100; a < 0x120; a += 4) {
+        handler.regs[(static_cast<uint64_t>(DD_BACK_CHANNEL) << 32) | a] = 0xA5000000u | (a << 8) | (a & 0xFF);
+        handler.regs[(static_cast<uint64_t>(DD_HOST_FPGA) << 32) | a] = 0x5A000000u | a;
+    }
+    handler.regs[(static_cast<uint64_t>(DD_BACK_CHANNEL) << 32) | 0x1000] = 0x12345678u;
+}
+
+/* Parameters: two fields of one register, an array slice next to it, the
+ * same address in another domain, an SPI register and a distant register */
+struct Set
+{
+    TestParam low, high, array, host, spi, far;
+    std::vector<TestRequest> requests;
+
+    Set()
+        : low(param(DD_BACK_CHANNEL, 0x100, 0, 8)),
+          high(param(DD_BACK_CHANNEL, 0x100, 8, 16)),
+          array(param(DD_BACK_CHANNEL, 0x108, 0, 32, 4)),
+          host(param(DD_HOST_FPGA, 0x100)),
+          spi(param(DD_BACK_CHANNEL, 0x104, 0, 32, 1, DS_ACP_SPI)),
+          far(param(DD_BACK_CHANNEL, 0x1000, 4, 12))
+    {
+        TestRequest r[6] = { { &low, 0, 1 }, { &high, 0, 1 }, { &array, 1, 2 },
+                             { &host, 0, 1 }, { &spi, 0, 1 }, { &far, 0, 1 } };
+        requests.assign(r, r + 6);
+    }
+};
+
+static void testPlanLayout(void)
+{
+    Set set;
+    TestPlan plan;
+    testOk1(plan.build(set.requests) == ST_ERR_OK);
+    testOk(plan.getBurstCount() == 3, "3 bursts: 0x100-0x110, 0x1000 and the host register");
+    testOk1(plan.isCoalesced(0) && plan.isCoalesced(2) && plan.isCoalesced(3));
+    testOk(!plan.isCoalesced(4), "SPI register not coalesced");
+    testOk1(plan.getField(1).shift == 8 && plan.getField(1).mask == 0xFFFF);
+
+    /* Without any gap the array slice starts a burst of its own */
+    testOk1(plan.build(set.requests, 0) == ST_ERR_OK && plan.getBurstCount() == 4);
+    /* One word bursts split the array slice; the shared register stays one read */
+    testOk1(plan.build(set.requests, ST_READ_PLAN_DEF_GAP_WORDS, 1) == ST_ERR_OK && plan.getBurstCount() == 5);
+}
+
+static void testCoalesced(void)
+{
+    Set set;
+    TestPlan plan;
+    plan.build(set.requests);
+
+    RegisterHandler reference;
+    fill(reference);
+    std::vector<std::vector<uint32_t>> expect;
+    testOk1(plan.execute(reference, expect) == ST_ERR_OK);
+
+    BurstHandler handler;
+    fill(handler);
+    std::vector<std::vector<uint32_t>> values;
+    testOk1(plan.execute(handler, values) == ST_ERR_OK);
+    testOk(handler.burstCalls == 3 && handler.valueCalls == 1,
+           "one call per burst plus the SPI register (%u bursts, %u reads)",
+           handler.burstCalls, handler.valueCalls);
+    testOk(values == expect, "burst values match per-parameter reads");
+
+    /* Fields are extracted from the shared register */
+    testOk1(values[0].size() == 1 && values[0][0] == 0x00);
+    testOk1(values[1].size() == 1 && values[1][0] == 0x0100);
+    testOk1(values[2].size() == 2 && values[2][0] == 0xA5010C0Cu && values[2][1] == 0xA5011010u);
+    testOk1(values[5][0] == 0x567);
+}
+
+static void testFallback(void)
+{
+    Set set;
+    TestPlan plan;
+    plan.build(set.requests);
+
+    /* Handler without the burst capability */
+    RegisterHandler plain;
+    fill(plain);
+    std::vector<std::vector<uint32_t>> expect;
+    testOk1(plan.execute(plain, expect) == ST_ERR_OK);
+    testOk(plain.valueCalls == 6, "every request read on its own");
+
+    /* Handler that declines bursts */
+    BurstHandler declining;
+    fill(declining);
+    declining.burstRtn = ST_ERR_NOT_IMPL;
+    std::vector<std::vector<uint32_t>> values;
+    testOk1(plan.execute(declining, values) == ST_ERR_OK);
+    testOk(declining.burstCalls == 1 && declining.valueCalls == 6, "declined burst falls back");
+    testOk1(values == expect);
+
+    /* Burst errors are returned */
+    BurstHandler failing;
+    failing.burstRtn = ST_ERR_TIMEOUT;
+    testOk1(plan.execute(failing, values) == ST_ERR_TIMEOUT);
+    BurstHandler shortRead;
+    shortRead.shortBy = 1;
+    testOk1(plan.execute(shortRead, values) == ST_ERR_LENGTH);
+}
+
+static void testBadRequests(void)
+{
+    TestParam array = param(DD_BACK_CHANNEL, 0x108, 0, 32, 4);
+    TestPlan plan;
+    std::vector<TestRequest> requests(1);
+
+    requests[0].pParam = nullptr; requests[0].index = 0; requests[0].count = 1;
+    testOk1(plan.build(requests) == ST_ERR_PARAM);
+    requests[0].pParam = &array; requests[0].count = 0;
+    testOk1(plan.build(requests) == ST_ERR_PARAM);
+    requests[0].index = 3; requests[0].count = 2;
+    testOk1(plan.build(requests) == ST_ERR_PARAM);
+    /* index + count wraps to 1 in 32 bits */
+    requests[0].index = 0xFFFFFFFFu; requests[0].count = 2;
+    testOk(plan.build(requests) == ST_ERR_PARAM && plan.getBurstCount() == 0, "wrapping range rejected");
+    requests[0].index = 3; requests[0].count = 1;
+    testOk1(plan.build(requests) == ST_ERR_OK && plan.getBurstCount() == 1);
+}
+
+MAIN(stReadPlanTest)
+{
+    testPlan(27);
+    testPlanLayout();
+    testCoalesced();
+    testFallback();
+    testBadRequests();
+    return testDone();
+}
@@ -0,0 +1,165 @@
+/* stRemapTableTest.cpp
+ *
+ * Unit tests for the sparse CSR remap table (st_remap_table.h): build
+ * from unordered terms, gather against a dense reference, row ranges,
+ * the per-pixel post step, tile layouts with gaps, and rejection of
+ * out of range terms, tiles and image sizes.
+ *
+ */
+
+#include <math.h>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_remap_table.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t srcWidth = 6;
+static const uint32_t srcHeight = 4;
+static const uint32_t outWidth = 5;
+static const uint32_t outHeight = 7;
+
+/* Terms in reverse output order; output pixel 3 has none */
+static std::vector<StRemapTerm> makeTerms(void)
+{
+    std::vector<StRemapTerm> terms;
+    uint32_t srcPixels = srcWidth * srcHeight;
+    for (uint32_t n = outWidth * outHeight; n-- > 0;) {
+        if (n == 3) continue;
+        StRemapTerm t1 = { n, (n * 5) % srcPixels, 0.5f };
+        StRemapTerm t2 = { n, (n + 7) % srcPixels, 0.25f + 0.01f * static_cast<float>(n % 4) };
+        terms.push_back(t1);
+        if (n % 3) terms.push_back(t2);
+    }
+    return terms;
+}
+
+/* Dense reference: out[o] = sum of weight * src over the terms of o */
+static std::vector<double> reference(const std::vector<StRemapTerm>& terms, const std::vector<int32_t>& src)
+{
+    std::vector<double> out(outWidth * outHeight, 0.0);
+    for (size_t k = 0; k < terms.size(); k++) {
+        out[terms[k].outIndex] += static_cast<double>(terms[k].weight) * src[terms[k].srcIndex];
+    }
+    return out;
+}
+
+/* Post step that adds the output index */
+struct AddIndex
+{
+    double operator()(size_t o, double value) const { return value + static_cast<double>(o); }
+};
+
+static void testBuildGather(void)
+{
+    StRemapTable table;
+    std::vector<StRemapTerm> terms = makeTerms();
+    std::vector<int32_t> src(srcWidth * srcHeight);
+    for (size_t i = 0; i < src.size(); i++) src[i] = static_cast<int32_t>(i * 11) - 40;
+
+    testOk1(!table.isValid());
+    uint32_t generation = table.getGeneration();
+    testOk1(table.build(srcWidth, srcHeight, outWidth, outHeight, terms) == 0);
+    testOk1(table.isValid() && table.getGeneration() == generation + 1);
+    testOk1(table.getTermCount() == terms.size() && table.getOutWidth() == outWidth &&
+            table.getOutHeight() == outHeight && table.getSrcWidth() == srcWidth);
+
+    std::vector<double> expect = reference(terms, src);
+    std::vector<double> out(outWidth * outHeight, -1.0);
+    table.applyRows(src.data(), out.data(), 0, outHeight);
+    bool match = true;
+    for (size_t o = 0; o < out.size(); o++) {
+        if (fabs(out[o] - expect[o]) > 1e-12) match = false;
+    }
+    testOk(match, "gather matches the dense reference");
+    testOk(out[3] == 0.0, "output pixel without terms is 0");
+
+    /* Row ranges write only their own rows */
+    std::vector<double> part(outWidth * outHeight, -1.0);
+    table.applyRows(src.data(), part.data(), 2, 5);
+    bool inside = true;
+    bool outside = true;
+    for (uint32_t o = 0; o < outWidth * outHeight; o++) {
+        uint32_t row = o / outWidth;
+        if ((row >= 2) && (row < 5)) {
+            if (part[o] != out[o]) inside = false;
+        } else if (part[o] != -1.0) {
+            outside = false;
+        }
+    }
+    testOk(inside && outside, "row range gather touches only rows 2..4");
+
+    /* Float output and a post step */
+    std::vector<float> outF(outWidth * outHeight);
+    table.applyRows(src.data(), outF.data(), 0, outHeight);
+    bool floatMatch = true;
+    for (size_t o = 0; o < outF.size(); o++) {
+        if (fabs(outF[o] - expect[o]) > 1e-4 * (1.0 + fabs(expect[o]))) floatMatch = false;
+    }
+    testOk(floatMatch, "float output matches");
+
+    std::vector<double> post(outWidth * outHeight);
+    table.gatherRows(src.data(), post.data(), 0, outHeight, AddIndex());
+    testOk(post[10] == out[10] + 10.0 && post[3] == 3.0, "post step sees the output index");
+
+    table.clear();
+    testOk1(!table.isValid() && table.getGeneration() == generation + 2);
+}
+
+static void testErrors(void)
+{
+    StRemapTable table;
+    std::vector<StRemapTerm> terms = makeTerms();
+
+    testOk1(table.build(0, srcHeight, outWidth, outHeight, terms) == ST_ERR_DIMENSION);
+    testOk(table.build(65536, 65537, outWidth, outHeight, terms) == ST_ERR_DIMENSION,
+           "source pixel count above 32 bits rejected");
+    testOk1(table.build(srcWidth, srcHeight, 65536, 65536, terms) == ST_ERR_DIMENSION);
+    StRemapTerm badOut = { outWidth * outHeight, 0, 1.0f };
+    StRemapTerm badSrc = { 0, srcWidth * srcHeight, 1.0f };
+    terms.push_back(badOut);
+    testOk1(table.build(srcWidth, srcHeight, outWidth, outHeight, terms) == ST_ERR_INDEX);
+    terms.back() = badSrc;
+    testOk1(table.build(srcWidth, srcHeight, outWidth, outHeight, terms) == ST_ERR_INDEX);
+    testOk(!table.isValid(), "a failed build leaves the table empty");
+}
+
+static void testTiles(void)
+{
+    /* Two 2x3 source tiles placed with a one pixel gap between them */
+    StRemapTable table;
+    std::vector<StRemapTile> tiles;
+    StRemapTile left = { 0, 0, 2, 3, 0, 1 };
+    StRemapTile right = { 2, 0, 2, 3, 3, 1 };
+    tiles.push_back(left);
+    tiles.push_back(right);
+    testOk1(table.buildFromTiles(4, 3, 5, 5, tiles) == 0 && table.getTermCount() == 12);
+
+    std::vector<uint16_t> src(4 * 3);
+    for (size_t i = 0; i < src.size(); i++) src[i] = static_cast<uint16_t>(100 + i);
+    std::vector<double> out(5 * 5, -1.0);
+    table.applyRows(src.data(), out.data(), 0, 5);
+    testOk(out[1 * 5 + 0] == 100.0 && out[1 * 5 + 1] == 101.0 && out[3 * 5 + 4] == 111.0,
+           "tile pixels copied to their output positions");
+    testOk(out[1 * 5 + 2] == 0.0 && out[0] == 0.0 && out[4 * 5 + 4] == 0.0, "gaps are 0");
+
+    StRemapTile outside = { 3, 0, 2, 3, 0, 0 };
+    tiles.push_back(outside);
+    testOk1(table.buildFromTiles(4, 3, 5, 5, tiles) == ST_ERR_INDEX);
+    testOk1(table.buildFromTiles(4, 3, 0x10000, 0x10000, tiles) == ST_ERR_DIMENSION);
+    tiles.back().srcX = 0;
+    tiles.back().outY = 3;
+    testOk1(table.buildFromTiles(4, 3, 5, 5, tiles) == ST_ERR_INDEX);
+}
+
+MAIN(stRemapTableTest)
+{
+    testPlan(22);
+    testBuildGather();
+    testErrors();
+    testTiles();
+    return testDone();
+}
@@ -0,0 +1,289 @@
+/* stRunContainerTest.cpp
+ *
+ * Unit tests for the run container reader (st_run_container.h): chunk
+ * codec round trips, corrupt payloads, and reading frame records,
+ * metadata, telemetry and configuration from a hand-built container,
+ * including rejection of truncated and damaged files.
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_run_container.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t frameCount = 5;
+static const uint32_t framesPerChunk = 2;
+static const uint32_t recordBytes = 4096;
+static const uint32_t telemBytes = 16;
+static const char config[] = "{\"run\":\"test\"}";
+
+/* Detector-like record: small counts, mostly zero high bytes */
+static std::vector<uint8_t> makeRecord(uint32_t frame)
+{
+    std::vector<uint8_t> record(recordBytes);
+    uint32_t *pWords = reinterpret_cast<uint32_t *>(record.data());
+    for (uint32_t i = 0; i < recordBytes / 4; i++) {
+        pWords[i] = ((i * 7 + frame) % 13 == 0) ? (frame * 100 + i % 50) : 0;
+    }
+    return record;
+}
+
+static void append(std::vector<uint8_t>& file, const void *pData, size_t bytes)
+{
+    const uint8_t *p = static_cast<const uint8_t *>(pData);
+    file.insert(file.end(), p, p + bytes);
+}
+
+/* Build a container in memory the way StRunWriter lays it out */
+static std::vector<uint8_t> buildContainer(uint16_t codec)
+{
+    std::vector<uint8_t> file;
+    StRunFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.id = ST_RUN_FILE_ID;
+    header.version = ST_RUN_FILE_VERSION;
+    header.headerBytes = sizeof(header);
+    header.codec = codec;
+    header.framesPerChunk = framesPerChunk;
+    append(file, &header, sizeof(header));
+
+    std::vector<StRunChunkEntry> chunks;
+    std::vector<StRunFrameEntry> frames;
+    std::vector<uint8_t> telemetry;
+    for (uint32_t first = 0; first < frameCount; first += framesPerChunk) {
+        std::vector<uint8_t> raw;
+        for (uint32_t n = first; (n < frameCount) && (n < first + framesPerChunk); n++) {
+            StRunFrameEntry entry;
+            memset(&entry, 0, sizeof(entry));
+            entry.chunk = static_cast<uint32_t>(chunks.size());
+            entry.frameBytes = recordBytes;
+            entry.rawOffset = raw.size();
+            entry.telemetryOffset = telemetry.size();
+            entry.telemetryBytes = (n % 2) ? telemBytes : 0;
+            telemetry.insert(telemetry.end(), entry.telemetryBytes, static_cast<uint8_t>(0xA0 + n));
+            frames.push_back(entry);
+            std::vector<uint8_t> record = makeRecord(n);
+            append(raw, record.data(), record.size());
+        }
+        std::vector<uint8_t> stored;
+        runChunkEncode(codec, raw.data(), raw.size(), stored);
+
+        file.resize((file.size() + ST_RUN_CHUNK_ALIGN - 1) / ST_RUN_CHUNK_ALIGN * ST_RUN_CHUNK_ALIGN, 0);
+        StRunChunkEntry chunk;
+        memset(&chunk, 0, sizeof(chunk));
+        chunk.offset = file.size();
+        chunk.storedBytes = stored.size();
+        chunk.rawBytes = raw.size();
+        chunk.firstFrame = first;
+        chunk.codec = codec;
+        chunks.push_back(chunk);
+
+        StRunChunkHeader chunkHeader;
+        memset(&chunkHeader, 0, sizeof(chunkHeader));
+        chunkHeader.id = ST_RUN_CHUNK_ID;
+        chunkHeader.codec = codec;
+        chunkHeader.firstFrame = first;
+        chunkHeader.frameCount = static_cast<uint32_t>(frames.size()) - first;
+        chunkHeader.rawBytes = raw.size();
+        chunkHeader.storedBytes = stored.size();
+        append(file, &chunkHeader, sizeof(chunkHeader));
+        append(file, stored.data(), stored.size());
+    }
+
+    StRunFooter footer;
+    memset(&footer, 0, sizeof(footer));
+    footer.id = ST_RUN_FOOTER_ID;
+    footer.version = ST_RUN_FILE_VERSION;
+    footer.footerBytes = sizeof(footer);
+    footer.frameCount = frameCount;
+    footer.chunkCount = static_cast<uint32_t>(chunks.size());
+    footer.configOffset = file.size();
+    footer.configBytes = sizeof(config) - 1;
+    append(file, config, sizeof(config) - 1);
+    footer.metadataOffset = file.size();
+    for (uint32_t n = 0; n < frameCount; n++) {
+        STFrameMetadata meta;
+        memset(&meta, static_cast<int>(n + 1), sizeof(meta));
+        append(file, &meta, sizeof(meta));
+    }
+    footer.telemetryOffset = file.size();
+    footer.telemetryBytes = telemetry.size();
+    append(file, telemetry.data(), telemetry.size());
+    footer.chunkIndexOffset = file.size();
+    append(file, chunks.data(), chunks.size() * sizeof(StRunChunkEntry));
+    footer.frameIndexOffset = file.size();
+    append(file, frames.data(), frames.size() * sizeof(StRunFrameEntry));
+    append(file, &footer, sizeof(footer));
+    return file;
+}
+
+static std::string writeFile(const char *tag, const std::vector<uint8_t>& data)
+{
+    std::string path = std::string("/tmp/stRunContainerTest_") + tag + "_" +
+                       std::to_string(getpid()) + ST_RUN_FILE_EXT;
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(data.data()), data.size());
+    return path;
+}
+
+static void testCodec(void)
+{
+    std::vector<uint8_t> raw = makeRecord(3);
+    raw.push_back(0x11);                /* trailing bytes after the words */
+    raw.push_back(0x22);
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> back(raw.size());
+
+    testOk1(runChunkEncode(ST_RUN_CODEC_SHUFFLE_RLE, raw.data(), raw.size(), stored) == 0);
+    testOk(stored.size() < raw.size() / 4, "sparse record compresses (%u -> %u bytes)",
+           static_cast<unsigned>(raw.size()), static_cast<unsigned>(stored.size()));
+    testOk1(runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, stored.data(), stored.size(),
+                           back.data(), back.size()) == 0 && back == raw);
+
+    /* Incompressible data round trips through literal runs */
+    std::vector<uint8_t> noise(1001);
+    for (size_t i = 0; i < noise.size(); i++) noise[i] = static_cast<uint8_t>(i * 131 + (i >> 3));
+    std::vector<uint8_t> noiseBack(noise.size());
+    testOk1(runChunkEncode(ST_RUN_CODEC_SHUFFLE_RLE, noise.data(), noise.size(), stored) == 0 &&
+            runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, stored.data(), stored.size(),
+                           noiseBack.data(), noiseBack.size()) == 0 && noiseBack == noise);
+
+    testOk1(runChunkEncode(ST_RUN_CODEC_NONE, raw.data(), raw.size(), stored) == 0 && stored == raw);
+    testOk1(runChunkEncode(7, raw.data(), raw.size(), stored) == ST_ERR_PARAM);
+
+    /* Corrupt payloads are rejected, never decoded past either buffer */
+    runChunkEncode(ST_RUN_CODEC_SHUFFLE_RLE, raw.data(), raw.size(), stored);
+    testOk(runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, stored.data(), stored.size() - 1,
+                          back.data(), back.size()) == ST_ERR_FILE_FORMAT, "truncated payload");
+    testOk(runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, stored.data(), stored.size(),
+                          back.data(), back.size() - 1) == ST_ERR_FILE_FORMAT, "payload longer than the chunk");
+    uint8_t literalPastEnd[2] = { 10, 0 };
+    testOk1(runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, literalPastEnd, sizeof(literalPastEnd),
+                           back.data(), back.size()) == ST_ERR_FILE_FORMAT);
+    uint8_t repeatNoByte[1] = { 200 };
+    testOk1(runChunkDecode(ST_RUN_CODEC_SHUFFLE_RLE, repeatNoByte, sizeof(repeatNoByte),
+                           back.data(), back.size()) == ST_ERR_FILE_FORMAT);
+    testOk1(runChunkDecode(ST_RUN_CODEC_NONE, raw.data(), raw.size() - 1,
+                           back.data(), back.size()) == ST_ERR_FILE_FORMAT);
+}
+
+static void testRead(uint16_t codec)
+{
+    std::string path = writeFile("read", buildContainer(codec));
+    StRunReader reader;
+    const uint8_t *pData = nullptr;
+    uint32_t bytes = 0;
+
+    testOk(reader.open(path) == 0 && reader.isOpen(), "open (codec %u)", codec);
+    testOk1(reader.getFrameCount() == frameCount && reader.getChunkCount() == 3);
+
+    std::string text;
+    testOk1(reader.getConfig(text) == 0 && text == config);
+
+    /* Read out of order so chunks are decoded more than once */
+    static const uint32_t order[] = { 4, 0, 3, 1, 2, 0 };
+    bool recordsOk = true;
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        std::vector<uint8_t> expect = makeRecord(order[i]);
+        if ((reader.getFrameData(order[i], pData, bytes) != 0) || (bytes != recordBytes) ||
+            (memcmp(pData, expect.data(), bytes) != 0)) {
+            recordsOk = false;
+        }
+    }
+    testOk(recordsOk, "every frame record matches");
+
+    STFrameMetadata meta;
+    testOk1(reader.getMetadata(2, meta) == 0 && reinterpret_cast<uint8_t *>(&meta)[0] == 3);
+    testOk1(reader.getTelemetry(0, pData, bytes) == 0 && pData == nullptr && bytes == 0);
+    testOk1(reader.getTelemetry(3, pData, bytes) == 0 && bytes == telemBytes &&
+            pData[0] == 0xA3 && pData[telemBytes - 1] == 0xA3);
+
+    testOk1(reader.getFrameData(frameCount, pData, bytes) == ST_ERR_FRAME_NUMBER);
+    testOk1(reader.getMetadata(frameCount, meta) == ST_ERR_FRAME_NUMBER);
+
+    reader.close();
+    testOk1(!reader.isOpen() && reader.getFrameCount() == 0 && reader.getConfig(text) == ST_ERR_STATE);
+    unlink(path.c_str());
+}
+
+static void testReject(void)
+{
+    std::vector<uint8_t> good = buildContainer(ST_RUN_CODEC_SHUFFLE_RLE);
+    StRunReader reader;
+
+    /* A killed writer leaves no footer */
+    std::vector<uint8_t> data(good.begin(), good.end() - 200);
+    std::string path = writeFile("trunc", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT && !reader.isOpen(), "truncated file rejected");
+
+    data.assign(good.begin(), good.begin() + 100);
+    path = writeFile("tiny", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT, "file shorter than header and footer rejected");
+
+    /* Newer major version */
+    data = good;
+    reinterpret_cast<StRunFileHeader *>(data.data())->version = ST_RUN_FILE_VERSION + 0x0100;
+    path = writeFile("version", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT, "unknown major version rejected");
+
+    /* Frame index pointing past its chunk */
+    data = good;
+    StRunFooter *pFooter = reinterpret_cast<StRunFooter *>(data.data() + data.size() - sizeof(StRunFooter));
+    StRunFrameEntry *pFrames = reinterpret_cast<StRunFrameEntry *>(data.data() + pFooter->frameIndexOffset);
+    pFrames[1].rawOffset = recordBytes * 2;
+    path = writeFile("frame", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT, "frame outside its chunk rejected");
+
+    /* Chunk index pointing past the end of the file */
+    data = good;
+    pFooter = reinterpret_cast<StRunFooter *>(data.data() + data.size() - sizeof(StRunFooter));
+    StRunChunkEntry *pChunks = reinterpret_cast<StRunChunkEntry *>(data.data() + pFooter->chunkIndexOffset);
+    pChunks[0].storedBytes = data.size();
+    path = writeFile("chunk", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT, "chunk outside the file rejected");
+
+    /* Huge frame count must not pass the section bounds */
+    data = good;
+    pFooter = reinterpret_cast<StRunFooter *>(data.data() + data.size() - sizeof(StRunFooter));
+    pFooter->frameCount = 0xFFFFFFFF;
+    path = writeFile("count", data);
+    testOk(reader.open(path) == ST_ERR_FILE_FORMAT, "frame count beyond the file rejected");
+    unlink(path.c_str());
+
+    /* A damaged payload fails on access, not on open */
+    data = good;
+    pFooter = reinterpret_cast<StRunFooter *>(data.data() + data.size() - sizeof(StRunFooter));
+    pChunks = reinterpret_cast<StRunChunkEntry *>(data.data() + pFooter->chunkIndexOffset);
+    data[pChunks[1].offset + sizeof(StRunChunkHeader) + pChunks[1].storedBytes - 2] = 0xFF;
+    path = writeFile("payload", data);
+    const uint8_t *pData = nullptr;
+    uint32_t bytes = 0;
+    testOk1(reader.open(path) == 0);
+    testOk(reader.getFrameData(2, pData, bytes) == ST_ERR_FILE_FORMAT, "corrupt chunk payload reported");
+    testOk(reader.getFrameData(0, pData, bytes) == 0, "other chunks still readable");
+
+    const char *tags[] = { "trunc", "tiny", "version", "frame", "chunk", "payload" };
+    for (size_t i = 0; i < sizeof(tags) / sizeof(tags[0]); i++) {
+        unlink((std::string("/tmp/stRunContainerTest_") + tags[i] + "_" +
+                std::to_string(getpid()) + ST_RUN_FILE_EXT).c_str());
+    }
+}
+
+MAIN(stRunContainerTest)
+{
+    testPlan(40);
+    testCodec();
+    testRead(ST_RUN_CODEC_NONE);
+    testRead(ST_RUN_CODEC_SHUFFLE_RLE);
+    testReject();
+    return testDone();
+}
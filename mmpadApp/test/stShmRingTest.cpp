@@ -0,0 +1,200 @@
+/* stShmRingTest.cpp
+ *
+ * Unit tests for the shared-memory frame ring (st_shm_ring.h): publish
+ * and acquire, held slots are never overwritten, futex wake-up, ring
+ * close, and a writer/reader stress run that checks for torn frames.
+ *
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_shm_ring.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t recordWords = 1024;
+static const uint32_t recordBytes = recordWords * sizeof(uint32_t);
+
+/* A frame record whose every word holds the same value */
+static void fillRecord(std::vector<uint32_t>& record, uint32_t value)
+{
+    record.assign(recordWords, value);
+}
+
+static bool recordIs(const StShmFrameRef& ref, uint32_t value)
+{
+    if (ref.getBytes() != recordBytes) return false;
+    const uint32_t *pWords = reinterpret_cast<const uint32_t *>(ref.getData());
+    for (uint32_t i = 0; i < recordWords; i++) {
+        if (pWords[i] != value) return false;
+    }
+    return true;
+}
+
+static int32_t publishValue(StShmFrameRing& ring, uint32_t value)
+{
+    std::vector<uint32_t> record;
+    fillRecord(record, value);
+    return ring.publish(reinterpret_cast<const uint8_t *>(record.data()), recordBytes);
+}
+
+static std::string ringName(const char *tag)
+{
+    return StShmFrameRing::makeName((std::string(tag) + std::to_string(getpid())).c_str());
+}
+
+static void testPublishAcquire(void)
+{
+    std::string name = ringName("t1_");
+    StShmFrameRing writer;
+    StShmFrameRing reader;
+    StShmFrameRef ref;
+
+    testOk1(writer.create(name, 3, recordBytes) == 0);
+    testOk1(reader.attach(name) == 0);
+    testOk1(reader.acquire(0, 0, ref) == ST_ERR_NOT_AVAILABLE);
+
+    testOk1(publishValue(writer, 1) == 0);
+    testOk1(reader.acquire(0, 0, ref) == 0 && ref.getSeq() == 1 && recordIs(ref, 1));
+    testOk(reader.acquire(1, 0, ref) == ST_ERR_NOT_AVAILABLE && !ref.isValid(),
+           "no frame newer than the last one");
+
+    /* Hold two slots; with three slots the writer must skip, not overwrite */
+    StShmFrameRef held1;
+    StShmFrameRef held2;
+    testOk1(reader.acquire(0, 0, held1) == 0 && held1.getSeq() == 1);
+    testOk1(publishValue(writer, 2) == 0);
+    testOk1(reader.acquire(1, 0, held2) == 0 && held2.getSeq() == 2);
+    testOk1(publishValue(writer, 3) == 0);
+    testOk(publishValue(writer, 4) == ST_ERR_BUSY, "every free slot held: frame skipped");
+    testOk(recordIs(held1, 1) && recordIs(held2, 2), "held frames unchanged");
+
+    StShmRingStats stats;
+    writer.getStats(stats);
+    testOk1(stats.published == 3 && stats.skippedBusy == 1);
+
+    held1.release();
+    held2.release();
+    testOk1(publishValue(writer, 5) == 0);
+    testOk1(reader.acquire(0, 0, ref) == 0 && ref.getSeq() == 4 && recordIs(ref, 5));
+    ref.release();
+
+    /* Frames larger than a slot are refused */
+    std::vector<uint32_t> big(recordWords * 2, 7);
+    testOk1(writer.publish(reinterpret_cast<const uint8_t *>(big.data()),
+                           static_cast<uint32_t>(big.size() * sizeof(uint32_t))) == ST_ERR_FRAME_SIZE);
+    testOk1(writer.publish(nullptr, recordBytes) == ST_ERR_NULL_PTR);
+    testOk1(reader.publish(reinterpret_cast<const uint8_t *>(big.data()), recordBytes) == ST_ERR_STATE);
+
+    /* A reader sees the writer close the ring */
+    writer.close();
+    testOk1(reader.acquire(0, 0, ref) == ST_ERR_SVR_NOT_OPEN);
+    reader.close();
+    testOk(reader.attach(name) != 0, "a closed ring cannot be attached");
+}
+
+static void testWakeUp(void)
+{
+    std::string name = ringName("t2_");
+    StShmFrameRing writer;
+    StShmFrameRing reader;
+    StShmFrameRef ref;
+
+    testOk1(writer.create(name, 4, recordBytes) == 0);
+    testOk1(reader.attach(name) == 0);
+
+    std::thread pub([&writer]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        publishValue(writer, 42);
+    });
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int32_t rtn = reader.acquire(0, 2000, ref);
+    double waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    pub.join();
+    testOk(rtn == 0 && recordIs(ref, 42), "waiting reader gets the next frame");
+    testOk(waited < 1000.0, "reader woken by the publish (%.1f ms)", waited);
+    ref.release();
+
+    start = std::chrono::steady_clock::now();
+    rtn = reader.acquire(1, 30, ref);
+    waited = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    testOk(rtn == ST_ERR_NOT_AVAILABLE && waited >= 25.0, "timeout without a new frame (%.1f ms)", waited);
+}
+
+static void testStress(void)
+{
+    const uint32_t readers = 4;
+    const uint32_t frames = 20000;
+    std::string name = ringName("t3_");
+    StShmFrameRing writer;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> taken(0);
+    std::atomic<uint32_t> backwards(0);
+
+    testOk1(writer.create(name, 4, recordBytes) == 0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t r = 0; r < readers; r++) {
+        threads.push_back(std::thread([&]() {
+            StShmFrameRing reader;
+            StShmFrameRef ref;
+            uint64_t lastSeq = 0;
+            if (reader.attach(name) != 0) {
+                torn++;
+                return;
+            }
+            while (!done) {
+                if (reader.acquire(lastSeq, 5, ref) != 0) continue;
+                if (ref.getSeq() <= lastSeq) backwards++;
+                const uint32_t *pWords = reinterpret_cast<const uint32_t *>(ref.getData());
+                /* Value is the sequence; hold the slot while the writer runs */
+                for (uint32_t i = 0; i < recordWords; i++) {
+                    if (pWords[i] != static_cast<uint32_t>(ref.getSeq())) {
+                        torn++;
+                        break;
+                    }
+                }
+                lastSeq = ref.getSeq();
+                taken++;
+                ref.release();
+            }
+        }));
+    }
+
+    uint32_t skipped = 0;
+    uint64_t seq = 0;
+    for (uint32_t n = 0; n < frames; n++) {
+        /* The ring numbers published frames 1, 2, ... */
+        int32_t rtn = publishValue(writer, static_cast<uint32_t>(seq + 1));
+        if (rtn == 0) seq++;
+        else if (rtn == ST_ERR_BUSY) skipped++;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    done = true;
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    testDiag("published %llu, skipped %u, acquired %u",
+             static_cast<unsigned long long>(seq), skipped, taken.load());
+    testOk(torn == 0, "no torn or overwritten frame seen by %u readers", readers);
+    testOk(backwards == 0, "sequence never goes backwards");
+    testOk1(seq + skipped == frames && taken > 0);
+}
+
+MAIN(stShmRingTest)
+{
+    testPlan(29);
+    testPublishAcquire();
+    testWakeUp();
+    testStress();
+    return testDone();
+}
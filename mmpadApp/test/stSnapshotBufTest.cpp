@@ -0,0 +1,165 @@
+/* stSnapshotBufTest.cpp
+ *
+ * Unit tests for the lock-free snapshot buffer (st_snapshotbuf.h):
+ * publish and copy out, pinned slots are never rewritten, the SLOTS - 2
+ * reader bound, and a 6-reader stress run that checks for torn or
+ * out-of-order snapshots (build with -fsanitize=thread to check the
+ * memory ordering as well).
+ *
+ */
+
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "st_snapshotbuf.h"
+
+using namespace ST_INTERFACE;
+
+static const uint32_t valueWords = 512;
+
+/* A value whose every word holds the same number */
+struct TestValue
+{
+    uint64_t words[valueWords];
+
+    TestValue() { fill(0); }
+    void fill(uint64_t value)
+    {
+        for (uint32_t i = 0; i < valueWords; i++) words[i] = value;
+    }
+    bool is(uint64_t value) const
+    {
+        for (uint32_t i = 0; i < valueWords; i++) {
+            if (words[i] != value) return false;
+        }
+        return true;
+    }
+};
+
+static void testSetGet(void)
+{
+    SnapshotBuf<TestValue> buf;
+    TestValue value;
+    TestValue out;
+    uint64_t seq = 0;
+
+    testOk1(buf.get(out) == ST_ERR_NOT_AVAILABLE);
+    testOk1(buf.getSequence() == 0);
+
+    value.fill(11);
+    testOk1(buf.set(value));
+    testOk1(buf.get(out, &seq) == 0 && out.is(11) && seq == 1);
+
+    value.fill(12);
+    buf.set(value);
+    testOk1(buf.get(out, &seq) == 0 && out.is(12) && seq == 2 && buf.getSequence() == 2);
+}
+
+static void testPins(void)
+{
+    SnapshotBuf<TestValue, 4> buf;
+    TestValue value;
+    SnapshotBuf<TestValue, 4>::Pin pins[3];
+
+    /* Pin each of three published values */
+    for (uint32_t i = 0; i < 3; i++) {
+        value.fill(100 + i);
+        buf.set(value);
+        testOk1(buf.acquire(pins[i]) == 0 && pins[i].get()->is(100 + i));
+    }
+
+    /* One free slot left: this publish goes there */
+    value.fill(200);
+    testOk(buf.set(value), "publish with SLOTS - 1 pins and a free slot");
+    bool pinsOk = pins[0].get()->is(100) && pins[1].get()->is(101) && pins[2].get()->is(102);
+    testOk(pinsOk, "pinned values unchanged");
+
+    /* Every slot but the latest pinned: the update is dropped */
+    value.fill(201);
+    testOk(!buf.set(value) && buf.getDroppedCount() == 1, "dropped when all free slots are pinned");
+    TestValue out;
+    testOk(buf.get(out) == 0 && out.is(200), "previous value stays published");
+
+    pins[1].release();
+    testOk1(buf.set(value) && buf.get(out) == 0 && out.is(201));
+
+    /* Moving a pin keeps it; the moved-from pin is empty */
+    SnapshotBuf<TestValue, 4>::Pin moved(std::move(pins[0]));
+    testOk1(!pins[0].isValid() && moved.isValid() && moved.get()->is(100) && moved.getSequence() == 1);
+
+    /* SLOTS - 2 readers never cause a drop, whatever they pin */
+    moved.release();
+    pins[2].release();
+    bool neverDropped = true;
+    for (uint32_t n = 0; n < 100; n++) {
+        buf.acquire(pins[n % 2]);
+        value.fill(300 + n);
+        if (!buf.set(value)) neverDropped = false;
+    }
+    testOk(neverDropped && buf.getDroppedCount() == 1, "two readers on four slots never drop an update");
+}
+
+template<uint32_t SLOTS>
+static void stress(const char *name, bool expectNoDrops)
+{
+    const uint32_t readers = 6;
+    const uint64_t updates = 20000;
+    SnapshotBuf<TestValue, SLOTS> buf;
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> backwards(0);
+    std::atomic<uint64_t> reads(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t r = 0; r < readers; r++) {
+        threads.push_back(std::thread([&]() {
+            TestValue out;
+            uint64_t lastSeq = 0;
+            while (!done) {
+                uint64_t seq = 0;
+                if (buf.get(out, &seq) != 0) continue;
+                /* The writer stores its update count, which equals the sequence */
+                if (!out.is(seq)) torn++;
+                if (seq < lastSeq) backwards++;
+                lastSeq = seq;
+                reads++;
+            }
+        }));
+    }
+
+    TestValue value;
+    uint64_t published = 0;
+    for (uint64_t n = 0; n < updates; n++) {
+        value.fill(published + 1);
+        if (buf.set(value)) published++;
+    }
+    done = true;
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+    testDiag("%s: published %llu, dropped %llu, reads %llu", name,
+             static_cast<unsigned long long>(published),
+             static_cast<unsigned long long>(buf.getDroppedCount()),
+             static_cast<unsigned long long>(reads.load()));
+    testOk(torn == 0, "%s: no torn snapshot seen by %u readers", name, readers);
+    testOk(backwards == 0, "%s: sequence never goes backwards", name);
+    testOk1(published + buf.getDroppedCount() == updates && buf.getSequence() == published);
+    if (expectNoDrops) {
+        testOk(buf.getDroppedCount() == 0, "%s: no drops with %u readers", name, readers);
+    }
+}
+
+MAIN(stSnapshotBufTest)
+{
+    testPlan(22);
+    testSetGet();
+    testPins();
+    /* 6 readers need SLOTS >= 8 for no drops; 4 slots may drop, never tear */
+    stress<8>("8 slots", true);
+    stress<4>("4 slots", false);
+    return testDone();
+}
@@ -0,0 +1,131 @@
+/* stWorkPoolTest.cpp
+ *
+ * Unit tests for the persistent worker pool (stutil_workpool.hpp):
+ * every index is processed exactly once, thread counts, exceptions
+ * thrown by a tile reach the caller, nested calls from a tile run
+ * without deadlock, and concurrent callers are serialized (build with
+ * -fsanitize=thread to check the synchronization as well).
+ *
+ */
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include "stutil_workpool.hpp"
+
+using namespace STUTIL;
+
+/* Run [0, count) and check each index was visited exactly once */
+static bool coversOnce(WorkPool& pool, size_t count, size_t grain)
+{
+    std::vector<std::atomic<uint32_t>> hits(count);
+    for (size_t i = 0; i < count; i++) hits[i] = 0;
+    pool.parallelFor(count, grain, [&hits](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) hits[i]++;
+    });
+    for (size_t i = 0; i < count; i++) {
+        if (hits[i] != 1) return false;
+    }
+    return true;
+}
+
+static void testCoverage(void)
+{
+    WorkPool pool;
+
+    testOk(pool.getThreadCount() == 1, "a new pool runs on the caller only");
+    testOk1(coversOnce(pool, 100, 7));
+
+    testOk1(pool.init(4) == 0 && pool.getThreadCount() == 4);
+    testOk1(coversOnce(pool, 1000, 3));
+    testOk1(coversOnce(pool, 5, 10));
+    testOk1(coversOnce(pool, 612, 16));
+    testOk1(pool.init(STUTIL_WORKPOOL_MAX_THREADS + 1) == ST_ERR_PARAM && pool.getThreadCount() == 4);
+    testOk(pool.init(0) == 0 && pool.getThreadCount() >= 1 && pool.getThreadCount() <= STUTIL_WORKPOOL_MAX_THREADS,
+           "automatic thread count is limited to the maximum (%u)", pool.getThreadCount());
+
+    pool.shutdown();
+    testOk1(pool.getThreadCount() == 1 && coversOnce(pool, 50, 4));
+}
+
+static void testException(void)
+{
+    WorkPool pool;
+    pool.init(4);
+    std::atomic<uint32_t> tiles(0);
+    bool caught = false;
+
+    try {
+        pool.parallelFor(1000, 1, [&tiles](size_t begin, size_t) {
+            tiles++;
+            if (begin == 10) throw std::runtime_error("tile 10");
+        });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    testOk(caught, "tile exception rethrown to the caller");
+    testOk(tiles < 1000, "remaining tiles not started after the exception (%u run)", tiles.load());
+    testOk(coversOnce(pool, 1000, 3), "pool usable after an exception");
+
+    /* Also from the serial path */
+    caught = false;
+    try {
+        pool.parallelFor(1, 1, [](size_t, size_t) { throw std::runtime_error("serial"); });
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    testOk1(caught);
+}
+
+static void testNested(void)
+{
+    WorkPool pool;
+    pool.init(4);
+    std::atomic<uint32_t> inner(0);
+
+    pool.parallelFor(8, 1, [&pool, &inner](size_t, size_t) {
+        pool.parallelFor(10, 2, [&inner](size_t begin, size_t end) { inner += static_cast<uint32_t>(end - begin); });
+    });
+    testOk(inner == 80, "nested parallelFor on the same pool completes");
+
+    /* Nested from the serial path of a caller-only pool */
+    WorkPool single;
+    inner = 0;
+    single.parallelFor(1, 1, [&single, &inner](size_t, size_t) {
+        single.parallelFor(3, 1, [&inner](size_t begin, size_t end) { inner += static_cast<uint32_t>(end - begin); });
+    });
+    testOk1(inner == 3);
+}
+
+static void testConcurrentCallers(void)
+{
+    WorkPool pool;
+    pool.init(3);
+    std::atomic<uint32_t> bad(0);
+
+    std::vector<std::thread> callers;
+    for (int c = 0; c < 4; c++) {
+        callers.push_back(std::thread([&pool, &bad]() {
+            for (int n = 0; n < 50; n++) {
+                if (!coversOnce(pool, 200, 5)) bad++;
+            }
+        }));
+    }
+    for (size_t i = 0; i < callers.size(); i++) callers[i].join();
+    testOk(bad == 0, "4 concurrent callers each see every index once");
+}
+
+MAIN(stWorkPoolTest)
+{
+    testPlan(16);
+    testCoverage();
+    testException();
+    testNested();
+    testConcurrentCallers();
+    return testDone();
+}